@@ -9,14 +9,21 @@
 // 
 // NOTE: Since this text file utility is made for Windows,
 //       the newline character is \r\n instead of \n.
-// NOTE: Memory allocation is done on the user side. Not inside here.
+// NOTE: The POSIX file APIs are used on non-Windows systems (mmap, fstat, ..). Link with -pthread there.
+// NOTE: The plain read/write functions work on memory from the user side and allocate nothing. The readers and tools
+//       that keep state allocate it internally with malloc(..) and free it in their close/free function: the CSV reader,
+//       the line readers (forward and reverse), the line index, search, follow, the length cache, the async reader,
+//       the log, the newline streams, record plans and parallel processing. The array, record and copy functions
+//       take a temporary buffer from malloc(..) for large blocks and free it before they return, and so do the float
+//       parsers for a number longer than 511 chars.
+//       Only text_file_slurp(..) takes a text_file_allocator, and an arena or a pool is provided for it.
 // NOTE: If you are using text_file_get_length(..) to get the size to allocate memory,
 //       then you don't need to add +1 in the size when allocating memory,
 //       otherwise remember to add +1 like this: text = malloc(size + 1);
 //       when dealing with strings (null terminated).
 //
-// TODO: Make this also to work with C++.
-// TODO: Change the malloc/calloc to alloc (stack based mem allocation) instead for _f32 and _f64 to improve performance.
+// Note: It also compiles as C++. From C++17 on there is a C++ layer at the end of this file in namespace text_files,
+//       with RAII handles and read<T>/write<T>.
 // 
 // Example of using text_file.h
 //
@@ -172,21 +179,310 @@
 //		text_file_close(file);
 // 
 //
+// Example of reading numbers at known offsets from many threads through one open file (no seek, no lock)
+//
+//		text_file index = text_file_openfor_read("index.txt");			// Shared by all threads
+//		..
+//		i32 value;															// In any thread
+//		if (!text_file_read_i32_at(&value, 10, record * 11, index))
+//			printf("Error: Failed to read record %lld\n", record);
+//
+//
+// Example of reading a text file in place through a memory mapping (no copy, no malloc)
+//
+//		text_file_mapped mapped;
+//		if (!text_file_openfor_read_mapped(&mapped, "bigtextfile.txt"))
+//		{
+//			printf("Error: Failed to open for reading file\n");
+//			exit(1); // Exit to OS
+//		}
+//		byte* header = NULL;
+//		if (text_file_read_mapped(&header, 16, &mapped))		// 'header' points into the mapping
+//			printf("%.16s\n", header);
+//		text_file_set_position(1024, mapped.file);			// The regular seek functions still work
+//		byte* rest = text_file_mapped_at_position(&mapped);	// ..and so does the zero copy view
+//		text_file_close_mapped(&mapped);
+//
+//
+// Example of reading a text file one line at a time (no allocation or copy per line)
+//
+//		text_file_line_reader reader;
+//		if (!text_file_openfor_read_lines(&reader, "bigtextfile.txt", 0))
+//		{
+//			printf("Error: Failed to open for reading file\n");
+//			exit(1); // Exit to OS
+//		}
+//		c8* line;
+//		i64 length;
+//		while (text_file_read_line(&line, &length, &reader))
+//			printf("%.*s\n", (int)length, line);
+//		text_file_close_lines(&reader);
+//
+//
+// Example of reading the last 500 lines of a big text file (reads blocks from the end, not the whole file)
+//
+//		text_file_reverse_line_reader reader;
+//		if (!text_file_openfor_read_lines_reverse(&reader, "bigtextfile.txt", 0))
+//		{
+//			printf("Error: Failed to open for reading file\n");
+//			exit(1); // Exit to OS
+//		}
+//		c8* line;
+//		i64 length;
+//		for (i32 i = 0; i < 500 && text_file_read_line_reverse(&line, &length, &reader); i++)
+//			printf("%.*s\n", (int)length, line);					// Last line first
+//		text_file_close_lines_reverse(&reader);
+//
+//
+// Example of reading a CSV file into typed columns
+//
+//		text_file_column_type types[3] = { TEXT_FILE_COLUMN_STRING, TEXT_FILE_COLUMN_I64, TEXT_FILE_COLUMN_F64 };
+//		text_file_csv csv;
+//		if (!text_file_read_csv(&csv, "prices.csv", ',', types, 3, true))
+//			printf("Error: Bad field at row %lld column %d\n", csv.error_row, csv.error_column);
+//		text_file_view* names = text_file_csv_string(&csv, 0);
+//		f64* prices = text_file_csv_f64(&csv, 2);
+//		for (i64 i = 0; i < csv.row_count; i++)
+//			printf("%.*s: %f\n", (int)names[i].length, names[i].text, prices[i]);
+//		text_file_close_csv(&csv);
+//
+//
+// Example of writing and reading arrays of numbers (one I/O call per block instead of one per number)
+//
+//		i32 values[1000];
+//		..
+//		text_file file = text_file_openfor_write_new("values.txt");
+//		text_file_write_i32_array(values, 1000, "\n", file);
+//		text_file_close(file);
+//		file = text_file_openfor_read("values.txt");
+//		if (!text_file_read_i32_array(values, 1000, "\n", file))
+//			printf("Error: Failed to read the values\n");
+//		text_file_close(file);
+//
+//
+// Example of reading fixed width records (one I/O call per block of records instead of one per field)
+//
+//		typedef struct order { i32 id; f64 price; c8 code[4]; bool paid; } order;
+//		text_file_record_field fields[] =
+//		{
+//			{ TEXT_FILE_TYPE_I32, 8, offsetof(order, id) },
+//			{ TEXT_FILE_TYPE_F64, 12, offsetof(order, price) },
+//			{ TEXT_FILE_TYPE_BYTE, 2, -1 },							// Skipped
+//			{ TEXT_FILE_TYPE_BYTE, 4, offsetof(order, code) },
+//			{ TEXT_FILE_TYPE_BOOL, 1, offsetof(order, paid) },
+//		};
+//		text_file_record_plan plan;
+//		text_file_record_plan_compile(&plan, fields, 5, "\n");
+//		order orders[1000];
+//		text_file file = text_file_openfor_read("orders.txt");
+//		if (!text_file_read_records(orders, 1000, sizeof(order), &plan, file))
+//			printf("Error: Failed to read the orders\n");
+//		text_file_close(file);
+//		text_file_record_plan_free(&plan);
+//
+//
+// Example of copying a text file without reading it into memory (the OS copies it in the kernel where it can)
+//
+//		if (!text_file_copy("bigtextfile.txt", "bigtext2.txt"))
+//		{
+//			printf("Error: Failed to copy file\n");
+//			exit(1); // Exit to OS
+//		}
+//
+//
+// Example of reading a text file and checking that it is valid UTF-8 while it is read (no second pass)
+//
+//		str text = malloc(length + 1);
+//		i64 error_offset;
+//		if (!text_file_read_str_utf8(text, length, &error_offset, file))
+//			printf("Error: Not valid UTF-8 at byte %lld\n", error_offset);
+//		u16* wide = malloc(length * sizeof(u16));					// UTF-16 never takes more units than UTF-8 bytes
+//		i64 units = text_file_utf8_to_utf16(wide, text, length, &error_offset);
+//
+//
+// Example of finding words in a big log file with line numbers (reads 1 MB at a time, never all of the file)
+//
+//		bool print_match(i32 pattern, file_size offset, i64 line, void* user)
+//		{
+//			printf("%s at byte %lld, line %lld\n", ((const char**)user)[pattern], offset, line);
+//			return true; // Keep searching
+//		}
+//		..
+//		const c8* words[3] = { "ERROR", "timeout", "refused" };
+//		i64 lengths[3] = { 5, 7, 7 };
+//		text_file_search search;
+//		text_file_search_compile(&search, words, lengths, 3, true);
+//		text_file file = text_file_openfor_read("application.log");
+//		text_file_search_file(&search, file, print_match, words);
+//		text_file_close(file);
+//		text_file_search_free(&search);
+//
+//
+// Example of following log files as other programs append to them (like "tail -F", also across truncation and rotation)
+//
+//		text_file_watch watch;
+//		text_file_watch_init(&watch);
+//		text_file_follow access, errors;
+//		text_file_openfor_follow(&access, "access.log", true, &watch);		// Only what is appended from now on
+//		text_file_openfor_follow(&errors, "error.log", true, &watch);
+//		text_file_follow* follow;
+//		while ((follow = text_file_watch_wait(&watch, -1)) != NULL)		// Sleeps until a file changes
+//		{
+//			c8* line;
+//			i64 length;
+//			while (text_file_follow_read_line(&line, &length, follow))
+//				printf("%s: %.*s\n", follow->path, (int)length, line);
+//		}
+//
+//
+// Example of getting the lengths of many files (a directory scan), cached between scans
+//
+//		text_file_length_cache cache;
+//		text_file_length_cache_init(&cache, 0);		// Linux: cached until the file changes. Elsewhere: for 1 second.
+//		file_size* lengths = malloc(count * sizeof(file_size));
+//		text_file_get_lengths(lengths, filenames, count, 0, &cache);	// Only the files not cached are looked up, on threads
+//		...
+//		file_size length = text_file_length_cache_get(&cache, "settings.txt");
+//		text_file_length_cache_free(&cache);
+//
+// Example of reading whole files per request from an arena (one reset frees them all)
+//
+//		text_file_arena arena;
+//		text_file_arena_init(&arena, NULL, 1024 * 1024);
+//		text_file_allocator allocator = text_file_arena_allocator(&arena);
+//		...
+//		c8* page;
+//		i64 length;
+//		if (!text_file_slurp(&page, &length, "index.html", &allocator))
+//			return false; // Not found
+//		...
+//		text_file_arena_reset(&arena); // End of the request
+//
+// Example of using the C++ layer (C++17 and later). The file is closed when 'file' goes out of scope.
+//
+//		text_files::file file = text_files::file::open_write_new("numbers.txt");
+//		if (!file)
+//			exit(1); // Exit to OS
+//		file.write(std::string_view("pi="));
+//		file.write(3.14159);		// Picks text_file_write_f64_shortest(..) at compile time
+//		file.write("\n");			// Text is a std::string_view (a char is an i8 and written as a number)
+//
+// Example of looking at the I/O statistics of a text file (compile with #define TEXT_FILE_STATS 1 before the include)
+//
+//		text_file file = text_file_openfor_write_new("numbers.txt");
+//		text_file_stats_enable(file, stderr);				// Printed to stderr when the file is closed
+//		for (i32 i = 0; i < 1000; i++)
+//			text_file_write_i32(i, file);
+//		text_file_stats stats;
+//		if (text_file_get_stats(&stats, file))
+//			printf("%lld bytes in %lld writes\n", stats.bytes_written, stats.write_calls);
+//		text_file_close(file);
+//
+//
 
 #pragma once
 
 // Disable warnings
 #define _CRT_SECURE_NO_WARNINGS
 
+// Use 64-bit file offsets on 32-bit POSIX systems
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+// Enable the GNU extensions (fopencookie, ..) on Linux. They are only seen if this header comes before the first
+// #include <stdio.h>, or if _GNU_SOURCE is defined for the whole build. See TEXT_FILE_FOPENCOOKIE.
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 //
 // C includes
 //
 #include <assert.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
+//
+// Platform includes
+//
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <intrin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#define _fseeki64 fseeko // The POSIX equivalents of the 64-bit seek/tell functions
+#define _ftelli64 ftello
+#endif
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int) // From <linux/fs.h>
+#endif
+#endif
+
+// Custom stdio streams, used by the read-ahead and newline conversion streams: funopen(..) on macOS and the BSDs, and
+// fopencookie(..) where the GNU extensions are on. Without either, a read-ahead file is read without the background
+// thread and the newline conversion streams can not be opened.
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+#define TEXT_FILE_FUNOPEN 1
+#else
+#define TEXT_FILE_FUNOPEN 0
+#endif
+#if (defined(__GLIBC__) && defined(__USE_GNU)) || (!defined(__GLIBC__) && defined(_GNU_SOURCE))
+#define TEXT_FILE_GNU 1 // The GNU extensions are declared: fopencookie(..), copy_file_range(..)
+#else
+#define TEXT_FILE_GNU 0
+#endif
+#if !defined(_WIN32) && !TEXT_FILE_FUNOPEN && TEXT_FILE_GNU
+#define TEXT_FILE_FOPENCOOKIE 1
+#else
+#define TEXT_FILE_FOPENCOOKIE 0
+#endif
+
+//
+// SIMD includes. SSE2 is always there on x64, SSSE3 and AVX2 only when the compiler targets them (-mssse3, /arch:AVX2 or -mavx2).
+//
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXT_FILE_SSE2 1
+#include <emmintrin.h>
+#else
+#define TEXT_FILE_SSE2 0
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+#define TEXT_FILE_SSSE3 1
+#include <tmmintrin.h>
+#else
+#define TEXT_FILE_SSSE3 0
+#endif
+#if defined(__AVX2__)
+#define TEXT_FILE_AVX2 1
+#include <immintrin.h>
+#else
+#define TEXT_FILE_AVX2 0
+#endif
+
 //
 // Data types
 //
@@ -210,6 +506,564 @@ typedef unsigned char		 c8;
 typedef FILE*		text_file;
 typedef i64			file_size;
 
+// Size of a buffer that can hold any number formatted by text_file_format_f32(..) and text_file_format_f64(..)
+#define TEXT_FILE_FLOAT_BUFFER 32
+
+// A read-only memory mapped text file. The 'file' member is a regular text_file,
+// so text_file_set_position(..), text_file_get_position(..) and friends work on it.
+typedef struct text_file_mapped
+{
+	text_file file;		// Underlying file. Its position is the read position in the mapping.
+	byte* data;			// Start of the mapped file. NULL if the file is empty.
+	file_size length;	// Length of the mapped file in bytes
+#if defined(_WIN32)
+	HANDLE mapping;		// File mapping object
+#endif
+} text_file_mapped;
+
+// Default size of the buffer of a line reader
+#define TEXT_FILE_LINE_BUFFER (1024 * 1024)
+
+// Reads a text file one line at a time into a large internal buffer. The lines are returned as views into
+// that buffer, so there is no allocation or copy per line.
+typedef struct text_file_line_reader
+{
+	text_file file;		// Underlying file opened in binary mode
+	c8* buffer;			// Internal buffer. Grows if a line does not fit.
+	i64 capacity;		// Size of the buffer
+	i64 start;			// Start of the next line in the buffer
+	i64 end;			// End of the data in the buffer
+	bool eof;			// No more data to read from the file
+} text_file_line_reader;
+
+// Default size of the buffer of a reverse line reader. Smaller than TEXT_FILE_LINE_BUFFER, as it is usually asked for
+// only the last few lines.
+#define TEXT_FILE_REVERSE_LINE_BUFFER (64 * 1024)
+
+// A reader that returns the lines of a text file from the last one to the first. It reads blocks backwards from the end,
+// so getting the last N lines costs about what they take, whatever the size of the file.
+typedef struct text_file_reverse_line_reader
+{
+	text_file file;		// Underlying file opened in binary mode
+	c8* buffer;			// Internal buffer. Grows if a line does not fit.
+	i64 capacity;		// Size of the buffer
+	i64 start;			// Start of the data in the buffer. It is at file offset 'position'.
+	i64 end;			// End of the lines that have not been returned yet
+	i64 scanned;		// Everything from this to 'end' has been searched for a newline already
+	file_size position;	// File offset of the data in the buffer. Everything before it is still to be read.
+	bool trailing;		// The end of the file has not been looked at for a final newline yet
+	bool unterminated;	// The next line is the last line of the file and has no newline
+	bool done;			// The first line of the file has been returned
+} text_file_reverse_line_reader;
+
+// Default number of lines between two entries of a line index
+#define TEXT_FILE_LINE_INDEX_STRIDE 1024
+
+// The byte offset of every 'stride' line of a text file, for seeking to a line number without reading from the start.
+// It is saved next to the text file as "<filename>.lines" with the offsets delta and varint encoded.
+typedef struct text_file_line_index
+{
+	file_size* offsets;			// offsets[i] is the start of line i * stride. offsets[0] is always 0.
+	i64 count;					// Number of offsets
+	i64 capacity;				// Allocated number of offsets
+	i64 stride;					// Number of lines between two offsets
+	i64 newlines;				// Number of '\n' in the indexed part of the file
+	file_size indexed_length;	// Bytes of the file covered by the index
+	u64 tail_hash;				// Hash of the last bytes covered, to detect a file that was rewritten instead of appended to
+} text_file_line_index;
+
+// Threads. Thread functions are declared with TEXT_FILE_THREAD_PROC(name, argument) and end with TEXT_FILE_THREAD_RETURN.
+#if defined(_WIN32)
+typedef HANDLE text_file_thread;
+typedef LPTHREAD_START_ROUTINE text_file_thread_proc;
+#define TEXT_FILE_THREAD_PROC(name, argument) DWORD WINAPI name(LPVOID argument)
+#define TEXT_FILE_THREAD_RETURN return 0
+#else
+typedef pthread_t text_file_thread;
+typedef void* (*text_file_thread_proc)(void*);
+#define TEXT_FILE_THREAD_PROC(name, argument) void* name(void* argument)
+#define TEXT_FILE_THREAD_RETURN return NULL
+#endif
+
+// Default size of the chunks handed to the callback of text_file_process_parallel(..)
+#define TEXT_FILE_PARALLEL_CHUNK (4 * 1024 * 1024)
+
+// Called from a worker thread with a chunk of a range that ends on a newline (or at the end of the file).
+// 'position' is the byte offset of the chunk in the file and 'range' the index of the range. Return false to stop all workers.
+typedef bool (*text_file_chunk_callback)(const c8* data, i64 length, file_size position, i32 range, void* user);
+// Called on the calling thread for each range in file order after all workers are done. Return false to stop.
+typedef bool (*text_file_reduce_callback)(i32 range, void* user);
+
+// Mutex and condition variable
+#if defined(_WIN32)
+typedef SRWLOCK text_file_mutex;
+typedef CONDITION_VARIABLE text_file_condition;
+#else
+typedef pthread_mutex_t text_file_mutex;
+typedef pthread_cond_t text_file_condition;
+#endif
+
+// Default buffer size and number of buffers of a read-ahead text file
+#define TEXT_FILE_ASYNC_BUFFER (1024 * 1024)
+#define TEXT_FILE_ASYNC_DEPTH 2
+
+// A text file read ahead by a background thread. The background thread fills the next buffers while
+// the caller consumes the current one. Use 'file' with the regular text_file_read_* functions.
+typedef struct text_file_async
+{
+	text_file file;				// Read from this. It is fed by the background thread.
+	text_file source;			// The real file. Only used by the background thread.
+	text_file_thread thread;	// Background thread
+	i64 buffer_size;			// Size of each buffer
+	i32 depth;					// Number of buffers
+#if defined(_WIN32)
+	HANDLE pipe;				// Write end of the pipe that feeds 'file'
+	byte* buffer;				// Buffer of the background thread
+#else
+	byte** buffers;				// Ring of buffers
+	i64* lengths;				// Bytes in each buffer
+	i32 head;					// Buffer being consumed
+	i32 tail;					// Buffer being filled
+	i32 count;					// Number of filled buffers
+	i64 consumed;				// Bytes consumed from the head buffer
+	file_size position;			// Read position of the caller
+	file_size seek_position;	// Where the background thread should continue after a seek
+	u32 generation;				// Changed by every seek, so that buffers read before it are dropped
+	bool seek_pending;
+	bool eof;
+	bool error;
+	bool stop;
+	text_file_mutex mutex;
+	text_file_condition not_empty;	// Signaled when a buffer was filled
+	text_file_condition not_full;	// Signaled when a buffer was consumed, or on seek and stop
+#endif
+} text_file_async;
+
+// Default size of the ring buffer of a log
+#define TEXT_FILE_LOG_CAPACITY (4 * 1024 * 1024)
+
+// What text_file_log_write(..) does when the ring buffer of a log is full
+typedef enum text_file_log_policy
+{
+	TEXT_FILE_LOG_BLOCK,	// Wait for the writer thread to make room
+	TEXT_FILE_LOG_DROP		// Drop the message and count it
+} text_file_log_policy;
+
+// A text file for logging from many threads. Messages are copied into a lock-free ring buffer and written
+// to the file in batches, one write per batch, by a dedicated writer thread.
+typedef struct text_file_log
+{
+	text_file file;					// The log file, opened in append mode
+	byte* ring;						// Ring buffer of records: an 8 byte header ((length << 1) | 1) and the message padded to 8 bytes
+	i64 capacity;					// Size of the ring buffer. A power of two.
+	volatile i64 head;				// Total bytes reserved by the producers
+	volatile i64 tail;				// Total bytes taken out of the ring by the writer thread
+	volatile i64 written;			// Total bytes of records written to the file
+	volatile i64 dropped;			// Number of messages dropped because the ring was full
+	volatile i64 blocked;			// Number of producers waiting for room (TEXT_FILE_LOG_BLOCK)
+	volatile i32 sleeping;			// The writer thread is waiting for messages
+	volatile i32 stop;				// The writer thread should exit once the ring is empty
+	volatile i32 error;				// Writing to the file failed
+	text_file_log_policy policy;
+	byte* batch;					// Batch buffer of the writer thread
+	text_file_thread thread;		// Writer thread
+	text_file_mutex mutex;
+	text_file_condition wake;		// Wakes the writer thread
+	text_file_condition drained;	// Signaled after each batch was written, and when room was made for blocked producers
+} text_file_log;
+
+// The column types of a CSV file
+typedef enum text_file_column_type
+{
+	TEXT_FILE_COLUMN_I64,
+	TEXT_FILE_COLUMN_F64,
+	TEXT_FILE_COLUMN_BOOL,		// "1", "0", "true" or "false"
+	TEXT_FILE_COLUMN_STRING		// text_file_view
+} text_file_column_type;
+
+// A piece of text that is not null terminated
+typedef struct text_file_view
+{
+	const c8* text;
+	i64 length;
+} text_file_view;
+
+// A column of a CSV file. 'values' is an array of i64, f64, bool or text_file_view with one value per row.
+typedef struct text_file_column
+{
+	text_file_column_type type;
+	void* values;
+} text_file_column;
+
+// A block of unescaped strings of a CSV file. Blocks are never moved, so views into them stay valid.
+typedef struct text_file_csv_block
+{
+	struct text_file_csv_block* next;
+	i64 used;
+	i64 capacity;
+} text_file_csv_block;
+
+// A CSV (or other delimited) file read into typed columns. The file is memory mapped and string values are views into it,
+// except for quoted strings with escaped quotes (""), which are unescaped into 'strings'.
+typedef struct text_file_csv
+{
+	text_file_mapped mapped;
+	c8 delimiter;
+	i32 column_count;
+	text_file_column* columns;		// One column per field of a row
+	text_file_view* names;			// The header row if there is one, otherwise NULL
+	i64 row_count;					// Number of rows without the header
+	i64 row_capacity;
+	i64 error_row;					// Row (counting the header) and column of the first bad field, or -1
+	i32 error_column;
+	i32 column;						// Column of the next field while reading
+	i64 record;						// Row of the next field (counting the header) while reading
+	bool header;
+	text_file_csv_block* strings;
+} text_file_csv;
+
+// The value types of the array and record functions
+typedef enum text_file_type
+{
+	TEXT_FILE_TYPE_I8, TEXT_FILE_TYPE_I16, TEXT_FILE_TYPE_I32, TEXT_FILE_TYPE_I64,
+	TEXT_FILE_TYPE_U8, TEXT_FILE_TYPE_U16, TEXT_FILE_TYPE_U32, TEXT_FILE_TYPE_U64,
+	TEXT_FILE_TYPE_F32, TEXT_FILE_TYPE_F64,
+	TEXT_FILE_TYPE_BOOL,	// '1' or '0'
+	TEXT_FILE_TYPE_BYTE		// Chars copied as they are. Records only.
+} text_file_type;
+
+// A field of a fixed width record: 'width' chars of text parsed as 'type' and stored at byte 'offset' of a record struct
+// (use offsetof(..)). A field with a negative 'offset' is skipped.
+typedef struct text_file_record_field
+{
+	text_file_type type;
+	i32 width;
+	i32 offset;
+} text_file_record_field;
+
+// A field of a compiled record plan, with its position in the text of the record
+typedef struct text_file_record_step
+{
+	text_file_type type;
+	i32 position;
+	i32 width;
+	i32 offset;
+} text_file_record_step;
+
+// A fixed width record format compiled by text_file_record_plan_compile(..). Skipped fields are folded into the positions.
+typedef struct text_file_record_plan
+{
+	text_file_record_step* steps;
+	i32 step_count;
+	i32 record_width;			// Chars per record including the terminator
+	c8 terminator[4];			// Chars at the end of each record, like "\n" or "\r\n"
+	i32 terminator_length;
+} text_file_record_plan;
+
+// Largest block formatted or parsed at a time by the array functions. Smaller arrays use a stack buffer.
+#define TEXT_FILE_ARRAY_BUFFER (1024 * 1024)
+
+// Size of the buffer used by text_file_copy(..) and text_file_copy_range(..) when the OS can't copy in the kernel
+#define TEXT_FILE_COPY_CHUNK (1024 * 1024)
+
+// Newline styles
+typedef enum text_file_newline
+{
+	TEXT_FILE_NEWLINE_LF,		// "\n"
+	TEXT_FILE_NEWLINE_CRLF		// "\r\n"
+} text_file_newline;
+
+// Default size of the conversion buffer of a newline converting text file
+#define TEXT_FILE_NEWLINES_BUFFER (64 * 1024)
+
+// A text file whose newlines are converted to one style on the fly while reading or writing, whatever mix of "\r\n"
+// and "\n" the input has. Use 'file' with the regular text_file_read_* or text_file_write_* functions.
+typedef struct text_file_newlines
+{
+	text_file file;					// Read from or write to this
+	text_file source;				// The real file
+	text_file_newline newline;		// Style to convert to
+	bool writing;
+	bool pending;					// A "\r" at the end of the last input was held back, as a "\n" may follow
+	c8 previous;					// Last char of the last input
+	bool error;
+	c8* buffer;						// Conversion buffer
+	i64 buffer_size;
+	c8 staged[4];					// Converted chars that did not fit into a very small read
+	i32 staged_start;
+	i32 staged_length;
+#if defined(_WIN32)
+	HANDLE pipe;					// The other end of the pipe of 'file'
+	text_file_thread thread;		// Moves the data between the pipe and 'source'
+#endif
+} text_file_newlines;
+
+// Validates UTF-8 text that comes in pieces. A character split between two pieces is kept in 'pending' until it is complete.
+typedef struct text_file_utf8_validator
+{
+	c8 pending[4];			// Start of a character at the end of the last piece
+	i32 pending_length;
+	i64 offset;				// Number of bytes seen so far
+	i64 error_offset;		// Byte offset of the first error, or -1
+} text_file_utf8_validator;
+
+// Size of the pieces text_file_read_str_utf8(..) reads and validates while they are still in the cache
+#define TEXT_FILE_UTF8_CHUNK (64 * 1024)
+
+// Called for each match of a search with the index of the pattern, the byte offset where the match starts and its line
+// number (from 1, or 0 if line numbers were not asked for). Return false to stop the search.
+typedef bool (*text_file_search_callback)(i32 pattern, file_size offset, i64 line, void* user);
+
+// Patterns compiled for text_file_search_file(..) and text_file_search_mapped(..). One pattern is found with a SIMD
+// filter on its first and last byte. Up to TEXT_FILE_SEARCH_TEDDY patterns are found with Teddy (SSSE3 only): the
+// patterns are put in 8 buckets, and the first 3 bytes of each position are looked up by nibble in tables of buckets,
+// 16 positions at a time. Only the buckets that are left are compared in full. More patterns are found with an
+// Aho-Corasick automaton (one table lookup per byte).
+typedef struct text_file_search
+{
+	c8* text;					// All patterns one after the other
+	i64* starts;				// Start of each pattern in 'text'
+	i64* lengths;				// Length of each pattern
+	i32 pattern_count;
+	i64 max_length;				// Length of the longest pattern
+	bool lines;					// Count lines for the callback
+	u32* transitions;			// Automaton: (next state * class_count) << 1 for each state * class_count + class. Bit 0 is set if a pattern ends there.
+	i32* state_pattern;			// Automaton: a pattern that ends in each state, or -1
+	u32* state_output;			// Automaton: the next state on the suffix chain that has a pattern, or 0
+	i32* pattern_next;			// Next pattern with the same text, or -1
+	u32 state_count;
+	u32 class_count;			// Number of byte classes. Bytes that are in no pattern share class 0, so the table stays small.
+	u8 classes[256];			// Class of each byte
+	i32 teddy_length;			// Teddy: number of bytes looked up (1 to 3), or 0 if Teddy is not used
+	c8 teddy_low[3][16];		// Teddy: buckets with each low nibble at each of the first bytes
+	c8 teddy_high[3][16];		// Teddy: buckets with each high nibble at each of the first bytes
+	i32 bucket_starts[9];		// Teddy: patterns of bucket b are bucket_patterns[bucket_starts[b]] to [bucket_starts[b + 1] - 1]
+	i32* bucket_patterns;
+	c8 first_low[16];			// Bytes that start a pattern as nibble tables: bit 'high' of entry 'low' for high nibbles 0 to 7
+	c8 first_high[16];			// ..and bit 'high - 8' for high nibbles 8 to 15
+} text_file_search;
+
+// State of a running search
+typedef struct text_file_search_run
+{
+	text_file_search* search;
+	text_file_search_callback callback;
+	void* user;
+	u32 state;					// Automaton state * class_count after the last byte
+	file_size line_position;	// Offset up to which the lines are counted
+	i64 line_count;				// Number of '\n' before 'line_position'
+} text_file_search_run;
+
+// Largest number of patterns that are found with Teddy
+#define TEXT_FILE_SEARCH_TEDDY 64
+
+// Number of bytes text_file_search_file(..) reads at a time
+#define TEXT_FILE_SEARCH_CHUNK (1024 * 1024)
+
+// Default size of the line buffer of a followed file
+#define TEXT_FILE_FOLLOW_BUFFER (64 * 1024)
+
+// How often followed files are checked for changes where there is no inotify, and how often the name of a rotated
+// file is looked at while no new file has been created for it
+#define TEXT_FILE_FOLLOW_POLL_MS 250
+
+// A growing file followed like "tail -F". It remembers its position, and reads only what was appended since the last
+// read. If the file gets shorter it is read again from the start, and if its name is given to a new file (rotation)
+// the rest of the old file is read before the new one is followed.
+typedef struct text_file_follow
+{
+	text_file file;					// File being followed, opened in binary mode without a stdio buffer
+	c8* path;						// Copy of the file name, to find the new file after a rotation
+	file_size position;				// Offset of the next byte to read
+	u64 device;						// Identity of the open file, to tell when the name belongs to another file
+	u64 inode;
+	i64 truncations;				// Number of times the file got shorter and was read again from the start
+	i64 rotations;					// Number of times a new file took over the name
+	bool missing;					// The file was renamed or deleted and no new file has been created yet
+	bool switched;					// Truncated or rotated since the last read. Ends a partial line.
+	c8* buffer;						// Line buffer. Grows if a line does not fit.
+	i64 capacity;
+	i64 start;						// Start of the next line in the buffer
+	i64 end;						// End of the data in the buffer
+	i64 scanned;					// Everything before this has been searched for a newline already
+	i64 boundary;					// End of the data of the last file in the buffer, or -1
+	struct text_file_watch* watch;
+	i32 index;						// Position in watch->follows
+	bool ready;						// In the ready list of the watch
+#if defined(_WIN32)
+	u64 created;					// Creation time of the open file
+#endif
+#if defined(__linux__)
+	int descriptor;					// inotify watch descriptor, or -1
+	struct text_file_follow* next;	// Next followed file with the same watch descriptor
+#endif
+} text_file_follow;
+
+// A set of followed files that are waited on together. On Linux one inotify instance wakes the waiting thread only when
+// a file changes. Elsewhere the files are checked every TEXT_FILE_FOLLOW_POLL_MS with one fstat each.
+typedef struct text_file_watch
+{
+	text_file_follow** follows;		// All followed files
+	i32 count;
+	i32 capacity;
+	text_file_follow** ready;		// Ring of followed files that may have new data
+	i32 ready_start;
+	i32 ready_count;
+	i32 missing_count;				// Number of followed files that are missing
+	u64 last_poll;					// text_file_clock_ns() of the last check
+#if defined(__linux__)
+	int inotify;
+	text_file_follow** descriptors;	// Followed files by inotify watch descriptor
+	i32 descriptor_capacity;
+#endif
+} text_file_watch;
+
+// Allocations from a text_file_allocator are aligned to this many bytes
+#define TEXT_FILE_ALLOCATOR_ALIGN 16
+// Size classes of a text_file_pool: 16, 32, 64, .. 64 KiB. Larger blocks go straight to malloc(..).
+#define TEXT_FILE_POOL_CLASSES 13
+// Bytes taken from malloc(..) at a time by a text_file_pool, carved into blocks of one size class
+#define TEXT_FILE_POOL_SLAB (256 * 1024)
+// Bytes read at a time by text_file_slurp(..) when the file system does not know the length (pipes, /proc, ..)
+#define TEXT_FILE_SLURP_CHUNK (64 * 1024)
+
+// Where memory comes from. 'allocate' returns 'size' bytes aligned to TEXT_FILE_ALLOCATOR_ALIGN, or NULL. 'release' gets
+// a block back together with the 'size' it was allocated with, and may do nothing (like for an arena).
+typedef struct text_file_allocator
+{
+	void* (*allocate)(void* context, size_t size);
+	void (*release)(void* context, void* data, size_t size);
+	void* context;					// Passed to 'allocate' and 'release'
+} text_file_allocator;
+
+// A block of a text_file_arena from malloc(..). The memory follows the header at the next aligned byte.
+typedef struct text_file_arena_block
+{
+	struct text_file_arena_block* next;
+	size_t capacity;
+} text_file_arena_block;
+#define TEXT_FILE_ARENA_HEADER ((sizeof(text_file_arena_block) + TEXT_FILE_ALLOCATOR_ALIGN - 1) & ~(size_t)(TEXT_FILE_ALLOCATOR_ALIGN - 1))
+
+// A bump allocator: allocating moves a pointer forward, release does nothing and text_file_arena_reset(..) frees every
+// allocation at once. It grows with blocks from malloc(..), or stays inside the buffer it was given.
+typedef struct text_file_arena
+{
+	byte* buffer;					// Block that is allocated from
+	size_t capacity;
+	size_t used;
+	text_file_arena_block* blocks;	// Blocks from malloc(..), the current one first
+	size_t block_size;				// 0 if the arena only uses the buffer it was given
+} text_file_arena;
+
+// A size class pool: blocks are rounded up to a power of two and released blocks are reused for the next allocation of
+// the same class. The memory goes back to malloc(..) with text_file_pool_free(..).
+typedef struct text_file_pool
+{
+	void* free_blocks[TEXT_FILE_POOL_CLASSES];	// Released blocks per size class, linked through their first bytes
+	void* slabs;								// Slabs from malloc(..), linked through their first bytes
+} text_file_pool;
+
+// How long a text_file_length_cache trusts a length where changes are not watched (no inotify), in milliseconds
+#define TEXT_FILE_LENGTH_CACHE_TTL_MS 1000
+// Number of files a thread of text_file_get_lengths(..) takes at a time, and the least number of files per thread
+#define TEXT_FILE_LENGTHS_BATCH 64
+#define TEXT_FILE_LENGTHS_PER_THREAD 256
+
+// A file in a text_file_length_cache: 'name' in the directory at index 'directory'
+typedef struct text_file_length_entry
+{
+	c8* name;						// NULL for an empty slot
+	i64 name_length;
+	u64 hash;
+	i32 directory;
+	bool valid;						// Cleared when the file changes
+	file_size length;				// -1 if the file does not exist
+	u64 checked;					// text_file_clock_ns() of the lookup, when there is a TTL
+} text_file_length_entry;
+
+// A directory of the files in a text_file_length_cache
+typedef struct text_file_length_directory
+{
+	c8* path;
+	i64 length;
+	u64 hash;
+	int descriptor;					// inotify watch descriptor, -1 if not watched, -2 to watch again on the next lookup
+	i32 next;						// Next directory with the same watch descriptor (another path to it), or -1
+} text_file_length_directory;
+
+// Lengths of files by path. On Linux each directory is watched with inotify and a length stays cached until the file
+// changes. Elsewhere a length is trusted for a TTL. Not locked, so use one cache per thread.
+typedef struct text_file_length_cache
+{
+	text_file_length_entry* entries;			// Hash table on (directory, name)
+	i64 capacity;								// Power of two
+	i64 count;
+	text_file_length_directory* directories;
+	i32 directory_count;
+	i32 directory_capacity;
+	i32* directory_slots;						// Hash table of indexes into 'directories' on the path, -1 if empty
+	i32 directory_slot_capacity;				// Power of two
+	u64 ttl_ns;									// 0 for no TTL
+#if defined(__linux__)
+	int inotify;
+	i32* descriptors;							// First directory by watch descriptor, -1 if none
+	i32 descriptor_capacity;
+#endif
+} text_file_length_cache;
+
+// Per handle I/O statistics are compiled in with #define TEXT_FILE_STATS 1 before including this header and are turned on
+// for a handle with text_file_stats_enable(..). Without it the hooks in the read and write functions compile to nothing.
+#if !defined(TEXT_FILE_STATS)
+#define TEXT_FILE_STATS 0
+#endif
+
+// Number of buckets of the I/O size histogram. Bucket 0 counts the empty calls and bucket i the calls of 2^(i-1) to 2^i-1 bytes.
+#define TEXT_FILE_STATS_BUCKETS 32
+
+// The functions counted by the statistics
+typedef enum text_file_call
+{
+	TEXT_FILE_CALL_WRITE_I8, TEXT_FILE_CALL_WRITE_I16, TEXT_FILE_CALL_WRITE_I32, TEXT_FILE_CALL_WRITE_I64,
+	TEXT_FILE_CALL_WRITE_U8, TEXT_FILE_CALL_WRITE_U16, TEXT_FILE_CALL_WRITE_U32, TEXT_FILE_CALL_WRITE_U64,
+	TEXT_FILE_CALL_WRITE_F32, TEXT_FILE_CALL_WRITE_F64, TEXT_FILE_CALL_WRITE_F32_SHORTEST, TEXT_FILE_CALL_WRITE_F64_SHORTEST,
+	TEXT_FILE_CALL_WRITE_BOOL, TEXT_FILE_CALL_WRITE_BYTE, TEXT_FILE_CALL_WRITE_STR,
+	TEXT_FILE_CALL_READ_I8, TEXT_FILE_CALL_READ_I16, TEXT_FILE_CALL_READ_I32, TEXT_FILE_CALL_READ_I64,
+	TEXT_FILE_CALL_READ_U8, TEXT_FILE_CALL_READ_U16, TEXT_FILE_CALL_READ_U32, TEXT_FILE_CALL_READ_U64,
+	TEXT_FILE_CALL_READ_F32, TEXT_FILE_CALL_READ_F64, TEXT_FILE_CALL_READ_BOOL, TEXT_FILE_CALL_READ_BYTE, TEXT_FILE_CALL_READ_STR,
+	TEXT_FILE_CALL_READ_LINE, TEXT_FILE_CALL_SET_POSITION, TEXT_FILE_CALL_GET_POSITION,
+	TEXT_FILE_CALL_WRITE_ARRAY, TEXT_FILE_CALL_READ_ARRAY,
+	TEXT_FILE_CALL_COUNT
+} text_file_call;
+
+// I/O statistics of a text file. 'read_calls', 'write_calls' and 'seek_calls' count the calls into the C runtime
+// (fread, fwrite, fseek); the C runtime buffers them into fewer system calls.
+typedef struct text_file_stats
+{
+	i64 bytes_read;
+	i64 bytes_written;
+	i64 read_calls;
+	i64 write_calls;
+	i64 seek_calls;
+	u64 io_ns;									// Time spent waiting on I/O
+	u64 convert_ns;								// Time spent formatting and parsing
+	i64 calls[TEXT_FILE_CALL_COUNT];			// Calls per function
+	i64 sizes[TEXT_FILE_STATS_BUCKETS];			// Histogram of the I/O call sizes
+} text_file_stats;
+
+// Hooks of the statistics. TEXT_FILE_STATS_CONVERT(..) times a statement that formats or parses.
+#if TEXT_FILE_STATS
+#define TEXT_FILE_STATS_CALL(call, file) text_file_stats_call(call, file)
+#define TEXT_FILE_STATS_CONVERT(statement, file) u64 text_file_convert_start = text_file_clock_ns(); statement; text_file_stats_convert(text_file_convert_start, file)
+#define TEXT_FILE_STATS_RELEASE(file) text_file_stats_release(file)
+#else
+#define TEXT_FILE_STATS_CALL(call, file)
+#define TEXT_FILE_STATS_CONVERT(statement, file) statement
+#define TEXT_FILE_STATS_RELEASE(file)
+#define text_file_io_read fread
+#define text_file_io_write fwrite
+#define text_file_io_seek _fseeki64
+#endif
+
 //
 // Prototypes: Text file
 //
@@ -217,6 +1071,7 @@ text_file text_file_openfor_write_new(str filename);
 text_file text_file_openfor_write_append(str filename);
 text_file text_file_openfor_read(str filename);
 file_size text_file_get_length(str filename);
+file_size text_file_get_length_handle(text_file file);
 bool text_file_write_i8(i8 data, text_file file);
 bool text_file_write_i16(i16 data, text_file file);
 bool text_file_write_i32(i32 data, text_file file);
@@ -227,6 +1082,8 @@ bool text_file_write_u32(u32 data, text_file file);
 bool text_file_write_u64(u64 data, text_file file);
 bool text_file_write_f32(f32 data, text_file file);
 bool text_file_write_f64(f64 data, text_file file);
+bool text_file_write_f32_shortest(f32 data, text_file file);
+bool text_file_write_f64_shortest(f64 data, text_file file);
 bool text_file_write_bool(bool data, text_file file);
 bool text_file_write_byte(byte* data, i64 length, text_file file);
 bool text_file_write_str(str text, text_file file);
@@ -238,6 +1095,8 @@ bool text_file_read_u8(u8* data, u8 length, text_file file);
 bool text_file_read_u16(u16* data, u8 length, text_file file);
 bool text_file_read_u32(u32* data, u8 length, text_file file);
 bool text_file_read_u64(u64* data, u8 length, text_file file);
+bool text_file_read_f32(f32* data, u8 length, text_file file);
+bool text_file_read_f64(f64* data, u8 length, text_file file);
 bool text_file_read_bool(bool* data, text_file file);
 bool text_file_read_byte(byte* data, i64 length, text_file file);
 bool text_file_read_str(str text, i64 length, text_file file);
@@ -248,6 +1107,304 @@ bool text_file_set_position_end(text_file file);
 file_size text_file_get_position(text_file file);
 void text_file_close(text_file file);
 
+//
+// Prototypes: Positioned reads
+//
+bool text_file_pread(void* data, i64 length, file_size position, i64* bytes, text_file file);
+bool text_file_read_unsigned_at(u64* data, u64 max, u8 length, u8 max_length, file_size position, text_file file);
+bool text_file_read_signed_at(i64* data, i64 min, i64 max, u8 length, u8 max_length, file_size position, text_file file);
+bool text_file_read_i8_at(i8* data, u8 length, file_size position, text_file file);
+bool text_file_read_i16_at(i16* data, u8 length, file_size position, text_file file);
+bool text_file_read_i32_at(i32* data, u8 length, file_size position, text_file file);
+bool text_file_read_i64_at(i64* data, u8 length, file_size position, text_file file);
+bool text_file_read_u8_at(u8* data, u8 length, file_size position, text_file file);
+bool text_file_read_u16_at(u16* data, u8 length, file_size position, text_file file);
+bool text_file_read_u32_at(u32* data, u8 length, file_size position, text_file file);
+bool text_file_read_u64_at(u64* data, u8 length, file_size position, text_file file);
+bool text_file_read_f32_at(f32* data, u8 length, file_size position, text_file file);
+bool text_file_read_f64_at(f64* data, u8 length, file_size position, text_file file);
+bool text_file_read_bool_at(bool* data, file_size position, text_file file);
+bool text_file_read_byte_at(byte* data, i64 length, file_size position, text_file file);
+bool text_file_read_str_at(str text, i64 length, file_size position, text_file file);
+
+//
+// Prototypes: Number parsing
+//
+bool text_file_parse_unsigned(u64* value, u64 max, const c8* text, i64 length, i64* consumed);
+bool text_file_parse_signed(i64* value, i64 min, i64 max, const c8* text, i64 length, i64* consumed);
+bool text_file_read_unsigned(u64* data, u64 max, u8 length, u8 max_length, text_file file);
+bool text_file_read_signed(i64* data, i64 min, i64 max, u8 length, u8 max_length, text_file file);
+bool text_file_parse_f32(f32* value, const c8* text, i64 length, i64* consumed);
+bool text_file_parse_f64(f64* value, const c8* text, i64 length, i64* consumed);
+
+//
+// Prototypes: Number formatting
+//
+u8 text_file_count_digits(u64 value);
+u8 text_file_format_unsigned(u64 value, c8* buffer);
+u8 text_file_format_signed(i64 value, c8* buffer);
+u8 text_file_format_f32(f32 value, c8* buffer);
+u8 text_file_format_f64(f64 value, c8* buffer);
+
+//
+// Prototypes: Byte scanning
+//
+u32 text_file_trailing_zeros(u32 mask);
+u32 text_file_trailing_zeros_u64(u64 mask);
+u64 text_file_prefix_xor(u64 mask);
+i64 text_file_find_byte(const byte* data, i64 length, byte value);
+i64 text_file_find_last_byte(const byte* data, i64 length, byte value);
+i64 text_file_count_byte(const byte* data, i64 length, byte value);
+i64 text_file_find_pattern(const c8* data, i64 length, const c8* pattern, i64 pattern_length);
+
+//
+// Prototypes: Line reader
+//
+bool text_file_openfor_read_lines(text_file_line_reader* reader, str filename, i64 buffer_size);
+bool text_file_read_line(c8** line, i64* length, text_file_line_reader* reader);
+void text_file_close_lines(text_file_line_reader* reader);
+
+//
+// Prototypes: Reverse line reader
+//
+bool text_file_openfor_read_lines_reverse(text_file_reverse_line_reader* reader, str filename, i64 buffer_size);
+bool text_file_read_line_reverse(c8** line, i64* length, text_file_reverse_line_reader* reader);
+void text_file_close_lines_reverse(text_file_reverse_line_reader* reader);
+
+//
+// Prototypes: Line index
+//
+bool text_file_line_index_build(text_file_line_index* index, str filename, i64 stride);
+bool text_file_set_position_line(i64 line, text_file_line_index* index, text_file file);
+void text_file_line_index_free(text_file_line_index* index);
+
+//
+// Prototypes: Threads
+//
+bool text_file_thread_start(text_file_thread* thread, text_file_thread_proc proc, void* argument);
+void text_file_thread_join(text_file_thread thread);
+i32 text_file_cpu_count(void);
+u64 text_file_clock_ns(void);
+i32 text_file_atomic_load_i32(volatile i32* value);
+void text_file_atomic_store_i32(volatile i32* value, i32 new_value);
+void text_file_mutex_init(text_file_mutex* mutex);
+void text_file_mutex_destroy(text_file_mutex* mutex);
+void text_file_mutex_lock(text_file_mutex* mutex);
+void text_file_mutex_unlock(text_file_mutex* mutex);
+void text_file_condition_init(text_file_condition* condition);
+void text_file_condition_destroy(text_file_condition* condition);
+void text_file_condition_wait(text_file_condition* condition, text_file_mutex* mutex);
+void text_file_condition_signal(text_file_condition* condition);
+void text_file_condition_broadcast(text_file_condition* condition);
+void text_file_condition_wait_ms(text_file_condition* condition, text_file_mutex* mutex, i32 milliseconds);
+void text_file_yield(void);
+void text_file_sleep_ms(i32 milliseconds);
+i64 text_file_atomic_load_i64(volatile i64* value);
+void text_file_atomic_store_i64(volatile i64* value, i64 new_value);
+bool text_file_atomic_cas_i64(volatile i64* value, i64 expected, i64 new_value);
+i64 text_file_atomic_add_i64(volatile i64* value, i64 amount);
+
+//
+// Prototypes: Parallel processing
+//
+bool text_file_process_parallel(str filename, i32 ranges, i64 chunk_size, text_file_chunk_callback callback, text_file_reduce_callback reduce, void* user);
+
+//
+// Prototypes: File lengths
+//
+u64 text_file_length_cache_hash(const c8* text, i64 length);
+bool text_file_length_cache_init(text_file_length_cache* cache, i32 ttl_ms);
+void text_file_length_cache_free(text_file_length_cache* cache);
+void text_file_length_cache_watch(text_file_length_cache* cache, i32 directory);
+i32 text_file_length_cache_directory(text_file_length_cache* cache, const c8* path, i64 length);
+i64 text_file_length_cache_find(text_file_length_cache* cache, i32 directory, const c8* name, i64 name_length, u64 hash);
+i64 text_file_length_cache_slot(text_file_length_cache* cache, str filename);
+void text_file_length_cache_invalidate(text_file_length_cache* cache, i32 directory);
+void text_file_length_cache_update(text_file_length_cache* cache);
+bool text_file_length_cache_usable(text_file_length_cache* cache, const text_file_length_entry* entry, u64 now);
+file_size text_file_length_cache_stat(str filename, bool* cacheable);
+file_size text_file_length_cache_get(text_file_length_cache* cache, str filename);
+void text_file_get_lengths(file_size* lengths, str* filenames, i64 count, i32 threads, text_file_length_cache* cache);
+
+//
+// Prototypes: Read-ahead text file
+//
+bool text_file_openfor_read_async(text_file_async* async, str filename, i64 buffer_size, i32 depth);
+void text_file_close_async(text_file_async* async);
+
+//
+// Prototypes: Log
+//
+bool text_file_openfor_write_log(text_file_log* log, str filename, i64 capacity, text_file_log_policy policy);
+bool text_file_log_write(const byte* data, i64 length, text_file_log* log);
+bool text_file_log_write_str(str text, text_file_log* log);
+bool text_file_log_flush(text_file_log* log);
+i64 text_file_log_dropped(text_file_log* log);
+bool text_file_close_log(text_file_log* log);
+
+//
+// Prototypes: Newline conversion
+//
+i64 text_file_newlines_to_lf(c8* destination, const c8* source, i64 length, bool* pending);
+i64 text_file_newlines_to_crlf(c8* destination, const c8* source, i64 length, c8* previous);
+i64 text_file_newlines_convert(c8* destination, const c8* source, i64 length, text_file_newlines* newlines);
+bool text_file_newlines_open(text_file_newlines* newlines, str filename, text_file_newline newline, bool writing);
+bool text_file_openfor_read_newlines(text_file_newlines* newlines, str filename, text_file_newline newline);
+bool text_file_openfor_write_newlines(text_file_newlines* newlines, str filename, text_file_newline newline);
+bool text_file_close_newlines(text_file_newlines* newlines);
+
+//
+// Prototypes: UTF-8
+//
+u32 text_file_utf8_decode(const c8* data, i64 length, u32* code_point);
+i64 text_file_utf8_find_error_from(const c8* data, i64 length, i64 position);
+i64 text_file_utf8_find_error(const c8* data, i64 length);
+void text_file_utf8_validator_init(text_file_utf8_validator* validator);
+bool text_file_utf8_validate(text_file_utf8_validator* validator, const c8* data, i64 length);
+bool text_file_utf8_validate_end(text_file_utf8_validator* validator);
+bool text_file_read_str_utf8(str text, i64 length, i64* error_offset, text_file file);
+i64 text_file_utf8_to_utf16(u16* destination, const c8* source, i64 length, i64* error_offset);
+i64 text_file_utf8_to_utf32(u32* destination, const c8* source, i64 length, i64* error_offset);
+
+//
+// Prototypes: Search
+//
+bool text_file_search_compile(text_file_search* search, const c8** patterns, const i64* lengths, i32 count, bool lines);
+void text_file_search_free(text_file_search* search);
+#if TEXT_FILE_SSSE3
+bool text_file_search_compile_teddy(text_file_search* search);
+bool text_file_search_verify(text_file_search_run* run, u32 buckets, const c8* buffer, i64 start, i64 fresh, i64 length, file_size base);
+bool text_file_search_teddy(text_file_search_run* run, const c8* buffer, i64 fresh, i64 length, file_size base);
+u32 text_file_search_candidates(text_file_search* search, const c8* block);
+#endif
+bool text_file_search_report(text_file_search_run* run, i32 pattern, const c8* buffer, file_size base, i64 start);
+bool text_file_search_block(text_file_search_run* run, const c8* buffer, i64 fresh, i64 length, file_size base);
+bool text_file_search_file(text_file_search* search, text_file file, text_file_search_callback callback, void* user);
+bool text_file_search_mapped(text_file_search* search, text_file_mapped* mapped, text_file_search_callback callback, void* user);
+
+//
+// Prototypes: Follow
+//
+bool text_file_watch_init(text_file_watch* watch);
+void text_file_watch_free(text_file_watch* watch);
+text_file_follow* text_file_watch_wait(text_file_watch* watch, i32 timeout_ms);
+bool text_file_openfor_follow(text_file_follow* follow, str filename, bool from_end, text_file_watch* watch);
+i64 text_file_follow_read(c8* data, i64 capacity, text_file_follow* follow);
+bool text_file_follow_read_line(c8** line, i64* length, text_file_follow* follow);
+void text_file_close_follow(text_file_follow* follow);
+text_file text_file_follow_open_file(str filename);
+bool text_file_follow_identity(text_file file, str filename, u64* device, u64* inode, u64* created, file_size* size);
+void text_file_follow_set_ready(text_file_follow* follow);
+bool text_file_follow_attach(text_file_follow* follow);
+void text_file_follow_detach(text_file_follow* follow);
+bool text_file_follow_rotate(text_file_follow* follow);
+void text_file_watch_poll(text_file_watch* watch);
+
+//
+// Prototypes: CSV
+//
+bool text_file_read_csv(text_file_csv* csv, str filename, c8 delimiter, const text_file_column_type* types, i32 column_count, bool header);
+i64* text_file_csv_i64(text_file_csv* csv, i32 column);
+f64* text_file_csv_f64(text_file_csv* csv, i32 column);
+bool* text_file_csv_bool(text_file_csv* csv, i32 column);
+text_file_view* text_file_csv_string(text_file_csv* csv, i32 column);
+void text_file_close_csv(text_file_csv* csv);
+void text_file_csv_classify(const c8* block, c8 delimiter, u64* quotes, u64* delimiters, u64* newlines);
+bool text_file_csv_grow(text_file_csv* csv);
+bool text_file_csv_unescape(text_file_view* view, text_file_csv* csv);
+bool text_file_csv_field(text_file_csv* csv, const c8* text, i64 length, bool end_of_row);
+
+//
+// Prototypes: Arrays
+//
+bool text_file_write_array(text_file_type type, const void* data, i64 count, str separator, text_file file);
+bool text_file_read_array(text_file_type type, void* data, i64 count, str separator, text_file file);
+bool text_file_write_i8_array(const i8* data, i64 count, str separator, text_file file);
+bool text_file_write_i16_array(const i16* data, i64 count, str separator, text_file file);
+bool text_file_write_i32_array(const i32* data, i64 count, str separator, text_file file);
+bool text_file_write_i64_array(const i64* data, i64 count, str separator, text_file file);
+bool text_file_write_u8_array(const u8* data, i64 count, str separator, text_file file);
+bool text_file_write_u16_array(const u16* data, i64 count, str separator, text_file file);
+bool text_file_write_u32_array(const u32* data, i64 count, str separator, text_file file);
+bool text_file_write_u64_array(const u64* data, i64 count, str separator, text_file file);
+bool text_file_write_f32_array(const f32* data, i64 count, str separator, text_file file);
+bool text_file_write_f64_array(const f64* data, i64 count, str separator, text_file file);
+bool text_file_read_i8_array(i8* data, i64 count, str separator, text_file file);
+bool text_file_read_i16_array(i16* data, i64 count, str separator, text_file file);
+bool text_file_read_i32_array(i32* data, i64 count, str separator, text_file file);
+bool text_file_read_i64_array(i64* data, i64 count, str separator, text_file file);
+bool text_file_read_u8_array(u8* data, i64 count, str separator, text_file file);
+bool text_file_read_u16_array(u16* data, i64 count, str separator, text_file file);
+bool text_file_read_u32_array(u32* data, i64 count, str separator, text_file file);
+bool text_file_read_u64_array(u64* data, i64 count, str separator, text_file file);
+bool text_file_read_f32_array(f32* data, i64 count, str separator, text_file file);
+bool text_file_read_f64_array(f64* data, i64 count, str separator, text_file file);
+u8 text_file_type_width(text_file_type type);
+u8 text_file_format_value(text_file_type type, const void* data, i64 index, c8* buffer);
+bool text_file_parse_value(text_file_type type, void* data, i64 index, const c8* text, i64 length, i64* consumed);
+
+//
+// Prototypes: Records
+//
+bool text_file_record_plan_compile(text_file_record_plan* plan, const text_file_record_field* fields, i32 field_count, str terminator);
+void text_file_record_plan_free(text_file_record_plan* plan);
+bool text_file_read_record(void* record, const text_file_record_plan* plan, text_file file);
+bool text_file_read_records(void* records, i64 count, i64 record_size, const text_file_record_plan* plan, text_file file);
+bool text_file_parse_record(void* record, const text_file_record_plan* plan, const c8* text);
+
+//
+// Prototypes: Copy
+//
+bool text_file_copy(str source, str destination);
+bool text_file_copy_range(text_file source, file_size source_position, file_size length, text_file destination, file_size destination_position);
+bool text_file_copy_chunked(text_file source, file_size source_position, file_size length, text_file destination, file_size destination_position);
+bool text_file_copy_stream(text_file source, text_file destination);
+
+//
+// Prototypes: Statistics
+//
+bool text_file_stats_enable(text_file file, FILE* dump);
+bool text_file_get_stats(text_file_stats* stats, text_file file);
+void text_file_stats_print(const text_file_stats* stats, FILE* out);
+#if TEXT_FILE_STATS
+text_file_stats* text_file_stats_find(text_file file);
+void text_file_stats_call(text_file_call call, text_file file);
+void text_file_stats_convert(u64 start, text_file file);
+void text_file_stats_release(text_file file);
+size_t text_file_io_read(void* data, size_t size, size_t count, text_file file);
+size_t text_file_io_write(const void* data, size_t size, size_t count, text_file file);
+int text_file_io_seek(text_file file, file_size offset, int origin);
+#endif
+
+//
+// Prototypes: Allocators
+//
+void* text_file_heap_allocate(void* context, size_t size);
+void text_file_heap_release(void* context, void* data, size_t size);
+void text_file_set_allocator(const text_file_allocator* allocator);
+text_file_allocator text_file_get_allocator(void);
+void* text_file_allocate(size_t size, const text_file_allocator* allocator);
+void text_file_release(void* data, size_t size, const text_file_allocator* allocator);
+void text_file_arena_init(text_file_arena* arena, void* buffer, size_t size);
+void* text_file_arena_allocate(text_file_arena* arena, size_t size);
+void text_file_arena_reset(text_file_arena* arena);
+void text_file_arena_free(text_file_arena* arena);
+text_file_allocator text_file_arena_allocator(text_file_arena* arena);
+void text_file_pool_init(text_file_pool* pool);
+void* text_file_pool_allocate(text_file_pool* pool, size_t size);
+void text_file_pool_release(text_file_pool* pool, void* data, size_t size);
+void text_file_pool_free(text_file_pool* pool);
+text_file_allocator text_file_pool_allocator(text_file_pool* pool);
+bool text_file_slurp(c8** text, i64* length, str filename, const text_file_allocator* allocator);
+
+//
+// Prototypes: Memory mapped text file
+//
+bool text_file_openfor_read_mapped(text_file_mapped* mapped, str filename);
+byte* text_file_mapped_at_position(text_file_mapped* mapped);
+bool text_file_read_mapped(byte** data, i64 length, text_file_mapped* mapped);
+void text_file_close_mapped(text_file_mapped* mapped);
+
 //
 // Implementations: Text file
 //
@@ -276,28 +1433,50 @@ text_file text_file_openfor_read(str filename)
 
 	return file;
 }
-// Get the length of a text file. Note: This function returns -1 if the text file is not found
+// Get the length of a text file from the file system, without opening it.
+// Note: This function returns -1 if the text file is not found
 file_size text_file_get_length(str filename)
 {
-	text_file file = text_file_openfor_read(filename);
-	if (file == NULL)
+#if defined(_WIN32)
+	WIN32_FILE_ATTRIBUTE_DATA information;
+	if (!GetFileAttributesExA((const char*)filename, GetFileExInfoStandard, &information) || (information.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
 		return -1; // Return -1 if the text file is not found
 
-	if (_fseeki64(file, 0, SEEK_END) != 0)
-		return -1; // Failure
+	return (file_size)(((u64)information.nFileSizeHigh << 32) | information.nFileSizeLow); // Return the length of the text file
+#else
+	struct stat information;
+	if (stat((const char*)filename, &information) != 0 || S_ISDIR(information.st_mode))
+		return -1; // Return -1 if the text file is not found
 
-	file_size length = _ftelli64(file);
+	return (file_size)information.st_size; // Return the length of the text file
+#endif
+}
+// Get the length of an open text file without moving its position. Returns -1 on failure.
+// Note: Data still in the write buffer of 'file' is not counted. Call fflush(file) first.
+file_size text_file_get_length_handle(text_file file)
+{
+#if defined(_WIN32)
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+	LARGE_INTEGER size;
+	if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size))
+		return -1; // Failure
 
-	text_file_close(file);
+	return (file_size)size.QuadPart;
+#else
+	struct stat information;
+	if (fstat(fileno(file), &information) != 0)
+		return -1; // Failure
 
-	return length; // Return the length of the text file
+	return (file_size)information.st_size;
+#endif
 }
 // Write 'i8' data to a text file as text
 bool text_file_write_i8(i8 data, text_file file)
 {
-	char buffer[5] = { 0 };
-	sprintf(buffer, "%hhi", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_I8, file);
+	c8 buffer[4];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_signed((signed char)data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -305,9 +1484,10 @@ bool text_file_write_i8(i8 data, text_file file)
 // Write 'i16' data to a text file as text
 bool text_file_write_i16(i16 data, text_file file)
 {
-	char buffer[7] = { 0 };
-	sprintf(buffer, "%hi", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_I16, file);
+	c8 buffer[6];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_signed(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -315,9 +1495,10 @@ bool text_file_write_i16(i16 data, text_file file)
 // Write 'i32' data to a text file as text
 bool text_file_write_i32(i32 data, text_file file)
 {
-	char buffer[12] = { 0 };
-	sprintf(buffer, "%i", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_I32, file);
+	c8 buffer[11];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_signed(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -325,9 +1506,10 @@ bool text_file_write_i32(i32 data, text_file file)
 // Write 'i64' data to a text file as text
 bool text_file_write_i64(i64 data, text_file file)
 {
-	char buffer[21] = { 0 };
-	sprintf(buffer, "%lli", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_I64, file);
+	c8 buffer[20];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_signed(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -335,9 +1517,10 @@ bool text_file_write_i64(i64 data, text_file file)
 // Write 'u8' data to a text file as text
 bool text_file_write_u8(u8 data, text_file file)
 {
-	char buffer[4] = { 0 };
-	sprintf(buffer, "%hhu", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_U8, file);
+	c8 buffer[3];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_unsigned(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -345,9 +1528,10 @@ bool text_file_write_u8(u8 data, text_file file)
 // Write 'u16' data to a text file as text
 bool text_file_write_u16(u16 data, text_file file)
 {
-	char buffer[6] = { 0 };
-	sprintf(buffer, "%hu", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_U16, file);
+	c8 buffer[5];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_unsigned(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -355,9 +1539,10 @@ bool text_file_write_u16(u16 data, text_file file)
 // Write 'u32' data to a text file as text
 bool text_file_write_u32(u32 data, text_file file)
 {
-	char buffer[11] = { 0 };
-	sprintf(buffer, "%u", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_U32, file);
+	c8 buffer[10];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_unsigned(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -365,53 +1550,73 @@ bool text_file_write_u32(u32 data, text_file file)
 // Write 'u64' data to a text file as text
 bool text_file_write_u64(u64 data, text_file file)
 {
-	char buffer[21] = { 0 };
-	sprintf(buffer, "%llu", data);
-	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_U64, file);
+	c8 buffer[20];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_unsigned(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
 }
-// Write 'f32' data to a text file as text
+// Write 'f32' data to a text file as text. The format is the same as printf's "%f".
 bool text_file_write_f32(f32 data, text_file file)
 {
-	// We are using snprintf instead of sprintf because sprintf does not handle float's well as it would need to handle a large number of digits.
-	int len = snprintf(NULL, 0, "%f", data);
-	char* str_data = malloc(len + 1);
-	if(str_data == NULL)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_F32, file);
+	// "%f" of the largest float is 46 chars, so a stack buffer is enough and it is formatted in one pass
+	char buffer[64];
+	TEXT_FILE_STATS_CONVERT(int length = snprintf(buffer, sizeof(buffer), "%f", data), file);
+	if (length < 0 || length >= (int)sizeof(buffer))
 		return false; // Something went wrong while trying to write the data
-	snprintf(str_data, len + 1, "%f", data);
 
-	if (fwrite(str_data, sizeof(char), strlen(str_data), file) != strlen(str_data))
+	if (text_file_io_write(buffer, sizeof(char), length, file) != (size_t)length)
 		return false; // Something went wrong while trying to write the data
 
-	free(str_data);
-
 	return true; // Success
 }
-// Write 'f64' data to a text file as text
+// Write 'f64' data to a text file as text. The format is the same as printf's "%lf".
 bool text_file_write_f64(f64 data, text_file file)
 {
-	// We are using snprintf instead of sprintf because sprintf does not handle double's well as it would need to handle a large number of digits.
-	int len = snprintf(NULL, 0, "%lf", data);
-	char* str_data = malloc(len + 1);
-	if (str_data == NULL)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_F64, file);
+	// "%lf" of the largest double is 317 chars, so a stack buffer is enough and it is formatted in one pass
+	char buffer[320];
+	TEXT_FILE_STATS_CONVERT(int length = snprintf(buffer, sizeof(buffer), "%lf", data), file);
+	if (length < 0 || length >= (int)sizeof(buffer))
+		return false; // Something went wrong while trying to write the data
+
+	if (text_file_io_write(buffer, sizeof(char), length, file) != (size_t)length)
 		return false; // Something went wrong while trying to write the data
-	snprintf(str_data, len + 1, "%lf", data);
 
-	if (fwrite(str_data, sizeof(char), strlen(str_data), file) != strlen(str_data))
+	return true; // Success
+}
+// Write 'f32' data to a text file as the shortest text that reads back as the same value, like "0.1" or "1.5e+30"
+bool text_file_write_f32_shortest(f32 data, text_file file)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_F32_SHORTEST, file);
+	c8 buffer[TEXT_FILE_FLOAT_BUFFER];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_f32(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
-	free(str_data);
+	return true; // Success
+}
+// Write 'f64' data to a text file as the shortest text that reads back as the same value, like "0.1" or "1.5e+300"
+bool text_file_write_f64_shortest(f64 data, text_file file)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_F64_SHORTEST, file);
+	c8 buffer[TEXT_FILE_FLOAT_BUFFER];
+	TEXT_FILE_STATS_CONVERT(u8 length = text_file_format_f64(data, buffer), file);
+	if (text_file_io_write(buffer, sizeof(char), length, file) != length)
+		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
 }
 // Write 'bool' data to a text file as text. Writing 'true' as '1' and 'false' as '0'.
 bool text_file_write_bool(bool data, text_file file)
 {
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_BOOL, file);
 	char buffer = data ? '1' : '0';
 
-	if (fwrite(&buffer, sizeof(char), 1, file) != 1)
+	if (text_file_io_write(&buffer, sizeof(char), 1, file) != 1)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -419,7 +1624,8 @@ bool text_file_write_bool(bool data, text_file file)
 // Write 'byte' data to a text file.
 bool text_file_write_byte(byte* data, i64 length, text_file file)
 {
-	if (fwrite(data, sizeof(byte), length, file) != length)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_BYTE, file);
+	if (text_file_io_write(data, sizeof(byte), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -427,7 +1633,9 @@ bool text_file_write_byte(byte* data, i64 length, text_file file)
 // Write 'str' data to a text file
 bool text_file_write_str(str text, text_file file)
 {
-	if (fwrite(text, sizeof(char), strlen(text), file) != strlen(text))
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_STR, file);
+	size_t length = strlen((const char*)text);
+	if (text_file_io_write(text, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to write the data
 
 	return true; // Success
@@ -435,218 +1643,127 @@ bool text_file_write_str(str text, text_file file)
 // Read 'i8' data from a text file from part of string
 bool text_file_read_i8(i8* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 4;
-	if(length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_I8, file);
+	i64 value = 0;
+	if (!text_file_read_signed(&value, SCHAR_MIN, SCHAR_MAX, length, 4, file))
 		return false; // Something went wrong while trying to read the data
 
-	if(fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%hhi", data) != 1)
-		return false; // Something went wrong while trying to read the data
-
-	free(value);
+	*data = (i8)value;
 
 	return true; // Success
 }
 // Read 'i16' data from a text file from part of string
 bool text_file_read_i16(i16* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 6;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%hi", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_I16, file);
+	i64 value = 0;
+	if (!text_file_read_signed(&value, SHRT_MIN, SHRT_MAX, length, 6, file))
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
+	*data = (i16)value;
 
 	return true; // Success
 }
 // Read 'i32' data from a text file from part of string
 bool text_file_read_i32(i32* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 11;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_I32, file);
+	i64 value = 0;
+	if (!text_file_read_signed(&value, INT_MIN, INT_MAX, length, 11, file))
 		return false; // Something went wrong while trying to read the data
 
-	if (sscanf(value, "%i", data) != 1)
-		return false; // Something went wrong while trying to read the data
-
-	free(value);
+	*data = (i32)value;
 
 	return true; // Success
 }
 // Read 'i64' data from a text file from part of string
 bool text_file_read_i64(i64* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 20;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%lli", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_I64, file);
+	i64 value = 0;
+	if (!text_file_read_signed(&value, LLONG_MIN, LLONG_MAX, length, 20, file))
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
+	*data = (i64)value;
 
 	return true; // Success
 }
 // Read 'u8' data from a text file from part of string
 bool text_file_read_u8(u8* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 3;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%hhu", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_U8, file);
+	u64 value = 0;
+	if (!text_file_read_unsigned(&value, UCHAR_MAX, length, 3, file))
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
+	*data = (u8)value;
 
 	return true; // Success
 }
 // Read 'u16' data from a text file from part of string
 bool text_file_read_u16(u16* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 5;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%hu", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_U16, file);
+	u64 value = 0;
+	if (!text_file_read_unsigned(&value, USHRT_MAX, length, 5, file))
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
+	*data = (u16)value;
 
 	return true; // Success
 }
 // Read 'u32' data from a text file from part of string
 bool text_file_read_u32(u32* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 10;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_U32, file);
+	u64 value = 0;
+	if (!text_file_read_unsigned(&value, UINT_MAX, length, 10, file))
 		return false; // Something went wrong while trying to read the data
 
-	if (sscanf(value, "%u", data) != 1)
-		return false; // Something went wrong while trying to read the data
-
-	free(value);
+	*data = (u32)value;
 
 	return true; // Success
 }
 // Read 'u64' data from a text file from part of string
 bool text_file_read_u64(u64* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 20;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%llu", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_U64, file);
+	u64 value = 0;
+	if (!text_file_read_unsigned(&value, ULLONG_MAX, length, 20, file))
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
+	*data = (u64)value;
 
 	return true; // Success
 }
 // Read 'f32' data from a text file from part of string. The 'length' is the number of chars to read.
 bool text_file_read_f32(f32* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 20;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_F32, file);
+	c8 value[256]; // Large enough for any 'length'. No heap allocation needed.
+	if (text_file_io_read(value, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to read the data
 
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%f", data) != 1)
-		return false; // Something went wrong while trying to read the data
-
-	free(value);
-
-	return true; // Success
+	TEXT_FILE_STATS_CONVERT(bool ok = text_file_parse_f32(data, value, length, NULL), file);
+	return ok;
 }
 // Read 'f64' data from a text file from part of string. The 'length' is the number of chars to read.
 bool text_file_read_f64(f64* data, u8 length, text_file file)
 {
-	const u8 MAX_LENGTH = 20;
-	if (length > MAX_LENGTH) // Clamp it to 'length' so that it doesn't go out of bounds
-		length = MAX_LENGTH;
-
-	str value = calloc(MAX_LENGTH + 1, sizeof(char));
-	if (value == NULL)
-		return false; // Something went wrong while trying to read the data
-
-	if (fread(value, sizeof(char), length, file) != length)
-		return false; // Something went wrong while trying to read the data
-
-	if (sscanf(value, "%lf", data) != 1)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_F64, file);
+	c8 value[256]; // Large enough for any 'length'. No heap allocation needed.
+	if (text_file_io_read(value, sizeof(char), length, file) != length)
 		return false; // Something went wrong while trying to read the data
 
-	free(value);
-
-	return true; // Success
+	TEXT_FILE_STATS_CONVERT(bool ok = text_file_parse_f64(data, value, length, NULL), file);
+	return ok;
 }
 // Read 'bool' data from a text file. Read character '1' for true and '0' for false.
 bool text_file_read_bool(bool* data, text_file file)
 {
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_BOOL, file);
 	c8 value = '\0';
-	if (fread(&value, sizeof(char), 1, file) != 1)
+	if (text_file_io_read(&value, sizeof(char), 1, file) != 1)
 		return false; // Something went wrong while trying to read the data
 
 	if (value == '0')
@@ -665,7 +1782,8 @@ bool text_file_read_bool(bool* data, text_file file)
 // Read 'byte' data from a text file
 bool text_file_read_byte(byte* data, i64 length, text_file file)
 {
-	if (fread(data, sizeof(byte), length, file) != length)
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_BYTE, file);
+	if (text_file_io_read(data, sizeof(byte), length, file) != length)
 		return false; // Something went wrong while trying to read the data
 
 	return true; // Success
@@ -673,8 +1791,9 @@ bool text_file_read_byte(byte* data, i64 length, text_file file)
 // Read 'str' data from a text file
 bool text_file_read_str(str text, i64 length, text_file file)
 {
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_STR, file);
 	// Read specified portion of the text file into memory. Typically all of the file.
-	i64 bytes = fread(text, sizeof(char), length, file);
+	i64 bytes = text_file_io_read(text, sizeof(char), length, file);
 	if (ferror(file) != 0)
 		return false; // Error reading file
 
@@ -685,30 +1804,7769 @@ bool text_file_read_str(str text, i64 length, text_file file)
 // Seek to the beginning of a text file
 bool text_file_set_position_begin(text_file file)
 {
-	return (_fseeki64(file, 0, SEEK_SET) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_SET_POSITION, file);
+	return (text_file_io_seek(file, 0, SEEK_SET) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
 }
 // Seek to an absolute position in a text file
 bool text_file_set_position(file_size position, text_file file)
 {
-	return (_fseeki64(file, position, SEEK_SET) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_SET_POSITION, file);
+	return (text_file_io_seek(file, position, SEEK_SET) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
 }
 // Seek to a relative position in a text file
 bool text_file_set_position_relative(file_size position, text_file file)
 {
-	return (_fseeki64(file, position, SEEK_CUR) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_SET_POSITION, file);
+	return (text_file_io_seek(file, position, SEEK_CUR) == 0); // Returns true if the seek returns 0 meaning that the seek was successful
 }
 // Seek to the end of a text file
 bool text_file_set_position_end(text_file file)
 {
-	return (_fseeki64(file, 0, SEEK_END) == 0); // Note: the regular fseek() supports only file sizes up to 2GB. This _fseeki64() supports up to 8 Exabytes.
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_SET_POSITION, file);
+	return (text_file_io_seek(file, 0, SEEK_END) == 0); // Note: the regular fseek() supports only file sizes up to 2GB. This _fseeki64() supports up to 8 Exabytes.
 }
 // Get the current position in a text file
 file_size text_file_get_position(text_file file)
 {
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_GET_POSITION, file);
 	return _ftelli64(file);
 }
 // Close a text file
 void text_file_close(text_file file)
 {
+	TEXT_FILE_STATS_RELEASE(file);
 	fclose(file);
 }
+
+//
+// Implementations: Positioned reads
+//
+// Each read takes its own file offset and goes straight to the descriptor of the text file (pread, or ReadFile with an
+// offset on Windows). There is no shared position and no lock, so any number of threads can read one open file at once.
+// The stdio buffer and position of the file are not used, so use these on files that are only read. On Windows the
+// position of the descriptor moves, so do not mix them with the sequential reads on the same file there.
+//
+
+// Read up to 'length' bytes at 'position'. 'bytes' is set to the number of bytes read, which is less than 'length' only
+// at the end of the file.
+bool text_file_pread(void* data, i64 length, file_size position, i64* bytes, text_file file)
+{
+	*bytes = 0;
+#if defined(_WIN32)
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+	if (handle == INVALID_HANDLE_VALUE)
+		return false; // Failure
+	while (*bytes < length)
+	{
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(overlapped));
+		u64 offset = (u64)(position + *bytes);
+		overlapped.Offset = (DWORD)offset;
+		overlapped.OffsetHigh = (DWORD)(offset >> 32);
+		DWORD request = (length - *bytes > 0x40000000) ? 0x40000000 : (DWORD)(length - *bytes);
+		DWORD done = 0;
+		if (!ReadFile(handle, (byte*)data + *bytes, request, &done, &overlapped))
+			return GetLastError() == ERROR_HANDLE_EOF; // End of the file, or error
+		if (done == 0)
+			break; // End of the file
+		*bytes += done;
+	}
+#else
+	int descriptor = fileno(file);
+	while (*bytes < length)
+	{
+		ssize_t done = pread(descriptor, (byte*)data + *bytes, (size_t)(length - *bytes), (off_t)(position + *bytes));
+		if (done < 0)
+		{
+			if (errno == EINTR)
+				continue; // Interrupted. Try again.
+			return false; // Error reading file
+		}
+		if (done == 0)
+			break; // End of the file
+		*bytes += done;
+	}
+#endif
+
+	return true; // Success
+}
+// Read an unsigned number of 'length' characters at 'position'. See text_file_read_unsigned(..).
+bool text_file_read_unsigned_at(u64* data, u64 max, u8 length, u8 max_length, file_size position, text_file file)
+{
+	if (length > max_length) // Clamp it to 'length' so that it doesn't go out of bounds
+		length = max_length;
+
+	c8 value[32]; // Large enough for any integer type. No heap allocation needed.
+	if (length > sizeof(value))
+		length = sizeof(value);
+
+	i64 bytes;
+	if (!text_file_pread(value, length, position, &bytes, file) || bytes != length)
+		return false; // Something went wrong while trying to read the data
+
+	return text_file_parse_unsigned(data, max, value, length, NULL);
+}
+// Read a signed number of 'length' characters at 'position'. See text_file_read_signed(..).
+bool text_file_read_signed_at(i64* data, i64 min, i64 max, u8 length, u8 max_length, file_size position, text_file file)
+{
+	if (length > max_length) // Clamp it to 'length' so that it doesn't go out of bounds
+		length = max_length;
+
+	c8 value[32]; // Large enough for any integer type. No heap allocation needed.
+	if (length > sizeof(value))
+		length = sizeof(value);
+
+	i64 bytes;
+	if (!text_file_pread(value, length, position, &bytes, file) || bytes != length)
+		return false; // Something went wrong while trying to read the data
+
+	return text_file_parse_signed(data, min, max, value, length, NULL);
+}
+// Read 'i8' data from a text file at 'position'
+bool text_file_read_i8_at(i8* data, u8 length, file_size position, text_file file)
+{
+	i64 value = 0;
+	if (!text_file_read_signed_at(&value, SCHAR_MIN, SCHAR_MAX, length, 4, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (i8)value;
+
+	return true; // Success
+}
+// Read 'i16' data from a text file at 'position'
+bool text_file_read_i16_at(i16* data, u8 length, file_size position, text_file file)
+{
+	i64 value = 0;
+	if (!text_file_read_signed_at(&value, SHRT_MIN, SHRT_MAX, length, 6, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (i16)value;
+
+	return true; // Success
+}
+// Read 'i32' data from a text file at 'position'
+bool text_file_read_i32_at(i32* data, u8 length, file_size position, text_file file)
+{
+	i64 value = 0;
+	if (!text_file_read_signed_at(&value, INT_MIN, INT_MAX, length, 11, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (i32)value;
+
+	return true; // Success
+}
+// Read 'i64' data from a text file at 'position'
+bool text_file_read_i64_at(i64* data, u8 length, file_size position, text_file file)
+{
+	i64 value = 0;
+	if (!text_file_read_signed_at(&value, LLONG_MIN, LLONG_MAX, length, 20, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (i64)value;
+
+	return true; // Success
+}
+// Read 'u8' data from a text file at 'position'
+bool text_file_read_u8_at(u8* data, u8 length, file_size position, text_file file)
+{
+	u64 value = 0;
+	if (!text_file_read_unsigned_at(&value, UCHAR_MAX, length, 3, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (u8)value;
+
+	return true; // Success
+}
+// Read 'u16' data from a text file at 'position'
+bool text_file_read_u16_at(u16* data, u8 length, file_size position, text_file file)
+{
+	u64 value = 0;
+	if (!text_file_read_unsigned_at(&value, USHRT_MAX, length, 5, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (u16)value;
+
+	return true; // Success
+}
+// Read 'u32' data from a text file at 'position'
+bool text_file_read_u32_at(u32* data, u8 length, file_size position, text_file file)
+{
+	u64 value = 0;
+	if (!text_file_read_unsigned_at(&value, UINT_MAX, length, 10, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (u32)value;
+
+	return true; // Success
+}
+// Read 'u64' data from a text file at 'position'
+bool text_file_read_u64_at(u64* data, u8 length, file_size position, text_file file)
+{
+	u64 value = 0;
+	if (!text_file_read_unsigned_at(&value, ULLONG_MAX, length, 20, position, file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = (u64)value;
+
+	return true; // Success
+}
+// Read 'f32' data from a text file at 'position'
+bool text_file_read_f32_at(f32* data, u8 length, file_size position, text_file file)
+{
+	c8 value[256]; // Large enough for any 'length'. No heap allocation needed.
+	i64 bytes;
+	if (!text_file_pread(value, length, position, &bytes, file) || bytes != length)
+		return false; // Something went wrong while trying to read the data
+
+	return text_file_parse_f32(data, value, length, NULL);
+}
+// Read 'f64' data from a text file at 'position'
+bool text_file_read_f64_at(f64* data, u8 length, file_size position, text_file file)
+{
+	c8 value[256]; // Large enough for any 'length'. No heap allocation needed.
+	i64 bytes;
+	if (!text_file_pread(value, length, position, &bytes, file) || bytes != length)
+		return false; // Something went wrong while trying to read the data
+
+	return text_file_parse_f64(data, value, length, NULL);
+}
+// Read 'bool' data from a text file at 'position'
+bool text_file_read_bool_at(bool* data, file_size position, text_file file)
+{
+	c8 value = '\0';
+	i64 bytes;
+	if (!text_file_pread(&value, 1, position, &bytes, file) || bytes != 1)
+		return false; // Something went wrong while trying to read the data
+
+	if (value == '0')
+	{
+		*data = false;
+		return true; // Success
+	}
+	else if (value == '1')
+	{
+		*data = true;
+		return true; // Success
+	}
+
+	return false; // Something went wrong while trying to read the data
+}
+// Read 'byte' data from a text file at 'position'
+bool text_file_read_byte_at(byte* data, i64 length, file_size position, text_file file)
+{
+	i64 bytes;
+	if (!text_file_pread(data, length, position, &bytes, file) || bytes != length)
+		return false; // Something went wrong while trying to read the data
+
+	return true; // Success
+}
+// Read 'str' data from a text file at 'position'. Like text_file_read_str(..) it stops early at the end of the file.
+bool text_file_read_str_at(str text, i64 length, file_size position, text_file file)
+{
+	i64 bytes;
+	if (!text_file_pread(text, length, position, &bytes, file))
+		return false; // Error reading file
+
+	text[bytes] = '\0';
+
+	return true; // Success
+}
+
+//
+// Implementations: Memory mapped text file
+//
+
+// Open a text file for reading as a read-only memory mapping. The file content can be parsed in place
+// through 'mapped->data' and 'mapped->length' without copying it into a heap buffer first.
+// Returns false if the file does not exist or could not be mapped.
+bool text_file_openfor_read_mapped(text_file_mapped* mapped, str filename)
+{
+	memset(mapped, 0, sizeof(text_file_mapped));
+
+	// Binary mode so that positions are byte offsets into the mapping
+	mapped->file = fopen((const char*)filename, "rb");
+	if (mapped->file == NULL)
+		return false; // The file does not exist
+
+#if defined(_WIN32)
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(mapped->file));
+	LARGE_INTEGER size;
+	if (handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &size))
+	{
+		text_file_close(mapped->file);
+		return false; // Failed to get the file size
+	}
+	mapped->length = size.QuadPart;
+	if (mapped->length == 0)
+		return true; // Success. An empty file can not be mapped, but there is nothing to read either.
+
+	mapped->mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapped->mapping == NULL)
+	{
+		text_file_close(mapped->file);
+		return false; // Failed to create the mapping
+	}
+	mapped->data = (byte*)MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+	if (mapped->data == NULL)
+	{
+		CloseHandle(mapped->mapping);
+		text_file_close(mapped->file);
+		return false; // Failed to map the file
+	}
+#else
+	struct stat info;
+	if (fstat(fileno(mapped->file), &info) != 0)
+	{
+		text_file_close(mapped->file);
+		return false; // Failed to get the file size
+	}
+	mapped->length = (file_size)info.st_size;
+	if (mapped->length == 0)
+		return true; // Success. An empty file can not be mapped, but there is nothing to read either.
+
+	void* data = mmap(NULL, (size_t)mapped->length, PROT_READ, MAP_PRIVATE, fileno(mapped->file), 0);
+	if (data == MAP_FAILED)
+	{
+		text_file_close(mapped->file);
+		return false; // Failed to map the file
+	}
+	mapped->data = (byte*)data;
+
+	// Hint the kernel that the mapping is read front to back and will be needed soon
+	posix_madvise(data, (size_t)mapped->length, POSIX_MADV_SEQUENTIAL);
+	posix_madvise(data, (size_t)mapped->length, POSIX_MADV_WILLNEED);
+#endif
+
+	return true; // Success
+}
+// Get a pointer to the current position in a memory mapped text file. Returns NULL at the end of the file.
+byte* text_file_mapped_at_position(text_file_mapped* mapped)
+{
+	file_size position = text_file_get_position(mapped->file);
+	if (position < 0 || position >= mapped->length)
+		return NULL; // Nothing left to read
+
+	return mapped->data + position;
+}
+// Read 'length' bytes from a memory mapped text file without copying. 'data' is set to point into the mapping
+// and the position is moved forward by 'length'. Returns false if there are less than 'length' bytes left.
+bool text_file_read_mapped(byte** data, i64 length, text_file_mapped* mapped)
+{
+	file_size position = text_file_get_position(mapped->file);
+	if (position < 0 || length < 0 || length > mapped->length - position)
+		return false; // Something went wrong while trying to read the data
+
+	if (!text_file_set_position(position + length, mapped->file))
+		return false; // Something went wrong while trying to read the data
+
+	*data = mapped->data + position;
+
+	return true; // Success
+}
+// Close a memory mapped text file
+void text_file_close_mapped(text_file_mapped* mapped)
+{
+#if defined(_WIN32)
+	if (mapped->data != NULL)
+		UnmapViewOfFile(mapped->data);
+	if (mapped->mapping != NULL)
+		CloseHandle(mapped->mapping);
+#else
+	if (mapped->data != NULL)
+		munmap(mapped->data, (size_t)mapped->length);
+#endif
+	if (mapped->file != NULL)
+		text_file_close(mapped->file);
+
+	memset(mapped, 0, sizeof(text_file_mapped));
+}
+
+//
+// Implementations: Allocators
+//
+
+// Allocate with malloc(..). The allocator used when none was set.
+void* text_file_heap_allocate(void* context, size_t size)
+{
+	(void)context;
+	return malloc(size);
+}
+// Release a block from text_file_heap_allocate(..)
+void text_file_heap_release(void* context, void* data, size_t size)
+{
+	(void)context;
+	(void)size;
+	free(data);
+}
+
+// Allocator used when NULL is passed as the allocator. Set it once at startup, it is not locked.
+static text_file_allocator text_file_global_allocator = { text_file_heap_allocate, text_file_heap_release, NULL };
+
+// Set the allocator used when NULL is passed as the allocator. NULL sets it back to malloc(..) and free(..).
+void text_file_set_allocator(const text_file_allocator* allocator)
+{
+	if (allocator == NULL)
+	{
+		text_file_global_allocator.allocate = text_file_heap_allocate;
+		text_file_global_allocator.release = text_file_heap_release;
+		text_file_global_allocator.context = NULL;
+	}
+	else
+		text_file_global_allocator = *allocator;
+}
+// Get the allocator used when NULL is passed as the allocator
+text_file_allocator text_file_get_allocator(void)
+{
+	return text_file_global_allocator;
+}
+// Allocate 'size' bytes from 'allocator', or from the global allocator if it is NULL. Returns NULL on failure.
+void* text_file_allocate(size_t size, const text_file_allocator* allocator)
+{
+	if (allocator == NULL)
+		allocator = &text_file_global_allocator;
+
+	return allocator->allocate(allocator->context, size);
+}
+// Release a block of 'size' bytes to the allocator it came from
+void text_file_release(void* data, size_t size, const text_file_allocator* allocator)
+{
+	if (data == NULL)
+		return; // Nothing to release
+
+	if (allocator == NULL)
+		allocator = &text_file_global_allocator;
+
+	allocator->release(allocator->context, data, size);
+}
+
+// Initialize an arena. With a 'buffer' all allocations come from it and fail when it is full, so a buffer on the stack
+// gives allocations without malloc(..). Without one (NULL) the arena takes blocks of at least 'size' bytes from malloc(..).
+void text_file_arena_init(text_file_arena* arena, void* buffer, size_t size)
+{
+	memset(arena, 0, sizeof(text_file_arena));
+
+	if (buffer != NULL)
+	{
+		// Start at the first aligned byte of the buffer
+		size_t skip = (TEXT_FILE_ALLOCATOR_ALIGN - ((size_t)buffer & (TEXT_FILE_ALLOCATOR_ALIGN - 1))) & (TEXT_FILE_ALLOCATOR_ALIGN - 1);
+		arena->buffer = (byte*)buffer + skip;
+		arena->capacity = (size > skip) ? size - skip : 0;
+	}
+	else
+		arena->block_size = (size > 0) ? size : TEXT_FILE_POOL_SLAB;
+}
+// Allocate 'size' bytes from an arena. Returns NULL if the arena is full. A size of 0 still takes
+// TEXT_FILE_ALLOCATOR_ALIGN bytes, so that every allocation is a distinct pointer that is not NULL.
+void* text_file_arena_allocate(text_file_arena* arena, size_t size)
+{
+	if (size == 0)
+		size = TEXT_FILE_ALLOCATOR_ALIGN;
+	if (size > SIZE_MAX - (TEXT_FILE_ALLOCATOR_ALIGN - 1))
+		return NULL; // Too large, rounding it up would wrap around
+	size = (size + TEXT_FILE_ALLOCATOR_ALIGN - 1) & ~(size_t)(TEXT_FILE_ALLOCATOR_ALIGN - 1);
+
+	if (size > arena->capacity - arena->used)
+	{
+		if (arena->block_size == 0)
+			return NULL; // The buffer is full
+
+		// Take a new block. A block that is larger than the block size is only used for this allocation.
+		size_t capacity = (size > arena->block_size) ? size : arena->block_size;
+		if (capacity > SIZE_MAX - TEXT_FILE_ARENA_HEADER)
+			return NULL; // Too large for a block with its header
+		text_file_arena_block* block = (text_file_arena_block*)malloc(TEXT_FILE_ARENA_HEADER + capacity);
+		if (block == NULL)
+			return NULL; // Out of memory
+
+		block->capacity = capacity;
+		block->next = arena->blocks;
+		arena->blocks = block;
+		arena->buffer = (byte*)block + TEXT_FILE_ARENA_HEADER;
+		arena->capacity = capacity;
+		arena->used = 0;
+	}
+
+	void* data = arena->buffer + arena->used;
+	arena->used += size;
+
+	return data;
+}
+// Free every allocation of an arena at once. The current block is kept for the next allocations.
+void text_file_arena_reset(text_file_arena* arena)
+{
+	if (arena->blocks != NULL)
+	{
+		text_file_arena_block* block = arena->blocks->next;
+		while (block != NULL)
+		{
+			text_file_arena_block* next = block->next;
+			free(block);
+			block = next;
+		}
+		arena->blocks->next = NULL;
+	}
+
+	arena->used = 0;
+}
+// Free an arena and the blocks it took from malloc(..)
+void text_file_arena_free(text_file_arena* arena)
+{
+	text_file_arena_block* block = arena->blocks;
+	while (block != NULL)
+	{
+		text_file_arena_block* next = block->next;
+		free(block);
+		block = next;
+	}
+
+	memset(arena, 0, sizeof(text_file_arena));
+}
+// Allocator callbacks of an arena
+void* text_file_arena_allocator_allocate(void* context, size_t size)
+{
+	return text_file_arena_allocate((text_file_arena*)context, size);
+}
+void text_file_arena_allocator_release(void* context, void* data, size_t size)
+{
+	// Arena memory is freed with text_file_arena_reset(..)
+	(void)context;
+	(void)data;
+	(void)size;
+}
+// Get an allocator that allocates from an arena
+text_file_allocator text_file_arena_allocator(text_file_arena* arena)
+{
+	text_file_allocator allocator;
+	allocator.allocate = text_file_arena_allocator_allocate;
+	allocator.release = text_file_arena_allocator_release;
+	allocator.context = arena;
+
+	return allocator;
+}
+
+// Initialize a size class pool
+void text_file_pool_init(text_file_pool* pool)
+{
+	memset(pool, 0, sizeof(text_file_pool));
+}
+// Get the size class of 'size' bytes, or -1 if it is larger than the largest class
+i32 text_file_pool_class(size_t size)
+{
+	i32 index = 0;
+	size_t class_size = TEXT_FILE_ALLOCATOR_ALIGN;
+	while (class_size < size)
+	{
+		class_size <<= 1;
+		index++;
+	}
+
+	return (index < TEXT_FILE_POOL_CLASSES) ? index : -1;
+}
+// Allocate 'size' bytes from a pool. Returns NULL if out of memory.
+void* text_file_pool_allocate(text_file_pool* pool, size_t size)
+{
+	i32 index = text_file_pool_class(size);
+	if (index < 0)
+		return malloc(size); // Larger than the largest class
+
+	if (pool->free_blocks[index] == NULL)
+	{
+		// Carve a new slab into blocks of this class. The first block holds the link to the next slab.
+		size_t class_size = (size_t)TEXT_FILE_ALLOCATOR_ALIGN << index;
+		size_t slab_size = (class_size * 4 > TEXT_FILE_POOL_SLAB) ? class_size * 4 : TEXT_FILE_POOL_SLAB;
+		byte* slab = (byte*)malloc(TEXT_FILE_ALLOCATOR_ALIGN + slab_size);
+		if (slab == NULL)
+			return NULL; // Out of memory
+
+		*(void**)slab = pool->slabs;
+		pool->slabs = slab;
+
+		byte* block = slab + TEXT_FILE_ALLOCATOR_ALIGN;
+		for (size_t i = 0; i < slab_size / class_size; i++, block += class_size)
+		{
+			*(void**)block = pool->free_blocks[index];
+			pool->free_blocks[index] = block;
+		}
+	}
+
+	void* data = pool->free_blocks[index];
+	pool->free_blocks[index] = *(void**)data;
+
+	return data;
+}
+// Release a block of 'size' bytes to its pool
+void text_file_pool_release(text_file_pool* pool, void* data, size_t size)
+{
+	if (data == NULL)
+		return; // Nothing to release
+
+	i32 index = text_file_pool_class(size);
+	if (index < 0)
+	{
+		free(data); // Larger than the largest class
+		return;
+	}
+
+	*(void**)data = pool->free_blocks[index];
+	pool->free_blocks[index] = data;
+}
+// Free a pool. Blocks larger than the largest class are not owned by the pool and must be released before.
+void text_file_pool_free(text_file_pool* pool)
+{
+	void* slab = pool->slabs;
+	while (slab != NULL)
+	{
+		void* next = *(void**)slab;
+		free(slab);
+		slab = next;
+	}
+
+	memset(pool, 0, sizeof(text_file_pool));
+}
+// Allocator callbacks of a pool
+void* text_file_pool_allocator_allocate(void* context, size_t size)
+{
+	return text_file_pool_allocate((text_file_pool*)context, size);
+}
+void text_file_pool_allocator_release(void* context, void* data, size_t size)
+{
+	text_file_pool_release((text_file_pool*)context, data, size);
+}
+// Get an allocator that allocates from a pool
+text_file_allocator text_file_pool_allocator(text_file_pool* pool)
+{
+	text_file_allocator allocator;
+	allocator.allocate = text_file_pool_allocator_allocate;
+	allocator.release = text_file_pool_allocator_release;
+	allocator.context = pool;
+
+	return allocator;
+}
+
+// Read a whole file into memory from 'allocator' (NULL for the global allocator) with one size lookup and one read.
+// 'text' gets 'length' bytes as they are in the file (\r\n is kept) and a null terminator after them.
+// Release it with text_file_release(text, length + 1, allocator).
+bool text_file_slurp(c8** text, i64* length, str filename, const text_file_allocator* allocator)
+{
+	*text = NULL;
+	*length = 0;
+
+	// Binary mode so that the length from the file system is the number of bytes read
+	text_file file = fopen((const char*)filename, "rb");
+	if (file == NULL)
+		return false; // The file does not exist
+
+	// The length is only trusted for regular files. Pipes and files like the ones in /proc are read until the end.
+	file_size size = 0;
+#if defined(_WIN32)
+	HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
+	LARGE_INTEGER information;
+	if (handle != INVALID_HANDLE_VALUE && GetFileType(handle) == FILE_TYPE_DISK && GetFileSizeEx(handle, &information))
+		size = information.QuadPart;
+#else
+	struct stat information;
+	if (fstat(fileno(file), &information) == 0 && S_ISREG(information.st_mode))
+		size = (file_size)information.st_size;
+#endif
+
+	size_t capacity = (size > 0) ? (size_t)size + 1 : TEXT_FILE_SLURP_CHUNK;
+	c8* data = (c8*)text_file_allocate(capacity, allocator);
+	if (data == NULL)
+	{
+		text_file_close(file);
+		return false; // Out of memory
+	}
+
+	size_t used = text_file_io_read(data, 1, capacity - 1, file);
+	while (size == 0 && used == capacity - 1)
+	{
+		// The length is unknown, so grow until the end of the file
+		c8* larger = (c8*)text_file_allocate(capacity * 2, allocator);
+		if (larger == NULL)
+		{
+			text_file_release(data, capacity, allocator);
+			text_file_close(file);
+			return false; // Out of memory
+		}
+		memcpy(larger, data, used);
+		text_file_release(data, capacity, allocator);
+		data = larger;
+		capacity *= 2;
+		used += text_file_io_read(data + used, 1, capacity - 1 - used, file);
+	}
+
+	bool failed = ferror(file) != 0;
+	text_file_close(file);
+	if (failed)
+	{
+		text_file_release(data, capacity, allocator);
+		return false; // Something went wrong while trying to read the data
+	}
+
+	if (capacity != used + 1)
+	{
+		// The length was unknown or the file got shorter. Move the text to a block of the size it is released with.
+		c8* exact = (c8*)text_file_allocate(used + 1, allocator);
+		if (exact == NULL)
+		{
+			text_file_release(data, capacity, allocator);
+			return false; // Out of memory
+		}
+		memcpy(exact, data, used);
+		text_file_release(data, capacity, allocator);
+		data = exact;
+	}
+
+	data[used] = '\0';
+	*text = data;
+	*length = (i64)used;
+
+	return true; // Success
+}
+
+//
+// Implementations: Number parsing
+//
+
+// SWAR (SIMD within a register) digit parsing needs the digits in memory order in the low bytes
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define TEXT_FILE_SWAR_DIGITS 0
+#else
+#define TEXT_FILE_SWAR_DIGITS 1
+#endif
+
+// Check if the eight chars packed into 'chunk' are all decimal digits
+bool text_file_is_eight_digits(u64 chunk)
+{
+	return (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+// Convert the eight decimal digits packed into 'chunk' to their value with three multiplications instead of eight
+u64 text_file_parse_eight_digits(u64 chunk)
+{
+	chunk -= 0x3030303030303030ULL;
+	chunk = (chunk * 10) + (chunk >> 8); // Pairs of digits
+	chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+		(((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+	return chunk;
+}
+// Parse a run of decimal digits. Returns the number of digits parsed, 0 if there are none, or -1 if the value is larger than 'max'.
+i64 text_file_parse_digits(u64* value, u64 max, const c8* text, i64 length)
+{
+	u64 result = 0;
+	i64 i = 0;
+
+#if TEXT_FILE_SWAR_DIGITS
+	// Eight digits at a time. At most 16 digits are taken here, so the result can not overflow a u64.
+	while (length - i >= 8 && i <= 8)
+	{
+		u64 chunk;
+		memcpy(&chunk, text + i, sizeof(chunk));
+		if (!text_file_is_eight_digits(chunk))
+			break;
+		result = (result * 100000000) + text_file_parse_eight_digits(chunk);
+		i += 8;
+	}
+	if (result > max)
+		return -1; // Overflow
+#endif
+
+	// The remaining digits one at a time with overflow checking
+	for (; i < length; i++)
+	{
+		u64 digit = (u64)(text[i] - '0');
+		if (digit > 9)
+			break;
+		if (result > (max - digit) / 10)
+			return -1; // Overflow
+		result = (result * 10) + digit;
+	}
+
+	*value = result;
+
+	return i;
+}
+// Check if a char is white space the same way as isspace(..) in the "C" locale
+bool text_file_is_space(c8 c)
+{
+	return (c == ' ' || (c >= '\t' && c <= '\r'));
+}
+// Parse an unsigned decimal number in the range 0 to 'max'. Leading white space and a '+' sign are skipped and parsing
+// stops at the first non-digit, like sscanf(..) does. 'consumed' (optional) is set to the number of chars used.
+bool text_file_parse_unsigned(u64* value, u64 max, const c8* text, i64 length, i64* consumed)
+{
+	i64 i = 0;
+	while (i < length && text_file_is_space(text[i]))
+		i++;
+	if (i < length && text[i] == '+')
+		i++;
+
+	u64 result = 0;
+	i64 digits = text_file_parse_digits(&result, max, text + i, length - i);
+	if (digits <= 0)
+		return false; // No digits or the number is too large
+
+	*value = result;
+	if (consumed != NULL)
+		*consumed = i + digits;
+
+	return true; // Success
+}
+// Parse a signed decimal number in the range 'min' to 'max'. Leading white space is skipped and parsing
+// stops at the first non-digit, like sscanf(..) does. 'consumed' (optional) is set to the number of chars used.
+bool text_file_parse_signed(i64* value, i64 min, i64 max, const c8* text, i64 length, i64* consumed)
+{
+	i64 i = 0;
+	while (i < length && text_file_is_space(text[i]))
+		i++;
+
+	bool negative = false;
+	if (i < length && (text[i] == '-' || text[i] == '+'))
+	{
+		negative = (text[i] == '-');
+		i++;
+	}
+
+	// The magnitude of 'min' is one larger than 'max' in two's complement, so it is computed without negating 'min'
+	u64 limit = negative ? ((u64)(-(min + 1)) + 1) : (u64)max;
+	u64 magnitude = 0;
+	i64 digits = text_file_parse_digits(&magnitude, limit, text + i, length - i);
+	if (digits <= 0)
+		return false; // No digits or the number is out of range
+
+	*value = negative ? (i64)(0 - magnitude) : (i64)magnitude;
+	if (consumed != NULL)
+		*consumed = i + digits;
+
+	return true; // Success
+}
+// Read up to 'length' chars (clamped to 'max_length') from a text file and parse them as an unsigned decimal number
+bool text_file_read_unsigned(u64* data, u64 max, u8 length, u8 max_length, text_file file)
+{
+	if (length > max_length) // Clamp it to 'length' so that it doesn't go out of bounds
+		length = max_length;
+
+	c8 value[32]; // Large enough for any integer type. No heap allocation needed.
+	if (length > sizeof(value))
+		length = sizeof(value);
+
+	if (text_file_io_read(value, sizeof(char), length, file) != length)
+		return false; // Something went wrong while trying to read the data
+
+	TEXT_FILE_STATS_CONVERT(bool ok = text_file_parse_unsigned(data, max, value, length, NULL), file);
+	return ok;
+}
+// Read up to 'length' chars (clamped to 'max_length') from a text file and parse them as a signed decimal number
+bool text_file_read_signed(i64* data, i64 min, i64 max, u8 length, u8 max_length, text_file file)
+{
+	if (length > max_length) // Clamp it to 'length' so that it doesn't go out of bounds
+		length = max_length;
+
+	c8 value[32]; // Large enough for any integer type. No heap allocation needed.
+	if (length > sizeof(value))
+		length = sizeof(value);
+
+	if (text_file_io_read(value, sizeof(char), length, file) != length)
+		return false; // Something went wrong while trying to read the data
+
+	TEXT_FILE_STATS_CONVERT(bool ok = text_file_parse_signed(data, min, max, value, length, NULL), file);
+	return ok;
+}
+
+//
+// Implementations: Number formatting
+//
+
+// Get the number of bits needed to represent a value. 0 needs 0 bits.
+u8 text_file_bit_length(u64 value)
+{
+	if (value == 0)
+		return 0;
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (u8)(index + 1);
+#elif defined(__GNUC__) || defined(__clang__)
+	return (u8)(64 - __builtin_clzll(value));
+#else
+	u8 bits = 0;
+	while (value != 0)
+	{
+		value >>= 1;
+		bits++;
+	}
+	return bits;
+#endif
+}
+// Get the number of decimal digits of a value without a division loop.
+// log10 is estimated from the bit length (1233 / 4096 ~ log10(2)) and corrected with one table lookup.
+u8 text_file_count_digits(u64 value)
+{
+	static const u64 powers_of_10[20] =
+	{
+		0ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+		10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+		1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+		10000000000000000000ULL
+	};
+	u8 estimate = (u8)((text_file_bit_length(value | 1) * 1233) >> 12);
+
+	return estimate + 1 - (value < powers_of_10[estimate]);
+}
+// Format an unsigned value as decimal text into 'buffer' (at least 20 chars). No null terminator is written.
+// Returns the number of chars written. The digits are written backwards two at a time from a lookup table.
+u8 text_file_format_unsigned(u64 value, c8* buffer)
+{
+	static const char digit_pairs[201] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	u8 length = text_file_count_digits(value);
+	c8* position = buffer + length;
+	while (value >= 100)
+	{
+		u64 pair = (value % 100) * 2;
+		value /= 100;
+		position -= 2;
+		memcpy(position, digit_pairs + pair, 2);
+	}
+	if (value >= 10)
+	{
+		position -= 2;
+		memcpy(position, digit_pairs + (value * 2), 2);
+	}
+	else
+	{
+		position[-1] = (c8)('0' + value);
+	}
+
+	return length;
+}
+// Format a signed value as decimal text into 'buffer' (at least 20 chars). No null terminator is written.
+// Returns the number of chars written.
+u8 text_file_format_signed(i64 value, c8* buffer)
+{
+	if (value >= 0)
+		return text_file_format_unsigned((u64)value, buffer);
+
+	buffer[0] = '-';
+
+	return 1 + text_file_format_unsigned(0 - (u64)value, buffer + 1); // Unsigned negation also handles the smallest value
+}
+
+//
+// Implementations: Shortest float formatting
+//
+// This is the Grisu2 algorithm by Florian Loitsch ("Printing Floating-Point Numbers Quickly and Accurately with Integers").
+// It produces the shortest (or in rare cases one digit longer) decimal text that reads back as exactly the same value,
+// using only 64-bit integer arithmetic. No heap allocation and no printf.
+//
+
+// A floating point number 'f * 2^e' with a 64-bit significand
+typedef struct text_file_diyfp
+{
+	u64 f;
+	i32 e;
+} text_file_diyfp;
+
+// A normalized power of ten 'f * 2^e' ~ 10^k
+typedef struct text_file_cached_power
+{
+	u64 f;
+	i32 e;
+	i32 k;
+} text_file_cached_power;
+
+// Make a diyfp
+text_file_diyfp text_file_diyfp_make(u64 f, i32 e)
+{
+	text_file_diyfp result = { f, e };
+	return result;
+}
+// Multiply two diyfp's and round the 128-bit product to its upper 64 bits
+text_file_diyfp text_file_diyfp_mul(text_file_diyfp x, text_file_diyfp y)
+{
+	u64 u_lo = x.f & 0xFFFFFFFFULL;
+	u64 u_hi = x.f >> 32;
+	u64 v_lo = y.f & 0xFFFFFFFFULL;
+	u64 v_hi = y.f >> 32;
+
+	u64 p0 = u_lo * v_lo;
+	u64 p1 = u_lo * v_hi;
+	u64 p2 = u_hi * v_lo;
+	u64 p3 = u_hi * v_hi;
+
+	u64 q = (p0 >> 32) + (p1 & 0xFFFFFFFFULL) + (p2 & 0xFFFFFFFFULL);
+	q += 1ULL << 31; // Round
+
+	return text_file_diyfp_make(p3 + (p2 >> 32) + (p1 >> 32) + (q >> 32), x.e + y.e + 64);
+}
+// Shift a diyfp left until its highest bit is set
+text_file_diyfp text_file_diyfp_normalize(text_file_diyfp x)
+{
+	while ((x.f >> 63) == 0)
+	{
+		x.f <<= 1;
+		x.e--;
+	}
+	return x;
+}
+// Get a normalized power of ten c = 10^k such that the binary exponent of w * c is in the range [-60, -32]
+text_file_cached_power text_file_cached_power_for_exponent(i32 e)
+{
+	static const text_file_cached_power cached_powers[79] =
+	{
+		{ 0xAB70FE17C79AC6CAULL, -1060, -300 },
+		{ 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+		{ 0xBE5691EF416BD60CULL, -1007, -284 },
+		{ 0x8DD01FAD907FFC3CULL,  -980, -276 },
+		{ 0xD3515C2831559A83ULL,  -954, -268 },
+		{ 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+		{ 0xEA9C227723EE8BCBULL,  -901, -252 },
+		{ 0xAECC49914078536DULL,  -874, -244 },
+		{ 0x823C12795DB6CE57ULL,  -847, -236 },
+		{ 0xC21094364DFB5637ULL,  -821, -228 },
+		{ 0x9096EA6F3848984FULL,  -794, -220 },
+		{ 0xD77485CB25823AC7ULL,  -768, -212 },
+		{ 0xA086CFCD97BF97F4ULL,  -741, -204 },
+		{ 0xEF340A98172AACE5ULL,  -715, -196 },
+		{ 0xB23867FB2A35B28EULL,  -688, -188 },
+		{ 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+		{ 0xC5DD44271AD3CDBAULL,  -635, -172 },
+		{ 0x936B9FCEBB25C996ULL,  -608, -164 },
+		{ 0xDBAC6C247D62A584ULL,  -582, -156 },
+		{ 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+		{ 0xF3E2F893DEC3F126ULL,  -529, -140 },
+		{ 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+		{ 0x87625F056C7C4A8BULL,  -475, -124 },
+		{ 0xC9BCFF6034C13053ULL,  -449, -116 },
+		{ 0x964E858C91BA2655ULL,  -422, -108 },
+		{ 0xDFF9772470297EBDULL,  -396, -100 },
+		{ 0xA6DFBD9FB8E5B88FULL,  -369,  -92 },
+		{ 0xF8A95FCF88747D94ULL,  -343,  -84 },
+		{ 0xB94470938FA89BCFULL,  -316,  -76 },
+		{ 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+		{ 0xCDB02555653131B6ULL,  -263,  -60 },
+		{ 0x993FE2C6D07B7FACULL,  -236,  -52 },
+		{ 0xE45C10C42A2B3B06ULL,  -210,  -44 },
+		{ 0xAA242499697392D3ULL,  -183,  -36 },
+		{ 0xFD87B5F28300CA0EULL,  -157,  -28 },
+		{ 0xBCE5086492111AEBULL,  -130,  -20 },
+		{ 0x8CBCCC096F5088CCULL,  -103,  -12 },
+		{ 0xD1B71758E219652CULL,   -77,   -4 },
+		{ 0x9C40000000000000ULL,   -50,    4 },
+		{ 0xE8D4A51000000000ULL,   -24,   12 },
+		{ 0xAD78EBC5AC620000ULL,     3,   20 },
+		{ 0x813F3978F8940984ULL,    30,   28 },
+		{ 0xC097CE7BC90715B3ULL,    56,   36 },
+		{ 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+		{ 0xD5D238A4ABE98068ULL,   109,   52 },
+		{ 0x9F4F2726179A2245ULL,   136,   60 },
+		{ 0xED63A231D4C4FB27ULL,   162,   68 },
+		{ 0xB0DE65388CC8ADA8ULL,   189,   76 },
+		{ 0x83C7088E1AAB65DBULL,   216,   84 },
+		{ 0xC45D1DF942711D9AULL,   242,   92 },
+		{ 0x924D692CA61BE758ULL,   269,  100 },
+		{ 0xDA01EE641A708DEAULL,   295,  108 },
+		{ 0xA26DA3999AEF774AULL,   322,  116 },
+		{ 0xF209787BB47D6B85ULL,   348,  124 },
+		{ 0xB454E4A179DD1877ULL,   375,  132 },
+		{ 0x865B86925B9BC5C2ULL,   402,  140 },
+		{ 0xC83553C5C8965D3DULL,   428,  148 },
+		{ 0x952AB45CFA97A0B3ULL,   455,  156 },
+		{ 0xDE469FBD99A05FE3ULL,   481,  164 },
+		{ 0xA59BC234DB398C25ULL,   508,  172 },
+		{ 0xF6C69A72A3989F5CULL,   534,  180 },
+		{ 0xB7DCBF5354E9BECEULL,   561,  188 },
+		{ 0x88FCF317F22241E2ULL,   588,  196 },
+		{ 0xCC20CE9BD35C78A5ULL,   614,  204 },
+		{ 0x98165AF37B2153DFULL,   641,  212 },
+		{ 0xE2A0B5DC971F303AULL,   667,  220 },
+		{ 0xA8D9D1535CE3B396ULL,   694,  228 },
+		{ 0xFB9B7CD9A4A7443CULL,   720,  236 },
+		{ 0xBB764C4CA7A44410ULL,   747,  244 },
+		{ 0x8BAB8EEFB6409C1AULL,   774,  252 },
+		{ 0xD01FEF10A657842CULL,   800,  260 },
+		{ 0x9B10A4E5E9913129ULL,   827,  268 },
+		{ 0xE7109BFBA19C0C9DULL,   853,  276 },
+		{ 0xAC2820D9623BF429ULL,   880,  284 },
+		{ 0x80444B5E7AA7CF85ULL,   907,  292 },
+		{ 0xBF21E44003ACDD2DULL,   933,  300 },
+		{ 0x8E679C2F5E44FF8FULL,   960,  308 },
+		{ 0xD433179D9C8CB841ULL,   986,  316 },
+		{ 0x9E19DB92B4E31BA9ULL,  1013,  324 },
+	};
+
+	// k = ceil((-61 - e) * log10(2)), rounded up to the next entry of the table which has a step of 8
+	i32 f = -61 - e;
+	i32 k = (f * 78913) / (1 << 18) + (f > 0);
+	i32 index = (300 + k + 7) / 8;
+
+	return cached_powers[index];
+}
+// Compute the boundaries m- and m+ of the rounding interval of 'w = f * 2^e' whose significand has 'precision' bits
+void text_file_float_boundaries(u64 bits, i32 precision, i32 bias, text_file_diyfp* w, text_file_diyfp* m_minus, text_file_diyfp* m_plus)
+{
+	u64 hidden_bit = 1ULL << (precision - 1);
+	u64 f = bits & (hidden_bit - 1);
+	i32 e = (i32)(bits >> (precision - 1));
+
+	text_file_diyfp v = (e == 0) ? text_file_diyfp_make(f, 1 - bias) : text_file_diyfp_make(f + hidden_bit, e - bias);
+
+	// The lower boundary is closer if v is a power of two (except for the smallest normal number)
+	bool lower_boundary_is_closer = (f == 0 && e > 1);
+	text_file_diyfp plus = text_file_diyfp_make((2 * v.f) + 1, v.e - 1);
+	text_file_diyfp minus = lower_boundary_is_closer ? text_file_diyfp_make((4 * v.f) - 1, v.e - 2) : text_file_diyfp_make((2 * v.f) - 1, v.e - 1);
+
+	*m_plus = text_file_diyfp_normalize(plus);
+	*m_minus = text_file_diyfp_make(minus.f << (minus.e - m_plus->e), m_plus->e);
+	*w = text_file_diyfp_normalize(v);
+}
+// Move the last digit of the generated digits closer to w while staying inside the rounding interval
+void text_file_grisu2_round(c8* buffer, i32 length, u64 distance, u64 delta, u64 rest, u64 ten_k)
+{
+	while (rest < distance && delta - rest >= ten_k && (rest + ten_k < distance || distance - rest > rest + ten_k - distance))
+	{
+		buffer[length - 1]--;
+		rest += ten_k;
+	}
+}
+// Generate the shortest digits of w inside the interval [m_minus, m_plus]. The result is 'buffer * 10^decimal_exponent'.
+i32 text_file_grisu2_digits(c8* buffer, i32* decimal_exponent, text_file_diyfp m_minus, text_file_diyfp w, text_file_diyfp m_plus)
+{
+	u64 delta = m_plus.f - m_minus.f;
+	u64 distance = m_plus.f - w.f;
+
+	// Split m_plus into an integral part p1 and a fractional part p2 at the binary point 2^-e
+	i32 shift = -m_plus.e;
+	u64 one = 1ULL << shift;
+	u32 p1 = (u32)(m_plus.f >> shift);
+	u64 p2 = m_plus.f & (one - 1);
+
+	i32 length = 0;
+	i32 n = text_file_count_digits(p1);
+	u32 pow10 = 1;
+	for (i32 i = 1; i < n; i++)
+		pow10 *= 10;
+
+	// Integral digits
+	while (n > 0)
+	{
+		buffer[length++] = (c8)('0' + (p1 / pow10));
+		p1 %= pow10;
+		n--;
+
+		u64 rest = ((u64)p1 << shift) + p2;
+		if (rest <= delta)
+		{
+			*decimal_exponent += n;
+			text_file_grisu2_round(buffer, length, distance, delta, rest, (u64)pow10 << shift);
+			return length;
+		}
+		pow10 /= 10;
+	}
+
+	// Fractional digits
+	i32 m = 0;
+	for (;;)
+	{
+		p2 *= 10;
+		buffer[length++] = (c8)('0' + (p2 >> shift));
+		p2 &= one - 1;
+		m++;
+
+		delta *= 10;
+		distance *= 10;
+		if (p2 <= delta)
+			break;
+	}
+	*decimal_exponent -= m;
+	text_file_grisu2_round(buffer, length, distance, delta, p2, one);
+
+	return length;
+}
+// Write the exponent of the scientific notation, like "e+05" or "e-300"
+i32 text_file_format_exponent(i32 exponent, c8* buffer)
+{
+	i32 length = 0;
+	buffer[length++] = 'e';
+	buffer[length++] = (exponent < 0) ? '-' : '+';
+	if (exponent < 0)
+		exponent = -exponent;
+	if (exponent < 10)
+		buffer[length++] = '0'; // At least two digits, like printf
+
+	return length + text_file_format_unsigned((u64)exponent, buffer + length);
+}
+// Lay out the digits 'digits * 10^decimal_exponent' as fixed notation when the value is in the range [1e-4, 1e15),
+// otherwise as scientific notation. A fixed notation integer keeps a ".0" so that it still reads as a float.
+i32 text_file_format_float_digits(c8* buffer, i32 length, i32 decimal_exponent)
+{
+	i32 point = length + decimal_exponent; // Position of the decimal point relative to the first digit
+
+	if (length <= point && point <= 15)
+	{
+		// digits000.0
+		memset(buffer + length, '0', point - length);
+		buffer[point] = '.';
+		buffer[point + 1] = '0';
+		return point + 2;
+	}
+	if (0 < point && point <= 15)
+	{
+		// dig.its
+		memmove(buffer + point + 1, buffer + point, length - point);
+		buffer[point] = '.';
+		return length + 1;
+	}
+	if (-4 < point && point <= 0)
+	{
+		// 0.000digits
+		memmove(buffer + 2 - point, buffer, length);
+		buffer[0] = '0';
+		buffer[1] = '.';
+		memset(buffer + 2, '0', -point);
+		return 2 - point + length;
+	}
+
+	// d.igitse+XX
+	if (length == 1)
+		return 1 + text_file_format_exponent(point - 1, buffer + 1);
+
+	memmove(buffer + 2, buffer + 1, length - 1);
+	buffer[1] = '.';
+	return length + 1 + text_file_format_exponent(point - 1, buffer + length + 1);
+}
+// Format special values and the sign. Returns the number of chars written and sets 'done' if nothing more is needed.
+i32 text_file_format_float_prefix(bool negative, bool is_nan, bool is_inf, bool is_zero, c8* buffer, bool* done)
+{
+	i32 length = 0;
+	*done = true;
+	if (is_nan)
+	{
+		memcpy(buffer, "nan", 3);
+		return 3;
+	}
+	if (negative)
+		buffer[length++] = '-';
+	if (is_inf)
+	{
+		memcpy(buffer + length, "inf", 3);
+		return length + 3;
+	}
+	if (is_zero)
+	{
+		memcpy(buffer + length, "0.0", 3);
+		return length + 3;
+	}
+	*done = false;
+
+	return length;
+}
+// Format an 'f64' as the shortest decimal text that reads back as the same value. 'buffer' must hold
+// TEXT_FILE_FLOAT_BUFFER chars. No null terminator is written. Returns the number of chars written.
+u8 text_file_format_f64(f64 value, c8* buffer)
+{
+	u64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	u64 exponent_bits = (bits >> 52) & 0x7FF;
+	u64 mantissa_bits = bits & ((1ULL << 52) - 1);
+
+	bool done;
+	i32 length = text_file_format_float_prefix((bits >> 63) != 0, exponent_bits == 0x7FF && mantissa_bits != 0,
+		exponent_bits == 0x7FF && mantissa_bits == 0, (bits << 1) == 0, buffer, &done);
+	if (done)
+		return (u8)length;
+
+	text_file_diyfp w, m_minus, m_plus;
+	text_file_float_boundaries(bits & 0x7FFFFFFFFFFFFFFFULL, 53, 1075, &w, &m_minus, &m_plus);
+
+	text_file_cached_power cached = text_file_cached_power_for_exponent(m_plus.e);
+	text_file_diyfp c_minus_k = text_file_diyfp_make(cached.f, cached.e);
+	w = text_file_diyfp_mul(w, c_minus_k);
+	m_minus = text_file_diyfp_mul(m_minus, c_minus_k);
+	m_plus = text_file_diyfp_mul(m_plus, c_minus_k);
+
+	// Shrink the interval by one unit on both sides to make up for the rounding in the multiplication
+	m_minus.f++;
+	m_plus.f--;
+
+	i32 decimal_exponent = -cached.k;
+	i32 digits = text_file_grisu2_digits(buffer + length, &decimal_exponent, m_minus, w, m_plus);
+
+	return (u8)(length + text_file_format_float_digits(buffer + length, digits, decimal_exponent));
+}
+// Format an 'f32' as the shortest decimal text that reads back as the same value. 'buffer' must hold
+// TEXT_FILE_FLOAT_BUFFER chars. No null terminator is written. Returns the number of chars written.
+u8 text_file_format_f32(f32 value, c8* buffer)
+{
+	u32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	u32 exponent_bits = (bits >> 23) & 0xFF;
+	u32 mantissa_bits = bits & ((1U << 23) - 1);
+
+	bool done;
+	i32 length = text_file_format_float_prefix((bits >> 31) != 0, exponent_bits == 0xFF && mantissa_bits != 0,
+		exponent_bits == 0xFF && mantissa_bits == 0, (bits << 1) == 0, buffer, &done);
+	if (done)
+		return (u8)length;
+
+	// Same as for 'f64', but the rounding interval is computed with the precision of a float
+	text_file_diyfp w, m_minus, m_plus;
+	text_file_float_boundaries(bits & 0x7FFFFFFFU, 24, 150, &w, &m_minus, &m_plus);
+
+	text_file_cached_power cached = text_file_cached_power_for_exponent(m_plus.e);
+	text_file_diyfp c_minus_k = text_file_diyfp_make(cached.f, cached.e);
+	w = text_file_diyfp_mul(w, c_minus_k);
+	m_minus = text_file_diyfp_mul(m_minus, c_minus_k);
+	m_plus = text_file_diyfp_mul(m_plus, c_minus_k);
+
+	m_minus.f++;
+	m_plus.f--;
+
+	i32 decimal_exponent = -cached.k;
+	i32 digits = text_file_grisu2_digits(buffer + length, &decimal_exponent, m_minus, w, m_plus);
+
+	return (u8)(length + text_file_format_float_digits(buffer + length, digits, decimal_exponent));
+}
+
+//
+// Implementations: Float parsing
+//
+// Decimal text is split into up to 19 significant digits 'w' and a decimal exponent 'q', value = w * 10^q.
+// Exact cases are computed with one float multiplication (Clinger's fast path), the rest with the Eisel-Lemire
+// algorithm which multiplies w by a 128-bit truncated power of five. In the very rare cases where that can not
+// decide the rounding, strtod(..) is used as the fallback.
+//
+
+// A decimal float split into its parts
+typedef struct text_file_decimal
+{
+	u64 w;				// Up to 19 significant digits
+	i64 q;				// Decimal exponent
+	bool negative;
+	bool truncated;		// Non-zero digits after the first 19 were dropped
+} text_file_decimal;
+
+// Describes the bit layout of a binary floating point type for the Eisel-Lemire algorithm
+typedef struct text_file_float_layout
+{
+	i32 mantissa_bits;			// Explicit mantissa bits
+	i32 minimum_exponent;		// -bias
+	i32 infinite_power;			// Biased exponent of infinity
+	i32 smallest_power_of_ten;	// Anything smaller is zero
+	i32 largest_power_of_ten;	// Anything larger is infinity
+	i32 min_round_to_even;		// Range of q where ties to even can happen
+	i32 max_round_to_even;
+} text_file_float_layout;
+
+// Multiply two u64's to a 128-bit product
+void text_file_mul128(u64 a, u64 b, u64* high, u64* low)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128)a * b;
+	*high = (u64)(product >> 64);
+	*low = (u64)product;
+#elif defined(_MSC_VER) && defined(_M_X64)
+	*low = _umul128(a, b, high);
+#else
+	u64 a_lo = a & 0xFFFFFFFFULL, a_hi = a >> 32;
+	u64 b_lo = b & 0xFFFFFFFFULL, b_hi = b >> 32;
+	u64 p0 = a_lo * b_lo;
+	u64 p1 = a_lo * b_hi;
+	u64 p2 = a_hi * b_lo;
+	u64 p3 = a_hi * b_hi;
+	u64 middle = (p0 >> 32) + (p1 & 0xFFFFFFFFULL) + (p2 & 0xFFFFFFFFULL);
+	*low = (middle << 32) | (p0 & 0xFFFFFFFFULL);
+	*high = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+#endif
+}
+// Get the 128-bit truncated value of 5^q as two u64's (high, low), for q in the range [-342, 308]
+const u64* text_file_power_of_five(i64 q)
+{
+	static const u64 powers_of_five[651 * 2] =
+	{
+		0xEEF453D6923BD65AULL, 0x113FAA2906A13B3FULL, // 5^-342
+		0x9558B4661B6565F8ULL, 0x4AC7CA59A424C507ULL, // 5^-341
+		0xBAAEE17FA23EBF76ULL, 0x5D79BCF00D2DF649ULL, // 5^-340
+		0xE95A99DF8ACE6F53ULL, 0xF4D82C2C107973DCULL, // 5^-339
+		0x91D8A02BB6C10594ULL, 0x79071B9B8A4BE869ULL, // 5^-338
+		0xB64EC836A47146F9ULL, 0x9748E2826CDEE284ULL, // 5^-337
+		0xE3E27A444D8D98B7ULL, 0xFD1B1B2308169B25ULL, // 5^-336
+		0x8E6D8C6AB0787F72ULL, 0xFE30F0F5E50E20F7ULL, // 5^-335
+		0xB208EF855C969F4FULL, 0xBDBD2D335E51A935ULL, // 5^-334
+		0xDE8B2B66B3BC4723ULL, 0xAD2C788035E61382ULL, // 5^-333
+		0x8B16FB203055AC76ULL, 0x4C3BCB5021AFCC31ULL, // 5^-332
+		0xADDCB9E83C6B1793ULL, 0xDF4ABE242A1BBF3DULL, // 5^-331
+		0xD953E8624B85DD78ULL, 0xD71D6DAD34A2AF0DULL, // 5^-330
+		0x87D4713D6F33AA6BULL, 0x8672648C40E5AD68ULL, // 5^-329
+		0xA9C98D8CCB009506ULL, 0x680EFDAF511F18C2ULL, // 5^-328
+		0xD43BF0EFFDC0BA48ULL, 0x0212BD1B2566DEF2ULL, // 5^-327
+		0x84A57695FE98746DULL, 0x014BB630F7604B57ULL, // 5^-326
+		0xA5CED43B7E3E9188ULL, 0x419EA3BD35385E2DULL, // 5^-325
+		0xCF42894A5DCE35EAULL, 0x52064CAC828675B9ULL, // 5^-324
+		0x818995CE7AA0E1B2ULL, 0x7343EFEBD1940993ULL, // 5^-323
+		0xA1EBFB4219491A1FULL, 0x1014EBE6C5F90BF8ULL, // 5^-322
+		0xCA66FA129F9B60A6ULL, 0xD41A26E077774EF6ULL, // 5^-321
+		0xFD00B897478238D0ULL, 0x8920B098955522B4ULL, // 5^-320
+		0x9E20735E8CB16382ULL, 0x55B46E5F5D5535B0ULL, // 5^-319
+		0xC5A890362FDDBC62ULL, 0xEB2189F734AA831DULL, // 5^-318
+		0xF712B443BBD52B7BULL, 0xA5E9EC7501D523E4ULL, // 5^-317
+		0x9A6BB0AA55653B2DULL, 0x47B233C92125366EULL, // 5^-316
+		0xC1069CD4EABE89F8ULL, 0x999EC0BB696E840AULL, // 5^-315
+		0xF148440A256E2C76ULL, 0xC00670EA43CA250DULL, // 5^-314
+		0x96CD2A865764DBCAULL, 0x380406926A5E5728ULL, // 5^-313
+		0xBC807527ED3E12BCULL, 0xC605083704F5ECF2ULL, // 5^-312
+		0xEBA09271E88D976BULL, 0xF7864A44C633682EULL, // 5^-311
+		0x93445B8731587EA3ULL, 0x7AB3EE6AFBE0211DULL, // 5^-310
+		0xB8157268FDAE9E4CULL, 0x5960EA05BAD82964ULL, // 5^-309
+		0xE61ACF033D1A45DFULL, 0x6FB92487298E33BDULL, // 5^-308
+		0x8FD0C16206306BABULL, 0xA5D3B6D479F8E056ULL, // 5^-307
+		0xB3C4F1BA87BC8696ULL, 0x8F48A4899877186CULL, // 5^-306
+		0xE0B62E2929ABA83CULL, 0x331ACDABFE94DE87ULL, // 5^-305
+		0x8C71DCD9BA0B4925ULL, 0x9FF0C08B7F1D0B14ULL, // 5^-304
+		0xAF8E5410288E1B6FULL, 0x07ECF0AE5EE44DD9ULL, // 5^-303
+		0xDB71E91432B1A24AULL, 0xC9E82CD9F69D6150ULL, // 5^-302
+		0x892731AC9FAF056EULL, 0xBE311C083A225CD2ULL, // 5^-301
+		0xAB70FE17C79AC6CAULL, 0x6DBD630A48AAF406ULL, // 5^-300
+		0xD64D3D9DB981787DULL, 0x092CBBCCDAD5B108ULL, // 5^-299
+		0x85F0468293F0EB4EULL, 0x25BBF56008C58EA5ULL, // 5^-298
+		0xA76C582338ED2621ULL, 0xAF2AF2B80AF6F24EULL, // 5^-297
+		0xD1476E2C07286FAAULL, 0x1AF5AF660DB4AEE1ULL, // 5^-296
+		0x82CCA4DB847945CAULL, 0x50D98D9FC890ED4DULL, // 5^-295
+		0xA37FCE126597973CULL, 0xE50FF107BAB528A0ULL, // 5^-294
+		0xCC5FC196FEFD7D0CULL, 0x1E53ED49A96272C8ULL, // 5^-293
+		0xFF77B1FCBEBCDC4FULL, 0x25E8E89C13BB0F7AULL, // 5^-292
+		0x9FAACF3DF73609B1ULL, 0x77B191618C54E9ACULL, // 5^-291
+		0xC795830D75038C1DULL, 0xD59DF5B9EF6A2417ULL, // 5^-290
+		0xF97AE3D0D2446F25ULL, 0x4B0573286B44AD1DULL, // 5^-289
+		0x9BECCE62836AC577ULL, 0x4EE367F9430AEC32ULL, // 5^-288
+		0xC2E801FB244576D5ULL, 0x229C41F793CDA73FULL, // 5^-287
+		0xF3A20279ED56D48AULL, 0x6B43527578C1110FULL, // 5^-286
+		0x9845418C345644D6ULL, 0x830A13896B78AAA9ULL, // 5^-285
+		0xBE5691EF416BD60CULL, 0x23CC986BC656D553ULL, // 5^-284
+		0xEDEC366B11C6CB8FULL, 0x2CBFBE86B7EC8AA8ULL, // 5^-283
+		0x94B3A202EB1C3F39ULL, 0x7BF7D71432F3D6A9ULL, // 5^-282
+		0xB9E08A83A5E34F07ULL, 0xDAF5CCD93FB0CC53ULL, // 5^-281
+		0xE858AD248F5C22C9ULL, 0xD1B3400F8F9CFF68ULL, // 5^-280
+		0x91376C36D99995BEULL, 0x23100809B9C21FA1ULL, // 5^-279
+		0xB58547448FFFFB2DULL, 0xABD40A0C2832A78AULL, // 5^-278
+		0xE2E69915B3FFF9F9ULL, 0x16C90C8F323F516CULL, // 5^-277
+		0x8DD01FAD907FFC3BULL, 0xAE3DA7D97F6792E3ULL, // 5^-276
+		0xB1442798F49FFB4AULL, 0x99CD11CFDF41779CULL, // 5^-275
+		0xDD95317F31C7FA1DULL, 0x40405643D711D583ULL, // 5^-274
+		0x8A7D3EEF7F1CFC52ULL, 0x482835EA666B2572ULL, // 5^-273
+		0xAD1C8EAB5EE43B66ULL, 0xDA3243650005EECFULL, // 5^-272
+		0xD863B256369D4A40ULL, 0x90BED43E40076A82ULL, // 5^-271
+		0x873E4F75E2224E68ULL, 0x5A7744A6E804A291ULL, // 5^-270
+		0xA90DE3535AAAE202ULL, 0x711515D0A205CB36ULL, // 5^-269
+		0xD3515C2831559A83ULL, 0x0D5A5B44CA873E03ULL, // 5^-268
+		0x8412D9991ED58091ULL, 0xE858790AFE9486C2ULL, // 5^-267
+		0xA5178FFF668AE0B6ULL, 0x626E974DBE39A872ULL, // 5^-266
+		0xCE5D73FF402D98E3ULL, 0xFB0A3D212DC8128FULL, // 5^-265
+		0x80FA687F881C7F8EULL, 0x7CE66634BC9D0B99ULL, // 5^-264
+		0xA139029F6A239F72ULL, 0x1C1FFFC1EBC44E80ULL, // 5^-263
+		0xC987434744AC874EULL, 0xA327FFB266B56220ULL, // 5^-262
+		0xFBE9141915D7A922ULL, 0x4BF1FF9F0062BAA8ULL, // 5^-261
+		0x9D71AC8FADA6C9B5ULL, 0x6F773FC3603DB4A9ULL, // 5^-260
+		0xC4CE17B399107C22ULL, 0xCB550FB4384D21D3ULL, // 5^-259
+		0xF6019DA07F549B2BULL, 0x7E2A53A146606A48ULL, // 5^-258
+		0x99C102844F94E0FBULL, 0x2EDA7444CBFC426DULL, // 5^-257
+		0xC0314325637A1939ULL, 0xFA911155FEFB5308ULL, // 5^-256
+		0xF03D93EEBC589F88ULL, 0x793555AB7EBA27CAULL, // 5^-255
+		0x96267C7535B763B5ULL, 0x4BC1558B2F3458DEULL, // 5^-254
+		0xBBB01B9283253CA2ULL, 0x9EB1AAEDFB016F16ULL, // 5^-253
+		0xEA9C227723EE8BCBULL, 0x465E15A979C1CADCULL, // 5^-252
+		0x92A1958A7675175FULL, 0x0BFACD89EC191EC9ULL, // 5^-251
+		0xB749FAED14125D36ULL, 0xCEF980EC671F667BULL, // 5^-250
+		0xE51C79A85916F484ULL, 0x82B7E12780E7401AULL, // 5^-249
+		0x8F31CC0937AE58D2ULL, 0xD1B2ECB8B0908810ULL, // 5^-248
+		0xB2FE3F0B8599EF07ULL, 0x861FA7E6DCB4AA15ULL, // 5^-247
+		0xDFBDCECE67006AC9ULL, 0x67A791E093E1D49AULL, // 5^-246
+		0x8BD6A141006042BDULL, 0xE0C8BB2C5C6D24E0ULL, // 5^-245
+		0xAECC49914078536DULL, 0x58FAE9F773886E18ULL, // 5^-244
+		0xDA7F5BF590966848ULL, 0xAF39A475506A899EULL, // 5^-243
+		0x888F99797A5E012DULL, 0x6D8406C952429603ULL, // 5^-242
+		0xAAB37FD7D8F58178ULL, 0xC8E5087BA6D33B83ULL, // 5^-241
+		0xD5605FCDCF32E1D6ULL, 0xFB1E4A9A90880A64ULL, // 5^-240
+		0x855C3BE0A17FCD26ULL, 0x5CF2EEA09A55067FULL, // 5^-239
+		0xA6B34AD8C9DFC06FULL, 0xF42FAA48C0EA481EULL, // 5^-238
+		0xD0601D8EFC57B08BULL, 0xF13B94DAF124DA26ULL, // 5^-237
+		0x823C12795DB6CE57ULL, 0x76C53D08D6B70858ULL, // 5^-236
+		0xA2CB1717B52481EDULL, 0x54768C4B0C64CA6EULL, // 5^-235
+		0xCB7DDCDDA26DA268ULL, 0xA9942F5DCF7DFD09ULL, // 5^-234
+		0xFE5D54150B090B02ULL, 0xD3F93B35435D7C4CULL, // 5^-233
+		0x9EFA548D26E5A6E1ULL, 0xC47BC5014A1A6DAFULL, // 5^-232
+		0xC6B8E9B0709F109AULL, 0x359AB6419CA1091BULL, // 5^-231
+		0xF867241C8CC6D4C0ULL, 0xC30163D203C94B62ULL, // 5^-230
+		0x9B407691D7FC44F8ULL, 0x79E0DE63425DCF1DULL, // 5^-229
+		0xC21094364DFB5636ULL, 0x985915FC12F542E4ULL, // 5^-228
+		0xF294B943E17A2BC4ULL, 0x3E6F5B7B17B2939DULL, // 5^-227
+		0x979CF3CA6CEC5B5AULL, 0xA705992CEECF9C42ULL, // 5^-226
+		0xBD8430BD08277231ULL, 0x50C6FF782A838353ULL, // 5^-225
+		0xECE53CEC4A314EBDULL, 0xA4F8BF5635246428ULL, // 5^-224
+		0x940F4613AE5ED136ULL, 0x871B7795E136BE99ULL, // 5^-223
+		0xB913179899F68584ULL, 0x28E2557B59846E3FULL, // 5^-222
+		0xE757DD7EC07426E5ULL, 0x331AEADA2FE589CFULL, // 5^-221
+		0x9096EA6F3848984FULL, 0x3FF0D2C85DEF7621ULL, // 5^-220
+		0xB4BCA50B065ABE63ULL, 0x0FED077A756B53A9ULL, // 5^-219
+		0xE1EBCE4DC7F16DFBULL, 0xD3E8495912C62894ULL, // 5^-218
+		0x8D3360F09CF6E4BDULL, 0x64712DD7ABBBD95CULL, // 5^-217
+		0xB080392CC4349DECULL, 0xBD8D794D96AACFB3ULL, // 5^-216
+		0xDCA04777F541C567ULL, 0xECF0D7A0FC5583A0ULL, // 5^-215
+		0x89E42CAAF9491B60ULL, 0xF41686C49DB57244ULL, // 5^-214
+		0xAC5D37D5B79B6239ULL, 0x311C2875C522CED5ULL, // 5^-213
+		0xD77485CB25823AC7ULL, 0x7D633293366B828BULL, // 5^-212
+		0x86A8D39EF77164BCULL, 0xAE5DFF9C02033197ULL, // 5^-211
+		0xA8530886B54DBDEBULL, 0xD9F57F830283FDFCULL, // 5^-210
+		0xD267CAA862A12D66ULL, 0xD072DF63C324FD7BULL, // 5^-209
+		0x8380DEA93DA4BC60ULL, 0x4247CB9E59F71E6DULL, // 5^-208
+		0xA46116538D0DEB78ULL, 0x52D9BE85F074E608ULL, // 5^-207
+		0xCD795BE870516656ULL, 0x67902E276C921F8BULL, // 5^-206
+		0x806BD9714632DFF6ULL, 0x00BA1CD8A3DB53B6ULL, // 5^-205
+		0xA086CFCD97BF97F3ULL, 0x80E8A40ECCD228A4ULL, // 5^-204
+		0xC8A883C0FDAF7DF0ULL, 0x6122CD128006B2CDULL, // 5^-203
+		0xFAD2A4B13D1B5D6CULL, 0x796B805720085F81ULL, // 5^-202
+		0x9CC3A6EEC6311A63ULL, 0xCBE3303674053BB0ULL, // 5^-201
+		0xC3F490AA77BD60FCULL, 0xBEDBFC4411068A9CULL, // 5^-200
+		0xF4F1B4D515ACB93BULL, 0xEE92FB5515482D44ULL, // 5^-199
+		0x991711052D8BF3C5ULL, 0x751BDD152D4D1C4AULL, // 5^-198
+		0xBF5CD54678EEF0B6ULL, 0xD262D45A78A0635DULL, // 5^-197
+		0xEF340A98172AACE4ULL, 0x86FB897116C87C34ULL, // 5^-196
+		0x9580869F0E7AAC0EULL, 0xD45D35E6AE3D4DA0ULL, // 5^-195
+		0xBAE0A846D2195712ULL, 0x8974836059CCA109ULL, // 5^-194
+		0xE998D258869FACD7ULL, 0x2BD1A438703FC94BULL, // 5^-193
+		0x91FF83775423CC06ULL, 0x7B6306A34627DDCFULL, // 5^-192
+		0xB67F6455292CBF08ULL, 0x1A3BC84C17B1D542ULL, // 5^-191
+		0xE41F3D6A7377EECAULL, 0x20CABA5F1D9E4A93ULL, // 5^-190
+		0x8E938662882AF53EULL, 0x547EB47B7282EE9CULL, // 5^-189
+		0xB23867FB2A35B28DULL, 0xE99E619A4F23AA43ULL, // 5^-188
+		0xDEC681F9F4C31F31ULL, 0x6405FA00E2EC94D4ULL, // 5^-187
+		0x8B3C113C38F9F37EULL, 0xDE83BC408DD3DD04ULL, // 5^-186
+		0xAE0B158B4738705EULL, 0x9624AB50B148D445ULL, // 5^-185
+		0xD98DDAEE19068C76ULL, 0x3BADD624DD9B0957ULL, // 5^-184
+		0x87F8A8D4CFA417C9ULL, 0xE54CA5D70A80E5D6ULL, // 5^-183
+		0xA9F6D30A038D1DBCULL, 0x5E9FCF4CCD211F4CULL, // 5^-182
+		0xD47487CC8470652BULL, 0x7647C3200069671FULL, // 5^-181
+		0x84C8D4DFD2C63F3BULL, 0x29ECD9F40041E073ULL, // 5^-180
+		0xA5FB0A17C777CF09ULL, 0xF468107100525890ULL, // 5^-179
+		0xCF79CC9DB955C2CCULL, 0x7182148D4066EEB4ULL, // 5^-178
+		0x81AC1FE293D599BFULL, 0xC6F14CD848405530ULL, // 5^-177
+		0xA21727DB38CB002FULL, 0xB8ADA00E5A506A7CULL, // 5^-176
+		0xCA9CF1D206FDC03BULL, 0xA6D90811F0E4851CULL, // 5^-175
+		0xFD442E4688BD304AULL, 0x908F4A166D1DA663ULL, // 5^-174
+		0x9E4A9CEC15763E2EULL, 0x9A598E4E043287FEULL, // 5^-173
+		0xC5DD44271AD3CDBAULL, 0x40EFF1E1853F29FDULL, // 5^-172
+		0xF7549530E188C128ULL, 0xD12BEE59E68EF47CULL, // 5^-171
+		0x9A94DD3E8CF578B9ULL, 0x82BB74F8301958CEULL, // 5^-170
+		0xC13A148E3032D6E7ULL, 0xE36A52363C1FAF01ULL, // 5^-169
+		0xF18899B1BC3F8CA1ULL, 0xDC44E6C3CB279AC1ULL, // 5^-168
+		0x96F5600F15A7B7E5ULL, 0x29AB103A5EF8C0B9ULL, // 5^-167
+		0xBCB2B812DB11A5DEULL, 0x7415D448F6B6F0E7ULL, // 5^-166
+		0xEBDF661791D60F56ULL, 0x111B495B3464AD21ULL, // 5^-165
+		0x936B9FCEBB25C995ULL, 0xCAB10DD900BEEC34ULL, // 5^-164
+		0xB84687C269EF3BFBULL, 0x3D5D514F40EEA742ULL, // 5^-163
+		0xE65829B3046B0AFAULL, 0x0CB4A5A3112A5112ULL, // 5^-162
+		0x8FF71A0FE2C2E6DCULL, 0x47F0E785EABA72ABULL, // 5^-161
+		0xB3F4E093DB73A093ULL, 0x59ED216765690F56ULL, // 5^-160
+		0xE0F218B8D25088B8ULL, 0x306869C13EC3532CULL, // 5^-159
+		0x8C974F7383725573ULL, 0x1E414218C73A13FBULL, // 5^-158
+		0xAFBD2350644EEACFULL, 0xE5D1929EF90898FAULL, // 5^-157
+		0xDBAC6C247D62A583ULL, 0xDF45F746B74ABF39ULL, // 5^-156
+		0x894BC396CE5DA772ULL, 0x6B8BBA8C328EB783ULL, // 5^-155
+		0xAB9EB47C81F5114FULL, 0x066EA92F3F326564ULL, // 5^-154
+		0xD686619BA27255A2ULL, 0xC80A537B0EFEFEBDULL, // 5^-153
+		0x8613FD0145877585ULL, 0xBD06742CE95F5F36ULL, // 5^-152
+		0xA798FC4196E952E7ULL, 0x2C48113823B73704ULL, // 5^-151
+		0xD17F3B51FCA3A7A0ULL, 0xF75A15862CA504C5ULL, // 5^-150
+		0x82EF85133DE648C4ULL, 0x9A984D73DBE722FBULL, // 5^-149
+		0xA3AB66580D5FDAF5ULL, 0xC13E60D0D2E0EBBAULL, // 5^-148
+		0xCC963FEE10B7D1B3ULL, 0x318DF905079926A8ULL, // 5^-147
+		0xFFBBCFE994E5C61FULL, 0xFDF17746497F7052ULL, // 5^-146
+		0x9FD561F1FD0F9BD3ULL, 0xFEB6EA8BEDEFA633ULL, // 5^-145
+		0xC7CABA6E7C5382C8ULL, 0xFE64A52EE96B8FC0ULL, // 5^-144
+		0xF9BD690A1B68637BULL, 0x3DFDCE7AA3C673B0ULL, // 5^-143
+		0x9C1661A651213E2DULL, 0x06BEA10CA65C084EULL, // 5^-142
+		0xC31BFA0FE5698DB8ULL, 0x486E494FCFF30A62ULL, // 5^-141
+		0xF3E2F893DEC3F126ULL, 0x5A89DBA3C3EFCCFAULL, // 5^-140
+		0x986DDB5C6B3A76B7ULL, 0xF89629465A75E01CULL, // 5^-139
+		0xBE89523386091465ULL, 0xF6BBB397F1135823ULL, // 5^-138
+		0xEE2BA6C0678B597FULL, 0x746AA07DED582E2CULL, // 5^-137
+		0x94DB483840B717EFULL, 0xA8C2A44EB4571CDCULL, // 5^-136
+		0xBA121A4650E4DDEBULL, 0x92F34D62616CE413ULL, // 5^-135
+		0xE896A0D7E51E1566ULL, 0x77B020BAF9C81D17ULL, // 5^-134
+		0x915E2486EF32CD60ULL, 0x0ACE1474DC1D122EULL, // 5^-133
+		0xB5B5ADA8AAFF80B8ULL, 0x0D819992132456BAULL, // 5^-132
+		0xE3231912D5BF60E6ULL, 0x10E1FFF697ED6C69ULL, // 5^-131
+		0x8DF5EFABC5979C8FULL, 0xCA8D3FFA1EF463C1ULL, // 5^-130
+		0xB1736B96B6FD83B3ULL, 0xBD308FF8A6B17CB2ULL, // 5^-129
+		0xDDD0467C64BCE4A0ULL, 0xAC7CB3F6D05DDBDEULL, // 5^-128
+		0x8AA22C0DBEF60EE4ULL, 0x6BCDF07A423AA96BULL, // 5^-127
+		0xAD4AB7112EB3929DULL, 0x86C16C98D2C953C6ULL, // 5^-126
+		0xD89D64D57A607744ULL, 0xE871C7BF077BA8B7ULL, // 5^-125
+		0x87625F056C7C4A8BULL, 0x11471CD764AD4972ULL, // 5^-124
+		0xA93AF6C6C79B5D2DULL, 0xD598E40D3DD89BCFULL, // 5^-123
+		0xD389B47879823479ULL, 0x4AFF1D108D4EC2C3ULL, // 5^-122
+		0x843610CB4BF160CBULL, 0xCEDF722A585139BAULL, // 5^-121
+		0xA54394FE1EEDB8FEULL, 0xC2974EB4EE658828ULL, // 5^-120
+		0xCE947A3DA6A9273EULL, 0x733D226229FEEA32ULL, // 5^-119
+		0x811CCC668829B887ULL, 0x0806357D5A3F525FULL, // 5^-118
+		0xA163FF802A3426A8ULL, 0xCA07C2DCB0CF26F7ULL, // 5^-117
+		0xC9BCFF6034C13052ULL, 0xFC89B393DD02F0B5ULL, // 5^-116
+		0xFC2C3F3841F17C67ULL, 0xBBAC2078D443ACE2ULL, // 5^-115
+		0x9D9BA7832936EDC0ULL, 0xD54B944B84AA4C0DULL, // 5^-114
+		0xC5029163F384A931ULL, 0x0A9E795E65D4DF11ULL, // 5^-113
+		0xF64335BCF065D37DULL, 0x4D4617B5FF4A16D5ULL, // 5^-112
+		0x99EA0196163FA42EULL, 0x504BCED1BF8E4E45ULL, // 5^-111
+		0xC06481FB9BCF8D39ULL, 0xE45EC2862F71E1D6ULL, // 5^-110
+		0xF07DA27A82C37088ULL, 0x5D767327BB4E5A4CULL, // 5^-109
+		0x964E858C91BA2655ULL, 0x3A6A07F8D510F86FULL, // 5^-108
+		0xBBE226EFB628AFEAULL, 0x890489F70A55368BULL, // 5^-107
+		0xEADAB0ABA3B2DBE5ULL, 0x2B45AC74CCEA842EULL, // 5^-106
+		0x92C8AE6B464FC96FULL, 0x3B0B8BC90012929DULL, // 5^-105
+		0xB77ADA0617E3BBCBULL, 0x09CE6EBB40173744ULL, // 5^-104
+		0xE55990879DDCAABDULL, 0xCC420A6A101D0515ULL, // 5^-103
+		0x8F57FA54C2A9EAB6ULL, 0x9FA946824A12232DULL, // 5^-102
+		0xB32DF8E9F3546564ULL, 0x47939822DC96ABF9ULL, // 5^-101
+		0xDFF9772470297EBDULL, 0x59787E2B93BC56F7ULL, // 5^-100
+		0x8BFBEA76C619EF36ULL, 0x57EB4EDB3C55B65AULL, // 5^-99
+		0xAEFAE51477A06B03ULL, 0xEDE622920B6B23F1ULL, // 5^-98
+		0xDAB99E59958885C4ULL, 0xE95FAB368E45ECEDULL, // 5^-97
+		0x88B402F7FD75539BULL, 0x11DBCB0218EBB414ULL, // 5^-96
+		0xAAE103B5FCD2A881ULL, 0xD652BDC29F26A119ULL, // 5^-95
+		0xD59944A37C0752A2ULL, 0x4BE76D3346F0495FULL, // 5^-94
+		0x857FCAE62D8493A5ULL, 0x6F70A4400C562DDBULL, // 5^-93
+		0xA6DFBD9FB8E5B88EULL, 0xCB4CCD500F6BB952ULL, // 5^-92
+		0xD097AD07A71F26B2ULL, 0x7E2000A41346A7A7ULL, // 5^-91
+		0x825ECC24C873782FULL, 0x8ED400668C0C28C8ULL, // 5^-90
+		0xA2F67F2DFA90563BULL, 0x728900802F0F32FAULL, // 5^-89
+		0xCBB41EF979346BCAULL, 0x4F2B40A03AD2FFB9ULL, // 5^-88
+		0xFEA126B7D78186BCULL, 0xE2F610C84987BFA8ULL, // 5^-87
+		0x9F24B832E6B0F436ULL, 0x0DD9CA7D2DF4D7C9ULL, // 5^-86
+		0xC6EDE63FA05D3143ULL, 0x91503D1C79720DBBULL, // 5^-85
+		0xF8A95FCF88747D94ULL, 0x75A44C6397CE912AULL, // 5^-84
+		0x9B69DBE1B548CE7CULL, 0xC986AFBE3EE11ABAULL, // 5^-83
+		0xC24452DA229B021BULL, 0xFBE85BADCE996168ULL, // 5^-82
+		0xF2D56790AB41C2A2ULL, 0xFAE27299423FB9C3ULL, // 5^-81
+		0x97C560BA6B0919A5ULL, 0xDCCD879FC967D41AULL, // 5^-80
+		0xBDB6B8E905CB600FULL, 0x5400E987BBC1C920ULL, // 5^-79
+		0xED246723473E3813ULL, 0x290123E9AAB23B68ULL, // 5^-78
+		0x9436C0760C86E30BULL, 0xF9A0B6720AAF6521ULL, // 5^-77
+		0xB94470938FA89BCEULL, 0xF808E40E8D5B3E69ULL, // 5^-76
+		0xE7958CB87392C2C2ULL, 0xB60B1D1230B20E04ULL, // 5^-75
+		0x90BD77F3483BB9B9ULL, 0xB1C6F22B5E6F48C2ULL, // 5^-74
+		0xB4ECD5F01A4AA828ULL, 0x1E38AEB6360B1AF3ULL, // 5^-73
+		0xE2280B6C20DD5232ULL, 0x25C6DA63C38DE1B0ULL, // 5^-72
+		0x8D590723948A535FULL, 0x579C487E5A38AD0EULL, // 5^-71
+		0xB0AF48EC79ACE837ULL, 0x2D835A9DF0C6D851ULL, // 5^-70
+		0xDCDB1B2798182244ULL, 0xF8E431456CF88E65ULL, // 5^-69
+		0x8A08F0F8BF0F156BULL, 0x1B8E9ECB641B58FFULL, // 5^-68
+		0xAC8B2D36EED2DAC5ULL, 0xE272467E3D222F3FULL, // 5^-67
+		0xD7ADF884AA879177ULL, 0x5B0ED81DCC6ABB0FULL, // 5^-66
+		0x86CCBB52EA94BAEAULL, 0x98E947129FC2B4E9ULL, // 5^-65
+		0xA87FEA27A539E9A5ULL, 0x3F2398D747B36224ULL, // 5^-64
+		0xD29FE4B18E88640EULL, 0x8EEC7F0D19A03AADULL, // 5^-63
+		0x83A3EEEEF9153E89ULL, 0x1953CF68300424ACULL, // 5^-62
+		0xA48CEAAAB75A8E2BULL, 0x5FA8C3423C052DD7ULL, // 5^-61
+		0xCDB02555653131B6ULL, 0x3792F412CB06794DULL, // 5^-60
+		0x808E17555F3EBF11ULL, 0xE2BBD88BBEE40BD0ULL, // 5^-59
+		0xA0B19D2AB70E6ED6ULL, 0x5B6ACEAEAE9D0EC4ULL, // 5^-58
+		0xC8DE047564D20A8BULL, 0xF245825A5A445275ULL, // 5^-57
+		0xFB158592BE068D2EULL, 0xEED6E2F0F0D56712ULL, // 5^-56
+		0x9CED737BB6C4183DULL, 0x55464DD69685606BULL, // 5^-55
+		0xC428D05AA4751E4CULL, 0xAA97E14C3C26B886ULL, // 5^-54
+		0xF53304714D9265DFULL, 0xD53DD99F4B3066A8ULL, // 5^-53
+		0x993FE2C6D07B7FABULL, 0xE546A8038EFE4029ULL, // 5^-52
+		0xBF8FDB78849A5F96ULL, 0xDE98520472BDD033ULL, // 5^-51
+		0xEF73D256A5C0F77CULL, 0x963E66858F6D4440ULL, // 5^-50
+		0x95A8637627989AADULL, 0xDDE7001379A44AA8ULL, // 5^-49
+		0xBB127C53B17EC159ULL, 0x5560C018580D5D52ULL, // 5^-48
+		0xE9D71B689DDE71AFULL, 0xAAB8F01E6E10B4A6ULL, // 5^-47
+		0x9226712162AB070DULL, 0xCAB3961304CA70E8ULL, // 5^-46
+		0xB6B00D69BB55C8D1ULL, 0x3D607B97C5FD0D22ULL, // 5^-45
+		0xE45C10C42A2B3B05ULL, 0x8CB89A7DB77C506AULL, // 5^-44
+		0x8EB98A7A9A5B04E3ULL, 0x77F3608E92ADB242ULL, // 5^-43
+		0xB267ED1940F1C61CULL, 0x55F038B237591ED3ULL, // 5^-42
+		0xDF01E85F912E37A3ULL, 0x6B6C46DEC52F6688ULL, // 5^-41
+		0x8B61313BBABCE2C6ULL, 0x2323AC4B3B3DA015ULL, // 5^-40
+		0xAE397D8AA96C1B77ULL, 0xABEC975E0A0D081AULL, // 5^-39
+		0xD9C7DCED53C72255ULL, 0x96E7BD358C904A21ULL, // 5^-38
+		0x881CEA14545C7575ULL, 0x7E50D64177DA2E54ULL, // 5^-37
+		0xAA242499697392D2ULL, 0xDDE50BD1D5D0B9E9ULL, // 5^-36
+		0xD4AD2DBFC3D07787ULL, 0x955E4EC64B44E864ULL, // 5^-35
+		0x84EC3C97DA624AB4ULL, 0xBD5AF13BEF0B113EULL, // 5^-34
+		0xA6274BBDD0FADD61ULL, 0xECB1AD8AEACDD58EULL, // 5^-33
+		0xCFB11EAD453994BAULL, 0x67DE18EDA5814AF2ULL, // 5^-32
+		0x81CEB32C4B43FCF4ULL, 0x80EACF948770CED7ULL, // 5^-31
+		0xA2425FF75E14FC31ULL, 0xA1258379A94D028DULL, // 5^-30
+		0xCAD2F7F5359A3B3EULL, 0x096EE45813A04330ULL, // 5^-29
+		0xFD87B5F28300CA0DULL, 0x8BCA9D6E188853FCULL, // 5^-28
+		0x9E74D1B791E07E48ULL, 0x775EA264CF55347EULL, // 5^-27
+		0xC612062576589DDAULL, 0x95364AFE032A819EULL, // 5^-26
+		0xF79687AED3EEC551ULL, 0x3A83DDBD83F52205ULL, // 5^-25
+		0x9ABE14CD44753B52ULL, 0xC4926A9672793543ULL, // 5^-24
+		0xC16D9A0095928A27ULL, 0x75B7053C0F178294ULL, // 5^-23
+		0xF1C90080BAF72CB1ULL, 0x5324C68B12DD6339ULL, // 5^-22
+		0x971DA05074DA7BEEULL, 0xD3F6FC16EBCA5E04ULL, // 5^-21
+		0xBCE5086492111AEAULL, 0x88F4BB1CA6BCF585ULL, // 5^-20
+		0xEC1E4A7DB69561A5ULL, 0x2B31E9E3D06C32E6ULL, // 5^-19
+		0x9392EE8E921D5D07ULL, 0x3AFF322E62439FD0ULL, // 5^-18
+		0xB877AA3236A4B449ULL, 0x09BEFEB9FAD487C3ULL, // 5^-17
+		0xE69594BEC44DE15BULL, 0x4C2EBE687989A9B4ULL, // 5^-16
+		0x901D7CF73AB0ACD9ULL, 0x0F9D37014BF60A11ULL, // 5^-15
+		0xB424DC35095CD80FULL, 0x538484C19EF38C95ULL, // 5^-14
+		0xE12E13424BB40E13ULL, 0x2865A5F206B06FBAULL, // 5^-13
+		0x8CBCCC096F5088CBULL, 0xF93F87B7442E45D4ULL, // 5^-12
+		0xAFEBFF0BCB24AAFEULL, 0xF78F69A51539D749ULL, // 5^-11
+		0xDBE6FECEBDEDD5BEULL, 0xB573440E5A884D1CULL, // 5^-10
+		0x89705F4136B4A597ULL, 0x31680A88F8953031ULL, // 5^-9
+		0xABCC77118461CEFCULL, 0xFDC20D2B36BA7C3EULL, // 5^-8
+		0xD6BF94D5E57A42BCULL, 0x3D32907604691B4DULL, // 5^-7
+		0x8637BD05AF6C69B5ULL, 0xA63F9A49C2C1B110ULL, // 5^-6
+		0xA7C5AC471B478423ULL, 0x0FCF80DC33721D54ULL, // 5^-5
+		0xD1B71758E219652BULL, 0xD3C36113404EA4A9ULL, // 5^-4
+		0x83126E978D4FDF3BULL, 0x645A1CAC083126EAULL, // 5^-3
+		0xA3D70A3D70A3D70AULL, 0x3D70A3D70A3D70A4ULL, // 5^-2
+		0xCCCCCCCCCCCCCCCCULL, 0xCCCCCCCCCCCCCCCDULL, // 5^-1
+		0x8000000000000000ULL, 0x0000000000000000ULL, // 5^0
+		0xA000000000000000ULL, 0x0000000000000000ULL, // 5^1
+		0xC800000000000000ULL, 0x0000000000000000ULL, // 5^2
+		0xFA00000000000000ULL, 0x0000000000000000ULL, // 5^3
+		0x9C40000000000000ULL, 0x0000000000000000ULL, // 5^4
+		0xC350000000000000ULL, 0x0000000000000000ULL, // 5^5
+		0xF424000000000000ULL, 0x0000000000000000ULL, // 5^6
+		0x9896800000000000ULL, 0x0000000000000000ULL, // 5^7
+		0xBEBC200000000000ULL, 0x0000000000000000ULL, // 5^8
+		0xEE6B280000000000ULL, 0x0000000000000000ULL, // 5^9
+		0x9502F90000000000ULL, 0x0000000000000000ULL, // 5^10
+		0xBA43B74000000000ULL, 0x0000000000000000ULL, // 5^11
+		0xE8D4A51000000000ULL, 0x0000000000000000ULL, // 5^12
+		0x9184E72A00000000ULL, 0x0000000000000000ULL, // 5^13
+		0xB5E620F480000000ULL, 0x0000000000000000ULL, // 5^14
+		0xE35FA931A0000000ULL, 0x0000000000000000ULL, // 5^15
+		0x8E1BC9BF04000000ULL, 0x0000000000000000ULL, // 5^16
+		0xB1A2BC2EC5000000ULL, 0x0000000000000000ULL, // 5^17
+		0xDE0B6B3A76400000ULL, 0x0000000000000000ULL, // 5^18
+		0x8AC7230489E80000ULL, 0x0000000000000000ULL, // 5^19
+		0xAD78EBC5AC620000ULL, 0x0000000000000000ULL, // 5^20
+		0xD8D726B7177A8000ULL, 0x0000000000000000ULL, // 5^21
+		0x878678326EAC9000ULL, 0x0000000000000000ULL, // 5^22
+		0xA968163F0A57B400ULL, 0x0000000000000000ULL, // 5^23
+		0xD3C21BCECCEDA100ULL, 0x0000000000000000ULL, // 5^24
+		0x84595161401484A0ULL, 0x0000000000000000ULL, // 5^25
+		0xA56FA5B99019A5C8ULL, 0x0000000000000000ULL, // 5^26
+		0xCECB8F27F4200F3AULL, 0x0000000000000000ULL, // 5^27
+		0x813F3978F8940984ULL, 0x4000000000000000ULL, // 5^28
+		0xA18F07D736B90BE5ULL, 0x5000000000000000ULL, // 5^29
+		0xC9F2C9CD04674EDEULL, 0xA400000000000000ULL, // 5^30
+		0xFC6F7C4045812296ULL, 0x4D00000000000000ULL, // 5^31
+		0x9DC5ADA82B70B59DULL, 0xF020000000000000ULL, // 5^32
+		0xC5371912364CE305ULL, 0x6C28000000000000ULL, // 5^33
+		0xF684DF56C3E01BC6ULL, 0xC732000000000000ULL, // 5^34
+		0x9A130B963A6C115CULL, 0x3C7F400000000000ULL, // 5^35
+		0xC097CE7BC90715B3ULL, 0x4B9F100000000000ULL, // 5^36
+		0xF0BDC21ABB48DB20ULL, 0x1E86D40000000000ULL, // 5^37
+		0x96769950B50D88F4ULL, 0x1314448000000000ULL, // 5^38
+		0xBC143FA4E250EB31ULL, 0x17D955A000000000ULL, // 5^39
+		0xEB194F8E1AE525FDULL, 0x5DCFAB0800000000ULL, // 5^40
+		0x92EFD1B8D0CF37BEULL, 0x5AA1CAE500000000ULL, // 5^41
+		0xB7ABC627050305ADULL, 0xF14A3D9E40000000ULL, // 5^42
+		0xE596B7B0C643C719ULL, 0x6D9CCD05D0000000ULL, // 5^43
+		0x8F7E32CE7BEA5C6FULL, 0xE4820023A2000000ULL, // 5^44
+		0xB35DBF821AE4F38BULL, 0xDDA2802C8A800000ULL, // 5^45
+		0xE0352F62A19E306EULL, 0xD50B2037AD200000ULL, // 5^46
+		0x8C213D9DA502DE45ULL, 0x4526F422CC340000ULL, // 5^47
+		0xAF298D050E4395D6ULL, 0x9670B12B7F410000ULL, // 5^48
+		0xDAF3F04651D47B4CULL, 0x3C0CDD765F114000ULL, // 5^49
+		0x88D8762BF324CD0FULL, 0xA5880A69FB6AC800ULL, // 5^50
+		0xAB0E93B6EFEE0053ULL, 0x8EEA0D047A457A00ULL, // 5^51
+		0xD5D238A4ABE98068ULL, 0x72A4904598D6D880ULL, // 5^52
+		0x85A36366EB71F041ULL, 0x47A6DA2B7F864750ULL, // 5^53
+		0xA70C3C40A64E6C51ULL, 0x999090B65F67D924ULL, // 5^54
+		0xD0CF4B50CFE20765ULL, 0xFFF4B4E3F741CF6DULL, // 5^55
+		0x82818F1281ED449FULL, 0xBFF8F10E7A8921A4ULL, // 5^56
+		0xA321F2D7226895C7ULL, 0xAFF72D52192B6A0DULL, // 5^57
+		0xCBEA6F8CEB02BB39ULL, 0x9BF4F8A69F764490ULL, // 5^58
+		0xFEE50B7025C36A08ULL, 0x02F236D04753D5B4ULL, // 5^59
+		0x9F4F2726179A2245ULL, 0x01D762422C946590ULL, // 5^60
+		0xC722F0EF9D80AAD6ULL, 0x424D3AD2B7B97EF5ULL, // 5^61
+		0xF8EBAD2B84E0D58BULL, 0xD2E0898765A7DEB2ULL, // 5^62
+		0x9B934C3B330C8577ULL, 0x63CC55F49F88EB2FULL, // 5^63
+		0xC2781F49FFCFA6D5ULL, 0x3CBF6B71C76B25FBULL, // 5^64
+		0xF316271C7FC3908AULL, 0x8BEF464E3945EF7AULL, // 5^65
+		0x97EDD871CFDA3A56ULL, 0x97758BF0E3CBB5ACULL, // 5^66
+		0xBDE94E8E43D0C8ECULL, 0x3D52EEED1CBEA317ULL, // 5^67
+		0xED63A231D4C4FB27ULL, 0x4CA7AAA863EE4BDDULL, // 5^68
+		0x945E455F24FB1CF8ULL, 0x8FE8CAA93E74EF6AULL, // 5^69
+		0xB975D6B6EE39E436ULL, 0xB3E2FD538E122B44ULL, // 5^70
+		0xE7D34C64A9C85D44ULL, 0x60DBBCA87196B616ULL, // 5^71
+		0x90E40FBEEA1D3A4AULL, 0xBC8955E946FE31CDULL, // 5^72
+		0xB51D13AEA4A488DDULL, 0x6BABAB6398BDBE41ULL, // 5^73
+		0xE264589A4DCDAB14ULL, 0xC696963C7EED2DD1ULL, // 5^74
+		0x8D7EB76070A08AECULL, 0xFC1E1DE5CF543CA2ULL, // 5^75
+		0xB0DE65388CC8ADA8ULL, 0x3B25A55F43294BCBULL, // 5^76
+		0xDD15FE86AFFAD912ULL, 0x49EF0EB713F39EBEULL, // 5^77
+		0x8A2DBF142DFCC7ABULL, 0x6E3569326C784337ULL, // 5^78
+		0xACB92ED9397BF996ULL, 0x49C2C37F07965404ULL, // 5^79
+		0xD7E77A8F87DAF7FBULL, 0xDC33745EC97BE906ULL, // 5^80
+		0x86F0AC99B4E8DAFDULL, 0x69A028BB3DED71A3ULL, // 5^81
+		0xA8ACD7C0222311BCULL, 0xC40832EA0D68CE0CULL, // 5^82
+		0xD2D80DB02AABD62BULL, 0xF50A3FA490C30190ULL, // 5^83
+		0x83C7088E1AAB65DBULL, 0x792667C6DA79E0FAULL, // 5^84
+		0xA4B8CAB1A1563F52ULL, 0x577001B891185938ULL, // 5^85
+		0xCDE6FD5E09ABCF26ULL, 0xED4C0226B55E6F86ULL, // 5^86
+		0x80B05E5AC60B6178ULL, 0x544F8158315B05B4ULL, // 5^87
+		0xA0DC75F1778E39D6ULL, 0x696361AE3DB1C721ULL, // 5^88
+		0xC913936DD571C84CULL, 0x03BC3A19CD1E38E9ULL, // 5^89
+		0xFB5878494ACE3A5FULL, 0x04AB48A04065C723ULL, // 5^90
+		0x9D174B2DCEC0E47BULL, 0x62EB0D64283F9C76ULL, // 5^91
+		0xC45D1DF942711D9AULL, 0x3BA5D0BD324F8394ULL, // 5^92
+		0xF5746577930D6500ULL, 0xCA8F44EC7EE36479ULL, // 5^93
+		0x9968BF6ABBE85F20ULL, 0x7E998B13CF4E1ECBULL, // 5^94
+		0xBFC2EF456AE276E8ULL, 0x9E3FEDD8C321A67EULL, // 5^95
+		0xEFB3AB16C59B14A2ULL, 0xC5CFE94EF3EA101EULL, // 5^96
+		0x95D04AEE3B80ECE5ULL, 0xBBA1F1D158724A12ULL, // 5^97
+		0xBB445DA9CA61281FULL, 0x2A8A6E45AE8EDC97ULL, // 5^98
+		0xEA1575143CF97226ULL, 0xF52D09D71A3293BDULL, // 5^99
+		0x924D692CA61BE758ULL, 0x593C2626705F9C56ULL, // 5^100
+		0xB6E0C377CFA2E12EULL, 0x6F8B2FB00C77836CULL, // 5^101
+		0xE498F455C38B997AULL, 0x0B6DFB9C0F956447ULL, // 5^102
+		0x8EDF98B59A373FECULL, 0x4724BD4189BD5EACULL, // 5^103
+		0xB2977EE300C50FE7ULL, 0x58EDEC91EC2CB657ULL, // 5^104
+		0xDF3D5E9BC0F653E1ULL, 0x2F2967B66737E3EDULL, // 5^105
+		0x8B865B215899F46CULL, 0xBD79E0D20082EE74ULL, // 5^106
+		0xAE67F1E9AEC07187ULL, 0xECD8590680A3AA11ULL, // 5^107
+		0xDA01EE641A708DE9ULL, 0xE80E6F4820CC9495ULL, // 5^108
+		0x884134FE908658B2ULL, 0x3109058D147FDCDDULL, // 5^109
+		0xAA51823E34A7EEDEULL, 0xBD4B46F0599FD415ULL, // 5^110
+		0xD4E5E2CDC1D1EA96ULL, 0x6C9E18AC7007C91AULL, // 5^111
+		0x850FADC09923329EULL, 0x03E2CF6BC604DDB0ULL, // 5^112
+		0xA6539930BF6BFF45ULL, 0x84DB8346B786151CULL, // 5^113
+		0xCFE87F7CEF46FF16ULL, 0xE612641865679A63ULL, // 5^114
+		0x81F14FAE158C5F6EULL, 0x4FCB7E8F3F60C07EULL, // 5^115
+		0xA26DA3999AEF7749ULL, 0xE3BE5E330F38F09DULL, // 5^116
+		0xCB090C8001AB551CULL, 0x5CADF5BFD3072CC5ULL, // 5^117
+		0xFDCB4FA002162A63ULL, 0x73D9732FC7C8F7F6ULL, // 5^118
+		0x9E9F11C4014DDA7EULL, 0x2867E7FDDCDD9AFAULL, // 5^119
+		0xC646D63501A1511DULL, 0xB281E1FD541501B8ULL, // 5^120
+		0xF7D88BC24209A565ULL, 0x1F225A7CA91A4226ULL, // 5^121
+		0x9AE757596946075FULL, 0x3375788DE9B06958ULL, // 5^122
+		0xC1A12D2FC3978937ULL, 0x0052D6B1641C83AEULL, // 5^123
+		0xF209787BB47D6B84ULL, 0xC0678C5DBD23A49AULL, // 5^124
+		0x9745EB4D50CE6332ULL, 0xF840B7BA963646E0ULL, // 5^125
+		0xBD176620A501FBFFULL, 0xB650E5A93BC3D898ULL, // 5^126
+		0xEC5D3FA8CE427AFFULL, 0xA3E51F138AB4CEBEULL, // 5^127
+		0x93BA47C980E98CDFULL, 0xC66F336C36B10137ULL, // 5^128
+		0xB8A8D9BBE123F017ULL, 0xB80B0047445D4184ULL, // 5^129
+		0xE6D3102AD96CEC1DULL, 0xA60DC059157491E5ULL, // 5^130
+		0x9043EA1AC7E41392ULL, 0x87C89837AD68DB2FULL, // 5^131
+		0xB454E4A179DD1877ULL, 0x29BABE4598C311FBULL, // 5^132
+		0xE16A1DC9D8545E94ULL, 0xF4296DD6FEF3D67AULL, // 5^133
+		0x8CE2529E2734BB1DULL, 0x1899E4A65F58660CULL, // 5^134
+		0xB01AE745B101E9E4ULL, 0x5EC05DCFF72E7F8FULL, // 5^135
+		0xDC21A1171D42645DULL, 0x76707543F4FA1F73ULL, // 5^136
+		0x899504AE72497EBAULL, 0x6A06494A791C53A8ULL, // 5^137
+		0xABFA45DA0EDBDE69ULL, 0x0487DB9D17636892ULL, // 5^138
+		0xD6F8D7509292D603ULL, 0x45A9D2845D3C42B6ULL, // 5^139
+		0x865B86925B9BC5C2ULL, 0x0B8A2392BA45A9B2ULL, // 5^140
+		0xA7F26836F282B732ULL, 0x8E6CAC7768D7141EULL, // 5^141
+		0xD1EF0244AF2364FFULL, 0x3207D795430CD926ULL, // 5^142
+		0x8335616AED761F1FULL, 0x7F44E6BD49E807B8ULL, // 5^143
+		0xA402B9C5A8D3A6E7ULL, 0x5F16206C9C6209A6ULL, // 5^144
+		0xCD036837130890A1ULL, 0x36DBA887C37A8C0FULL, // 5^145
+		0x802221226BE55A64ULL, 0xC2494954DA2C9789ULL, // 5^146
+		0xA02AA96B06DEB0FDULL, 0xF2DB9BAA10B7BD6CULL, // 5^147
+		0xC83553C5C8965D3DULL, 0x6F92829494E5ACC7ULL, // 5^148
+		0xFA42A8B73ABBF48CULL, 0xCB772339BA1F17F9ULL, // 5^149
+		0x9C69A97284B578D7ULL, 0xFF2A760414536EFBULL, // 5^150
+		0xC38413CF25E2D70DULL, 0xFEF5138519684ABAULL, // 5^151
+		0xF46518C2EF5B8CD1ULL, 0x7EB258665FC25D69ULL, // 5^152
+		0x98BF2F79D5993802ULL, 0xEF2F773FFBD97A61ULL, // 5^153
+		0xBEEEFB584AFF8603ULL, 0xAAFB550FFACFD8FAULL, // 5^154
+		0xEEAABA2E5DBF6784ULL, 0x95BA2A53F983CF38ULL, // 5^155
+		0x952AB45CFA97A0B2ULL, 0xDD945A747BF26183ULL, // 5^156
+		0xBA756174393D88DFULL, 0x94F971119AEEF9E4ULL, // 5^157
+		0xE912B9D1478CEB17ULL, 0x7A37CD5601AAB85DULL, // 5^158
+		0x91ABB422CCB812EEULL, 0xAC62E055C10AB33AULL, // 5^159
+		0xB616A12B7FE617AAULL, 0x577B986B314D6009ULL, // 5^160
+		0xE39C49765FDF9D94ULL, 0xED5A7E85FDA0B80BULL, // 5^161
+		0x8E41ADE9FBEBC27DULL, 0x14588F13BE847307ULL, // 5^162
+		0xB1D219647AE6B31CULL, 0x596EB2D8AE258FC8ULL, // 5^163
+		0xDE469FBD99A05FE3ULL, 0x6FCA5F8ED9AEF3BBULL, // 5^164
+		0x8AEC23D680043BEEULL, 0x25DE7BB9480D5854ULL, // 5^165
+		0xADA72CCC20054AE9ULL, 0xAF561AA79A10AE6AULL, // 5^166
+		0xD910F7FF28069DA4ULL, 0x1B2BA1518094DA04ULL, // 5^167
+		0x87AA9AFF79042286ULL, 0x90FB44D2F05D0842ULL, // 5^168
+		0xA99541BF57452B28ULL, 0x353A1607AC744A53ULL, // 5^169
+		0xD3FA922F2D1675F2ULL, 0x42889B8997915CE8ULL, // 5^170
+		0x847C9B5D7C2E09B7ULL, 0x69956135FEBADA11ULL, // 5^171
+		0xA59BC234DB398C25ULL, 0x43FAB9837E699095ULL, // 5^172
+		0xCF02B2C21207EF2EULL, 0x94F967E45E03F4BBULL, // 5^173
+		0x8161AFB94B44F57DULL, 0x1D1BE0EEBAC278F5ULL, // 5^174
+		0xA1BA1BA79E1632DCULL, 0x6462D92A69731732ULL, // 5^175
+		0xCA28A291859BBF93ULL, 0x7D7B8F7503CFDCFEULL, // 5^176
+		0xFCB2CB35E702AF78ULL, 0x5CDA735244C3D43EULL, // 5^177
+		0x9DEFBF01B061ADABULL, 0x3A0888136AFA64A7ULL, // 5^178
+		0xC56BAEC21C7A1916ULL, 0x088AAA1845B8FDD0ULL, // 5^179
+		0xF6C69A72A3989F5BULL, 0x8AAD549E57273D45ULL, // 5^180
+		0x9A3C2087A63F6399ULL, 0x36AC54E2F678864BULL, // 5^181
+		0xC0CB28A98FCF3C7FULL, 0x84576A1BB416A7DDULL, // 5^182
+		0xF0FDF2D3F3C30B9FULL, 0x656D44A2A11C51D5ULL, // 5^183
+		0x969EB7C47859E743ULL, 0x9F644AE5A4B1B325ULL, // 5^184
+		0xBC4665B596706114ULL, 0x873D5D9F0DDE1FEEULL, // 5^185
+		0xEB57FF22FC0C7959ULL, 0xA90CB506D155A7EAULL, // 5^186
+		0x9316FF75DD87CBD8ULL, 0x09A7F12442D588F2ULL, // 5^187
+		0xB7DCBF5354E9BECEULL, 0x0C11ED6D538AEB2FULL, // 5^188
+		0xE5D3EF282A242E81ULL, 0x8F1668C8A86DA5FAULL, // 5^189
+		0x8FA475791A569D10ULL, 0xF96E017D694487BCULL, // 5^190
+		0xB38D92D760EC4455ULL, 0x37C981DCC395A9ACULL, // 5^191
+		0xE070F78D3927556AULL, 0x85BBE253F47B1417ULL, // 5^192
+		0x8C469AB843B89562ULL, 0x93956D7478CCEC8EULL, // 5^193
+		0xAF58416654A6BABBULL, 0x387AC8D1970027B2ULL, // 5^194
+		0xDB2E51BFE9D0696AULL, 0x06997B05FCC0319EULL, // 5^195
+		0x88FCF317F22241E2ULL, 0x441FECE3BDF81F03ULL, // 5^196
+		0xAB3C2FDDEEAAD25AULL, 0xD527E81CAD7626C3ULL, // 5^197
+		0xD60B3BD56A5586F1ULL, 0x8A71E223D8D3B074ULL, // 5^198
+		0x85C7056562757456ULL, 0xF6872D5667844E49ULL, // 5^199
+		0xA738C6BEBB12D16CULL, 0xB428F8AC016561DBULL, // 5^200
+		0xD106F86E69D785C7ULL, 0xE13336D701BEBA52ULL, // 5^201
+		0x82A45B450226B39CULL, 0xECC0024661173473ULL, // 5^202
+		0xA34D721642B06084ULL, 0x27F002D7F95D0190ULL, // 5^203
+		0xCC20CE9BD35C78A5ULL, 0x31EC038DF7B441F4ULL, // 5^204
+		0xFF290242C83396CEULL, 0x7E67047175A15271ULL, // 5^205
+		0x9F79A169BD203E41ULL, 0x0F0062C6E984D386ULL, // 5^206
+		0xC75809C42C684DD1ULL, 0x52C07B78A3E60868ULL, // 5^207
+		0xF92E0C3537826145ULL, 0xA7709A56CCDF8A82ULL, // 5^208
+		0x9BBCC7A142B17CCBULL, 0x88A66076400BB691ULL, // 5^209
+		0xC2ABF989935DDBFEULL, 0x6ACFF893D00EA435ULL, // 5^210
+		0xF356F7EBF83552FEULL, 0x0583F6B8C4124D43ULL, // 5^211
+		0x98165AF37B2153DEULL, 0xC3727A337A8B704AULL, // 5^212
+		0xBE1BF1B059E9A8D6ULL, 0x744F18C0592E4C5CULL, // 5^213
+		0xEDA2EE1C7064130CULL, 0x1162DEF06F79DF73ULL, // 5^214
+		0x9485D4D1C63E8BE7ULL, 0x8ADDCB5645AC2BA8ULL, // 5^215
+		0xB9A74A0637CE2EE1ULL, 0x6D953E2BD7173692ULL, // 5^216
+		0xE8111C87C5C1BA99ULL, 0xC8FA8DB6CCDD0437ULL, // 5^217
+		0x910AB1D4DB9914A0ULL, 0x1D9C9892400A22A2ULL, // 5^218
+		0xB54D5E4A127F59C8ULL, 0x2503BEB6D00CAB4BULL, // 5^219
+		0xE2A0B5DC971F303AULL, 0x2E44AE64840FD61DULL, // 5^220
+		0x8DA471A9DE737E24ULL, 0x5CEAECFED289E5D2ULL, // 5^221
+		0xB10D8E1456105DADULL, 0x7425A83E872C5F47ULL, // 5^222
+		0xDD50F1996B947518ULL, 0xD12F124E28F77719ULL, // 5^223
+		0x8A5296FFE33CC92FULL, 0x82BD6B70D99AAA6FULL, // 5^224
+		0xACE73CBFDC0BFB7BULL, 0x636CC64D1001550BULL, // 5^225
+		0xD8210BEFD30EFA5AULL, 0x3C47F7E05401AA4EULL, // 5^226
+		0x8714A775E3E95C78ULL, 0x65ACFAEC34810A71ULL, // 5^227
+		0xA8D9D1535CE3B396ULL, 0x7F1839A741A14D0DULL, // 5^228
+		0xD31045A8341CA07CULL, 0x1EDE48111209A050ULL, // 5^229
+		0x83EA2B892091E44DULL, 0x934AED0AAB460432ULL, // 5^230
+		0xA4E4B66B68B65D60ULL, 0xF81DA84D5617853FULL, // 5^231
+		0xCE1DE40642E3F4B9ULL, 0x36251260AB9D668EULL, // 5^232
+		0x80D2AE83E9CE78F3ULL, 0xC1D72B7C6B426019ULL, // 5^233
+		0xA1075A24E4421730ULL, 0xB24CF65B8612F81FULL, // 5^234
+		0xC94930AE1D529CFCULL, 0xDEE033F26797B627ULL, // 5^235
+		0xFB9B7CD9A4A7443CULL, 0x169840EF017DA3B1ULL, // 5^236
+		0x9D412E0806E88AA5ULL, 0x8E1F289560EE864EULL, // 5^237
+		0xC491798A08A2AD4EULL, 0xF1A6F2BAB92A27E2ULL, // 5^238
+		0xF5B5D7EC8ACB58A2ULL, 0xAE10AF696774B1DBULL, // 5^239
+		0x9991A6F3D6BF1765ULL, 0xACCA6DA1E0A8EF29ULL, // 5^240
+		0xBFF610B0CC6EDD3FULL, 0x17FD090A58D32AF3ULL, // 5^241
+		0xEFF394DCFF8A948EULL, 0xDDFC4B4CEF07F5B0ULL, // 5^242
+		0x95F83D0A1FB69CD9ULL, 0x4ABDAF101564F98EULL, // 5^243
+		0xBB764C4CA7A4440FULL, 0x9D6D1AD41ABE37F1ULL, // 5^244
+		0xEA53DF5FD18D5513ULL, 0x84C86189216DC5EDULL, // 5^245
+		0x92746B9BE2F8552CULL, 0x32FD3CF5B4E49BB4ULL, // 5^246
+		0xB7118682DBB66A77ULL, 0x3FBC8C33221DC2A1ULL, // 5^247
+		0xE4D5E82392A40515ULL, 0x0FABAF3FEAA5334AULL, // 5^248
+		0x8F05B1163BA6832DULL, 0x29CB4D87F2A7400EULL, // 5^249
+		0xB2C71D5BCA9023F8ULL, 0x743E20E9EF511012ULL, // 5^250
+		0xDF78E4B2BD342CF6ULL, 0x914DA9246B255416ULL, // 5^251
+		0x8BAB8EEFB6409C1AULL, 0x1AD089B6C2F7548EULL, // 5^252
+		0xAE9672ABA3D0C320ULL, 0xA184AC2473B529B1ULL, // 5^253
+		0xDA3C0F568CC4F3E8ULL, 0xC9E5D72D90A2741EULL, // 5^254
+		0x8865899617FB1871ULL, 0x7E2FA67C7A658892ULL, // 5^255
+		0xAA7EEBFB9DF9DE8DULL, 0xDDBB901B98FEEAB7ULL, // 5^256
+		0xD51EA6FA85785631ULL, 0x552A74227F3EA565ULL, // 5^257
+		0x8533285C936B35DEULL, 0xD53A88958F87275FULL, // 5^258
+		0xA67FF273B8460356ULL, 0x8A892ABAF368F137ULL, // 5^259
+		0xD01FEF10A657842CULL, 0x2D2B7569B0432D85ULL, // 5^260
+		0x8213F56A67F6B29BULL, 0x9C3B29620E29FC73ULL, // 5^261
+		0xA298F2C501F45F42ULL, 0x8349F3BA91B47B8FULL, // 5^262
+		0xCB3F2F7642717713ULL, 0x241C70A936219A73ULL, // 5^263
+		0xFE0EFB53D30DD4D7ULL, 0xED238CD383AA0110ULL, // 5^264
+		0x9EC95D1463E8A506ULL, 0xF4363804324A40AAULL, // 5^265
+		0xC67BB4597CE2CE48ULL, 0xB143C6053EDCD0D5ULL, // 5^266
+		0xF81AA16FDC1B81DAULL, 0xDD94B7868E94050AULL, // 5^267
+		0x9B10A4E5E9913128ULL, 0xCA7CF2B4191C8326ULL, // 5^268
+		0xC1D4CE1F63F57D72ULL, 0xFD1C2F611F63A3F0ULL, // 5^269
+		0xF24A01A73CF2DCCFULL, 0xBC633B39673C8CECULL, // 5^270
+		0x976E41088617CA01ULL, 0xD5BE0503E085D813ULL, // 5^271
+		0xBD49D14AA79DBC82ULL, 0x4B2D8644D8A74E18ULL, // 5^272
+		0xEC9C459D51852BA2ULL, 0xDDF8E7D60ED1219EULL, // 5^273
+		0x93E1AB8252F33B45ULL, 0xCABB90E5C942B503ULL, // 5^274
+		0xB8DA1662E7B00A17ULL, 0x3D6A751F3B936243ULL, // 5^275
+		0xE7109BFBA19C0C9DULL, 0x0CC512670A783AD4ULL, // 5^276
+		0x906A617D450187E2ULL, 0x27FB2B80668B24C5ULL, // 5^277
+		0xB484F9DC9641E9DAULL, 0xB1F9F660802DEDF6ULL, // 5^278
+		0xE1A63853BBD26451ULL, 0x5E7873F8A0396973ULL, // 5^279
+		0x8D07E33455637EB2ULL, 0xDB0B487B6423E1E8ULL, // 5^280
+		0xB049DC016ABC5E5FULL, 0x91CE1A9A3D2CDA62ULL, // 5^281
+		0xDC5C5301C56B75F7ULL, 0x7641A140CC7810FBULL, // 5^282
+		0x89B9B3E11B6329BAULL, 0xA9E904C87FCB0A9DULL, // 5^283
+		0xAC2820D9623BF429ULL, 0x546345FA9FBDCD44ULL, // 5^284
+		0xD732290FBACAF133ULL, 0xA97C177947AD4095ULL, // 5^285
+		0x867F59A9D4BED6C0ULL, 0x49ED8EABCCCC485DULL, // 5^286
+		0xA81F301449EE8C70ULL, 0x5C68F256BFFF5A74ULL, // 5^287
+		0xD226FC195C6A2F8CULL, 0x73832EEC6FFF3111ULL, // 5^288
+		0x83585D8FD9C25DB7ULL, 0xC831FD53C5FF7EABULL, // 5^289
+		0xA42E74F3D032F525ULL, 0xBA3E7CA8B77F5E55ULL, // 5^290
+		0xCD3A1230C43FB26FULL, 0x28CE1BD2E55F35EBULL, // 5^291
+		0x80444B5E7AA7CF85ULL, 0x7980D163CF5B81B3ULL, // 5^292
+		0xA0555E361951C366ULL, 0xD7E105BCC332621FULL, // 5^293
+		0xC86AB5C39FA63440ULL, 0x8DD9472BF3FEFAA7ULL, // 5^294
+		0xFA856334878FC150ULL, 0xB14F98F6F0FEB951ULL, // 5^295
+		0x9C935E00D4B9D8D2ULL, 0x6ED1BF9A569F33D3ULL, // 5^296
+		0xC3B8358109E84F07ULL, 0x0A862F80EC4700C8ULL, // 5^297
+		0xF4A642E14C6262C8ULL, 0xCD27BB612758C0FAULL, // 5^298
+		0x98E7E9CCCFBD7DBDULL, 0x8038D51CB897789CULL, // 5^299
+		0xBF21E44003ACDD2CULL, 0xE0470A63E6BD56C3ULL, // 5^300
+		0xEEEA5D5004981478ULL, 0x1858CCFCE06CAC74ULL, // 5^301
+		0x95527A5202DF0CCBULL, 0x0F37801E0C43EBC8ULL, // 5^302
+		0xBAA718E68396CFFDULL, 0xD30560258F54E6BAULL, // 5^303
+		0xE950DF20247C83FDULL, 0x47C6B82EF32A2069ULL, // 5^304
+		0x91D28B7416CDD27EULL, 0x4CDC331D57FA5441ULL, // 5^305
+		0xB6472E511C81471DULL, 0xE0133FE4ADF8E952ULL, // 5^306
+		0xE3D8F9E563A198E5ULL, 0x58180FDDD97723A6ULL, // 5^307
+		0x8E679C2F5E44FF8FULL, 0x570F09EAA7EA7648ULL, // 5^308
+	};
+
+	return powers_of_five + (2 * (q + 342));
+}
+// Compute the binary float nearest to w * 10^q. Returns false if the rounding can not be decided with 128 bits.
+bool text_file_eisel_lemire(u64* bits, u64 w, i64 q, const text_file_float_layout* layout)
+{
+	if (w == 0 || q < layout->smallest_power_of_ten)
+	{
+		*bits = 0;
+		return true; // Zero
+	}
+	if (q > layout->largest_power_of_ten)
+	{
+		*bits = (u64)layout->infinite_power << layout->mantissa_bits;
+		return true; // Infinity
+	}
+
+	i32 leading_zeros = 64 - text_file_bit_length(w);
+	w <<= leading_zeros;
+
+	// The high 64 bits of w * 5^q. The second half of the power is only needed if the low bits of the first product are all ones.
+	const u64* power = text_file_power_of_five(q);
+	u64 high, low;
+	text_file_mul128(w, power[0], &high, &low);
+	u64 precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (layout->mantissa_bits + 3);
+	if ((high & precision_mask) == precision_mask)
+	{
+		u64 second_high, second_low;
+		text_file_mul128(w, power[1], &second_high, &second_low);
+		low += second_high;
+		if (second_high > low)
+			high++;
+	}
+	if (low == 0xFFFFFFFFFFFFFFFFULL && (q < -27 || q > 55))
+		return false; // The truncated power of five might not be precise enough here
+
+	i32 upper_bit = (i32)(high >> 63);
+	i32 shift = upper_bit + 64 - layout->mantissa_bits - 3;
+	u64 mantissa = high >> shift;
+	// power(q) = floor(q * log2(10)) + 63
+	i32 power2 = (i32)((((152170 + 65536) * q) >> 16) + 63) + upper_bit - leading_zeros - layout->minimum_exponent;
+
+	if (power2 <= 0)
+	{
+		// Subnormal
+		if (-power2 + 1 >= 64)
+		{
+			*bits = 0;
+			return true; // Zero
+		}
+		mantissa >>= -power2 + 1;
+		mantissa += (mantissa & 1); // Round up
+		mantissa >>= 1;
+		power2 = (mantissa < (1ULL << layout->mantissa_bits)) ? 0 : 1;
+		*bits = (mantissa & ((1ULL << layout->mantissa_bits) - 1)) | ((u64)power2 << layout->mantissa_bits);
+		return true;
+	}
+
+	// Round half up, except exactly half way where it must round to even
+	if (low <= 1 && q >= layout->min_round_to_even && q <= layout->max_round_to_even && (mantissa & 3) == 1)
+	{
+		if ((mantissa << shift) == high)
+			mantissa &= ~1ULL;
+	}
+	mantissa += (mantissa & 1);
+	mantissa >>= 1;
+	if (mantissa >= (2ULL << layout->mantissa_bits))
+	{
+		mantissa = 1ULL << layout->mantissa_bits;
+		power2++;
+	}
+	mantissa &= ~(1ULL << layout->mantissa_bits);
+	if (power2 >= layout->infinite_power)
+	{
+		power2 = layout->infinite_power;
+		mantissa = 0;
+	}
+
+	*bits = mantissa | ((u64)power2 << layout->mantissa_bits);
+
+	return true;
+}
+// Compare 'text' with a lower case word ignoring case
+bool text_file_match_word(const c8* text, i64 length, const char* word)
+{
+	i64 i = 0;
+	for (; word[i] != '\0'; i++)
+	{
+		if (i >= length || (text[i] | 0x20) != (c8)word[i])
+			return false;
+	}
+	return true;
+}
+// Split decimal float text into its parts. Leading white space is skipped like sscanf(..) does.
+// Returns the number of chars used, 0 if it is not a number, or -1 for text that only strtod(..) understands (hex, inf, nan).
+i64 text_file_scan_decimal(text_file_decimal* decimal, const c8* text, i64 length)
+{
+	i64 i = 0;
+	while (i < length && text_file_is_space(text[i]))
+		i++;
+
+	memset(decimal, 0, sizeof(text_file_decimal));
+	if (i < length && (text[i] == '-' || text[i] == '+'))
+	{
+		decimal->negative = (text[i] == '-');
+		i++;
+	}
+	if (i < length && (text[i] == 'i' || text[i] == 'I' || text[i] == 'n' || text[i] == 'N'))
+		return -1; // inf or nan
+	if (i + 1 < length && text[i] == '0' && (text[i + 1] == 'x' || text[i + 1] == 'X'))
+		return -1; // Hexadecimal float
+
+	i32 digits = 0;		// Significant digits kept in 'w'
+	bool any_digits = false;
+
+	// Integral part
+	for (; i < length && (u8)(text[i] - '0') <= 9; i++)
+	{
+		u64 digit = text[i] - '0';
+		any_digits = true;
+		if (decimal->w == 0 && digit == 0)
+			continue; // Leading zero
+		if (digits < 19)
+		{
+			decimal->w = (decimal->w * 10) + digit;
+			digits++;
+		}
+		else
+		{
+			decimal->q++;
+			decimal->truncated |= (digit != 0);
+		}
+	}
+
+	// Fractional part
+	if (i < length && text[i] == '.')
+	{
+		i++;
+		for (; i < length && (u8)(text[i] - '0') <= 9; i++)
+		{
+			u64 digit = text[i] - '0';
+			any_digits = true;
+			if (decimal->w == 0 && digit == 0)
+			{
+				decimal->q--; // Leading zero
+				continue;
+			}
+			if (digits < 19)
+			{
+				decimal->w = (decimal->w * 10) + digit;
+				digits++;
+				decimal->q--;
+			}
+			else
+			{
+				decimal->truncated |= (digit != 0);
+			}
+		}
+	}
+	if (!any_digits)
+		return 0; // Not a number
+
+	// Exponent. An 'e' without digits is not part of the number.
+	if (i < length && (text[i] == 'e' || text[i] == 'E'))
+	{
+		i64 j = i + 1;
+		bool negative_exponent = false;
+		if (j < length && (text[j] == '-' || text[j] == '+'))
+		{
+			negative_exponent = (text[j] == '-');
+			j++;
+		}
+		if (j < length && (u8)(text[j] - '0') <= 9)
+		{
+			i64 exponent = 0;
+			for (; j < length && (u8)(text[j] - '0') <= 9; j++)
+			{
+				if (exponent < 100000) // Saturate, anything this large is zero or infinity anyway
+					exponent = (exponent * 10) + (text[j] - '0');
+			}
+			decimal->q += negative_exponent ? -exponent : exponent;
+			i = j;
+		}
+	}
+
+	return i;
+}
+// Parse the token with strtod(..)/strtof(..) from a null terminated copy. Used for the rare cases the fast paths do not cover.
+// The copy holds the whole token however long it is: on the stack up to 511 chars, from malloc(..) above that.
+bool text_file_parse_float_fallback(f64* value, bool single, const c8* text, i64 length, i64* consumed)
+{
+	// The token ends at the first char that strtod(..) never takes: anything but white space before it, digits, letters
+	// and ".+-()_" (the last three for "nan(chars)")
+	i64 token = 0;
+	while (token < length && text_file_is_space(text[token]))
+		token++;
+	for (; token < length; token++)
+	{
+		c8 c = text[token];
+		if ((u8)(c - '0') > 9 && (u8)((c | 0x20) - 'a') >= 26 && c != '.' && c != '+' && c != '-' && c != '(' && c != ')' && c != '_')
+			break;
+	}
+
+	char stack[512];
+	char* copy = stack;
+	if (token >= (i64)sizeof(stack))
+	{
+		copy = (char*)malloc(token + 1);
+		if (copy == NULL)
+			return false; // Failed to allocate memory
+	}
+	memcpy(copy, text, token);
+	copy[token] = '\0';
+
+	char* end = NULL;
+	*value = single ? (f64)strtof(copy, &end) : strtod(copy, &end);
+	bool ok = (end != copy);
+	if (ok && consumed != NULL)
+		*consumed = end - copy;
+
+	if (copy != stack)
+		free(copy);
+
+	return ok;
+}
+// Parse decimal text as an 'f64', correctly rounded. Leading white space is skipped and parsing stops at the first char
+// that is not part of the number, like sscanf(..) does. 'consumed' (optional) is set to the number of chars used.
+bool text_file_parse_f64(f64* value, const c8* text, i64 length, i64* consumed)
+{
+	static const f64 exact_powers_of_10[23] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	static const text_file_float_layout layout = { 52, -1023, 0x7FF, -342, 308, -4, 23 };
+
+	text_file_decimal decimal;
+	i64 used = text_file_scan_decimal(&decimal, text, length);
+	if (used == 0)
+		return false; // Not a number
+	if (used < 0)
+		return text_file_parse_float_fallback(value, false, text, length, consumed);
+
+	// Clinger's fast path: w and 10^q are both exact doubles, so one multiplication or division rounds correctly
+	if (!decimal.truncated && decimal.w <= (1ULL << 53) && decimal.q >= -22 && decimal.q <= 22)
+	{
+		f64 result = (f64)decimal.w;
+		result = (decimal.q < 0) ? result / exact_powers_of_10[-decimal.q] : result * exact_powers_of_10[decimal.q];
+		*value = decimal.negative ? -result : result;
+		if (consumed != NULL)
+			*consumed = used;
+		return true; // Success
+	}
+
+	u64 bits = 0;
+	bool exact = text_file_eisel_lemire(&bits, decimal.w, decimal.q, &layout);
+	if (exact && decimal.truncated)
+	{
+		// The true value is between w and w + 1, both must round to the same float
+		u64 upper_bits = 0;
+		exact = text_file_eisel_lemire(&upper_bits, decimal.w + 1, decimal.q, &layout) && upper_bits == bits;
+	}
+	if (!exact)
+		return text_file_parse_float_fallback(value, false, text, used, consumed);
+
+	bits |= (u64)decimal.negative << 63;
+	memcpy(value, &bits, sizeof(bits));
+	if (consumed != NULL)
+		*consumed = used;
+
+	return true; // Success
+}
+// Parse decimal text as an 'f32', correctly rounded. Leading white space is skipped and parsing stops at the first char
+// that is not part of the number, like sscanf(..) does. 'consumed' (optional) is set to the number of chars used.
+bool text_file_parse_f32(f32* value, const c8* text, i64 length, i64* consumed)
+{
+	static const f32 exact_powers_of_10[11] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	static const text_file_float_layout layout = { 23, -127, 0xFF, -65, 38, -17, 10 };
+
+	text_file_decimal decimal;
+	i64 used = text_file_scan_decimal(&decimal, text, length);
+	if (used == 0)
+		return false; // Not a number
+	if (used < 0)
+	{
+		f64 result = 0;
+		if (!text_file_parse_float_fallback(&result, true, text, length, consumed))
+			return false; // Not a number
+		*value = (f32)result;
+		return true; // Success
+	}
+
+	// Clinger's fast path with float precision
+	if (!decimal.truncated && decimal.w <= (1ULL << 24) && decimal.q >= -10 && decimal.q <= 10)
+	{
+		f32 result = (f32)decimal.w;
+		result = (decimal.q < 0) ? result / exact_powers_of_10[-decimal.q] : result * exact_powers_of_10[decimal.q];
+		*value = decimal.negative ? -result : result;
+		if (consumed != NULL)
+			*consumed = used;
+		return true; // Success
+	}
+
+	u64 bits = 0;
+	bool exact = text_file_eisel_lemire(&bits, decimal.w, decimal.q, &layout);
+	if (exact && decimal.truncated)
+	{
+		u64 upper_bits = 0;
+		exact = text_file_eisel_lemire(&upper_bits, decimal.w + 1, decimal.q, &layout) && upper_bits == bits;
+	}
+	if (!exact)
+	{
+		f64 result = 0;
+		if (!text_file_parse_float_fallback(&result, true, text, used, consumed))
+			return false; // Not a number
+		*value = (f32)result;
+		return true; // Success
+	}
+
+	u32 float_bits = (u32)bits | ((u32)decimal.negative << 31);
+	memcpy(value, &float_bits, sizeof(float_bits));
+	if (consumed != NULL)
+		*consumed = used;
+
+	return true; // Success
+}
+
+//
+// Implementations: Byte scanning
+//
+
+// Get the index of the lowest set bit of a non-zero mask
+u32 text_file_trailing_zeros(u32 mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (u32)index;
+#else
+	return (u32)__builtin_ctz(mask);
+#endif
+}
+// Get the index of the lowest set bit of a non-zero 64-bit mask
+u32 text_file_trailing_zeros_u64(u64 mask)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+	unsigned long index;
+	_BitScanForward64(&index, mask);
+	return (u32)index;
+#elif defined(_MSC_VER)
+	return ((u32)mask != 0) ? text_file_trailing_zeros((u32)mask) : 32 + text_file_trailing_zeros((u32)(mask >> 32));
+#else
+	return (u32)__builtin_ctzll(mask);
+#endif
+}
+// Get the running xor of a mask: bit i is the xor of bits 0 to i. Turns a mask of quotes into a mask of what is inside them.
+u64 text_file_prefix_xor(u64 mask)
+{
+	mask ^= mask << 1;
+	mask ^= mask << 2;
+	mask ^= mask << 4;
+	mask ^= mask << 8;
+	mask ^= mask << 16;
+	mask ^= mask << 32;
+	return mask;
+}
+// Find the first 'value' in 'data'. Compares 32 (AVX2) or 16 (SSE2) bytes at a time. Returns -1 if it is not found.
+i64 text_file_find_byte(const byte* data, i64 length, byte value)
+{
+	i64 i = 0;
+
+#if TEXT_FILE_AVX2
+	__m256i needle32 = _mm256_set1_epi8((char)value);
+	for (; i + 32 <= length; i += 32)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+		u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle32));
+		if (mask != 0)
+			return i + text_file_trailing_zeros(mask);
+	}
+#endif
+#if TEXT_FILE_SSE2
+	__m128i needle16 = _mm_set1_epi8((char)value);
+	for (; i + 16 <= length; i += 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+		u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle16));
+		if (mask != 0)
+			return i + text_file_trailing_zeros(mask);
+	}
+#endif
+	for (; i < length; i++)
+	{
+		if (data[i] == value)
+			return i;
+	}
+
+	return -1; // Not found
+}
+// Find the last 'value' in 'data'. Compares 32 (AVX2) or 16 (SSE2) bytes at a time. Returns -1 if it is not found.
+i64 text_file_find_last_byte(const byte* data, i64 length, byte value)
+{
+	i64 i = length;
+
+#if TEXT_FILE_AVX2
+	__m256i needle32 = _mm256_set1_epi8((char)value);
+	for (; i >= 32; i -= 32)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i*)(data + i - 32));
+		u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle32));
+		if (mask != 0)
+			return i - 32 + (text_file_bit_length(mask) - 1);
+	}
+#endif
+#if TEXT_FILE_SSE2
+	__m128i needle16 = _mm_set1_epi8((char)value);
+	for (; i >= 16; i -= 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)(data + i - 16));
+		u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle16));
+		if (mask != 0)
+			return i - 16 + (text_file_bit_length(mask) - 1);
+	}
+#endif
+	while (i > 0)
+	{
+		i--;
+		if (data[i] == value)
+			return i;
+	}
+
+	return -1; // Not found
+}
+// Count the 'value' bytes in 'data'. Compares 32 (AVX2) or 16 (SSE2) bytes at a time and sums the matches in byte
+// counters, which are added up every 255 blocks before they can overflow.
+i64 text_file_count_byte(const byte* data, i64 length, byte value)
+{
+	i64 count = 0;
+	i64 i = 0;
+
+#if TEXT_FILE_AVX2
+	__m256i needle32 = _mm256_set1_epi8((char)value);
+	while (i + 32 <= length)
+	{
+		__m256i counters = _mm256_setzero_si256();
+		for (i32 blocks = 0; blocks < 255 && i + 32 <= length; blocks++, i += 32)
+			counters = _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), needle32));
+		__m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+		count += _mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) + _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3);
+	}
+#endif
+#if TEXT_FILE_SSE2
+	__m128i needle16 = _mm_set1_epi8((char)value);
+	while (i + 16 <= length)
+	{
+		__m128i counters = _mm_setzero_si128();
+		for (i32 blocks = 0; blocks < 255 && i + 16 <= length; blocks++, i += 16)
+			counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), needle16));
+		__m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+		count += _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+	}
+#endif
+	for (; i < length; i++)
+		count += (data[i] == value);
+
+	return count;
+}
+// Find the first 'pattern' in 'data'. Blocks of 32 (AVX2) or 16 (SSE2) positions are compared against the first and the
+// last byte of the pattern at once, and only positions where both match are compared in full. Returns -1 if it is not found.
+i64 text_file_find_pattern(const c8* data, i64 length, const c8* pattern, i64 pattern_length)
+{
+	if (pattern_length <= 0 || pattern_length > length)
+		return -1; // Not found
+	if (pattern_length == 1)
+		return text_file_find_byte(data, length, pattern[0]);
+
+	i64 last = pattern_length - 1;
+	i64 i = 0;
+
+#if TEXT_FILE_AVX2
+	__m256i first32 = _mm256_set1_epi8((char)pattern[0]);
+	__m256i last32 = _mm256_set1_epi8((char)pattern[last]);
+	for (; i + last + 32 <= length; i += 32)
+	{
+		__m256i block_first = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i)), first32);
+		__m256i block_last = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(data + i + last)), last32);
+		u32 mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(block_first, block_last));
+		while (mask != 0)
+		{
+			i64 position = i + text_file_trailing_zeros(mask);
+			if (memcmp(data + position + 1, pattern + 1, last - 1) == 0)
+				return position;
+			mask &= mask - 1;
+		}
+	}
+#endif
+#if TEXT_FILE_SSE2
+	__m128i first16 = _mm_set1_epi8((char)pattern[0]);
+	__m128i last16 = _mm_set1_epi8((char)pattern[last]);
+	for (; i + last + 16 <= length; i += 16)
+	{
+		__m128i block_first = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i)), first16);
+		__m128i block_last = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + i + last)), last16);
+		u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(block_first, block_last));
+		while (mask != 0)
+		{
+			i64 position = i + text_file_trailing_zeros(mask);
+			if (memcmp(data + position + 1, pattern + 1, last - 1) == 0)
+				return position;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	for (; i + last < length; i++)
+	{
+		if (data[i] == pattern[0] && data[i + last] == pattern[last] && memcmp(data + i + 1, pattern + 1, last - 1) == 0)
+			return i;
+	}
+
+	return -1; // Not found
+}
+
+//
+// Implementations: Line reader
+//
+
+// Open a text file for reading one line at a time. 'buffer_size' is the size of the internal buffer,
+// or 0 for TEXT_FILE_LINE_BUFFER. The buffer is allocated here and released by text_file_close_lines(..).
+bool text_file_openfor_read_lines(text_file_line_reader* reader, str filename, i64 buffer_size)
+{
+	memset(reader, 0, sizeof(text_file_line_reader));
+	reader->capacity = (buffer_size > 0) ? buffer_size : TEXT_FILE_LINE_BUFFER;
+
+	// Binary mode so that \r\n and \n are both seen and handled the same on every platform
+	reader->file = fopen((const char*)filename, "rb");
+	if (reader->file == NULL)
+		return false; // The file does not exist
+
+	// The reader does its own buffering, so the stdio buffer would only add a copy
+	setvbuf(reader->file, NULL, _IONBF, 0);
+
+	reader->buffer = (c8*)malloc(reader->capacity);
+	if (reader->buffer == NULL)
+	{
+		text_file_close(reader->file);
+		reader->file = NULL;
+		return false; // Failed to allocate memory
+	}
+
+	return true; // Success
+}
+// Read the next line. 'line' is set to point into the reader's buffer and 'length' to the length of the line
+// without the "\r\n" or "\n". The line stays valid until the next call. Returns false at the end of the file or on error.
+bool text_file_read_line(c8** line, i64* length, text_file_line_reader* reader)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_LINE, reader->file);
+	i64 scanned = reader->start; // Everything before this has been searched for a newline already
+
+	for (;;)
+	{
+		i64 found = text_file_find_byte(reader->buffer + scanned, reader->end - scanned, '\n');
+		if (found >= 0)
+		{
+			i64 newline = scanned + found;
+			*line = reader->buffer + reader->start;
+			*length = newline - reader->start;
+			if (*length > 0 && (*line)[*length - 1] == '\r')
+				(*length)--;
+			reader->start = newline + 1;
+			return true; // Success
+		}
+
+		if (reader->eof)
+		{
+			if (reader->start == reader->end)
+				return false; // End of the file
+
+			// The last line has no newline
+			*line = reader->buffer + reader->start;
+			*length = reader->end - reader->start;
+			reader->start = reader->end;
+			return true; // Success
+		}
+
+		// Move the partial line to the front of the buffer, or grow the buffer if the line fills all of it
+		if (reader->start > 0)
+		{
+			memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+			reader->end -= reader->start;
+			reader->start = 0;
+		}
+		else if (reader->end == reader->capacity)
+		{
+			c8* buffer = (c8*)realloc(reader->buffer, reader->capacity * 2);
+			if (buffer == NULL)
+				return false; // Failed to allocate memory
+			reader->buffer = buffer;
+			reader->capacity *= 2;
+		}
+		scanned = reader->end;
+
+		// Refill
+		i64 bytes = text_file_io_read(reader->buffer + reader->end, sizeof(char), reader->capacity - reader->end, reader->file);
+		if (bytes == 0)
+		{
+			if (ferror(reader->file) != 0)
+				return false; // Error reading file
+			reader->eof = true;
+		}
+		reader->end += bytes;
+	}
+}
+// Close a line reader and release its buffer
+void text_file_close_lines(text_file_line_reader* reader)
+{
+	if (reader->file != NULL)
+		text_file_close(reader->file);
+	free(reader->buffer);
+
+	memset(reader, 0, sizeof(text_file_line_reader));
+}
+
+//
+// Implementations: Reverse line reader
+//
+
+// Open a text file for reading its lines from the last to the first. 'buffer_size' is the size of the internal buffer
+// and of the blocks read from the file, or 0 for TEXT_FILE_REVERSE_LINE_BUFFER. Released by text_file_close_lines_reverse(..).
+bool text_file_openfor_read_lines_reverse(text_file_reverse_line_reader* reader, str filename, i64 buffer_size)
+{
+	memset(reader, 0, sizeof(text_file_reverse_line_reader));
+	reader->capacity = (buffer_size > 0) ? buffer_size : TEXT_FILE_REVERSE_LINE_BUFFER;
+
+	// Binary mode so that \r\n and \n are both seen and handled the same on every platform
+	reader->file = fopen((const char*)filename, "rb");
+	if (reader->file == NULL)
+		return false; // The file does not exist
+
+	// The reader does its own buffering, so the stdio buffer would only add a copy
+	setvbuf(reader->file, NULL, _IONBF, 0);
+
+	reader->buffer = (c8*)malloc(reader->capacity);
+	if (reader->buffer == NULL || !text_file_set_position_end(reader->file))
+	{
+		text_file_close_lines_reverse(reader);
+		return false; // Failure
+	}
+	reader->position = text_file_get_position(reader->file);
+	if (reader->position < 0)
+	{
+		text_file_close_lines_reverse(reader);
+		return false; // Failure
+	}
+
+	// The buffer fills from the back
+	reader->start = reader->capacity;
+	reader->end = reader->capacity;
+	reader->scanned = reader->capacity;
+	reader->trailing = true;
+	reader->done = (reader->position == 0); // An empty file has no lines
+
+	return true; // Success
+}
+// Read the line before the last one returned, starting with the last line of the file. 'line' is set to point into the
+// reader's buffer and 'length' to the length of the line without the "\r\n" or "\n". The line stays valid until the
+// next call. A newline at the very end of the file does not start another line. Returns false after the first line of
+// the file, or on error.
+bool text_file_read_line_reverse(c8** line, i64* length, text_file_reverse_line_reader* reader)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_LINE, reader->file);
+	if (reader->done)
+		return false; // Start of the file
+
+	for (;;)
+	{
+		i64 found = text_file_find_last_byte(reader->buffer + reader->start, reader->scanned - reader->start, '\n');
+		if (found >= 0 || reader->position == 0)
+		{
+			// The line runs from after the newline, or from the start of the file, to the end
+			i64 line_start = (found >= 0) ? reader->start + found + 1 : reader->start;
+			*line = reader->buffer + line_start;
+			*length = reader->end - line_start;
+			if (*length > 0 && (*line)[*length - 1] == '\r' && !reader->unterminated)
+				(*length)--;
+			reader->unterminated = false;
+			if (found >= 0)
+				reader->end = reader->start + found;
+			else
+				reader->done = true;
+			reader->scanned = reader->end;
+			return true; // Success
+		}
+		reader->scanned = reader->start;
+
+		// Move the partial line to the back of the buffer, or grow the buffer if the line fills all of it
+		if (reader->start == 0)
+		{
+			if (reader->end == reader->capacity)
+			{
+				c8* buffer = (c8*)realloc(reader->buffer, reader->capacity * 2);
+				if (buffer == NULL)
+					return false; // Failed to allocate memory
+				reader->buffer = buffer;
+				reader->capacity *= 2;
+			}
+			i64 kept = reader->end - reader->start;
+			memmove(reader->buffer + reader->capacity - kept, reader->buffer + reader->start, kept);
+			reader->start = reader->capacity - kept;
+			reader->end = reader->capacity;
+			reader->scanned = reader->start;
+		}
+
+		// Read the block before the data in the buffer
+		i64 bytes = (reader->start < reader->position) ? reader->start : reader->position;
+		reader->position -= bytes;
+		if (!text_file_set_position(reader->position, reader->file))
+			return false; // Failure
+		if ((i64)text_file_io_read(reader->buffer + reader->start - bytes, sizeof(char), bytes, reader->file) != bytes)
+			return false; // Error reading file
+		reader->start -= bytes;
+
+		if (reader->trailing)
+		{
+			reader->trailing = false;
+			if (reader->buffer[reader->end - 1] == '\n')
+			{
+				reader->end--;
+				reader->scanned = reader->end;
+			}
+			else
+			{
+				reader->unterminated = true; // Like text_file_read_line(..), a '\r' at the very end is kept
+			}
+		}
+	}
+}
+// Close a reverse line reader and release its buffer
+void text_file_close_lines_reverse(text_file_reverse_line_reader* reader)
+{
+	if (reader->file != NULL)
+		text_file_close(reader->file);
+	free(reader->buffer);
+
+	memset(reader, 0, sizeof(text_file_reverse_line_reader));
+}
+
+//
+// Implementations: Line index
+//
+
+// Number of bytes at the end of the indexed part that are hashed to detect a rewritten file
+#define TEXT_FILE_LINE_INDEX_TAIL 64
+
+// FNV-1a hash of the last TEXT_FILE_LINE_INDEX_TAIL bytes before 'length'. 'file' must be opened in binary mode.
+bool text_file_line_index_tail_hash(u64* hash, file_size length, text_file file)
+{
+	byte tail[TEXT_FILE_LINE_INDEX_TAIL];
+	i64 bytes = (length < TEXT_FILE_LINE_INDEX_TAIL) ? length : TEXT_FILE_LINE_INDEX_TAIL;
+	if (!text_file_set_position(length - bytes, file))
+		return false; // Failure
+	if (fread(tail, sizeof(byte), bytes, file) != (size_t)bytes)
+		return false; // Failure
+
+	*hash = 14695981039346656037ULL;
+	for (i64 i = 0; i < bytes; i++)
+		*hash = (*hash ^ tail[i]) * 1099511628211ULL;
+
+	return true; // Success
+}
+// Append an offset to a line index
+bool text_file_line_index_add(text_file_line_index* index, file_size offset)
+{
+	if (index->count == index->capacity)
+	{
+		i64 capacity = (index->capacity > 0) ? index->capacity * 2 : 1024;
+		file_size* offsets = (file_size*)realloc(index->offsets, capacity * sizeof(file_size));
+		if (offsets == NULL)
+			return false; // Failed to allocate memory
+		index->offsets = offsets;
+		index->capacity = capacity;
+	}
+	index->offsets[index->count++] = offset;
+
+	return true; // Success
+}
+// Write an unsigned varint (7 bits per byte, low bits first)
+void text_file_varint_write(u64 value, text_file file)
+{
+	byte buffer[10];
+	i32 length = 0;
+	while (value >= 0x80)
+	{
+		buffer[length++] = (byte)(value | 0x80);
+		value >>= 7;
+	}
+	buffer[length++] = (byte)value;
+	fwrite(buffer, sizeof(byte), length, file);
+}
+// Read an unsigned varint
+bool text_file_varint_read(u64* value, text_file file)
+{
+	*value = 0;
+	for (i32 shift = 0; shift < 64; shift += 7)
+	{
+		int c = fgetc(file);
+		if (c == EOF)
+			return false; // Truncated
+		*value |= (u64)(c & 0x7F) << shift;
+		if ((c & 0x80) == 0)
+			return true; // Success
+	}
+	return false; // Too long
+}
+// Load a saved line index. Returns false if it does not exist, is damaged or was built with another stride.
+bool text_file_line_index_load(text_file_line_index* index, const char* path, i64 stride)
+{
+	text_file file = fopen(path, "rb");
+	if (file == NULL)
+		return false; // No saved index
+
+	char magic[4];
+	u64 version, saved_stride, newlines, indexed_length, tail_hash, count;
+	bool ok = fread(magic, 1, 4, file) == 4 && memcmp(magic, "TFLI", 4) == 0 &&
+		text_file_varint_read(&version, file) && version == 1 &&
+		text_file_varint_read(&saved_stride, file) && saved_stride == (u64)stride &&
+		text_file_varint_read(&newlines, file) &&
+		text_file_varint_read(&indexed_length, file) &&
+		text_file_varint_read(&tail_hash, file) &&
+		text_file_varint_read(&count, file) && count > 0;
+
+	file_size offset = 0;
+	for (u64 i = 0; ok && i < count; i++)
+	{
+		u64 delta;
+		ok = text_file_varint_read(&delta, file) && text_file_line_index_add(index, offset + (file_size)delta);
+		offset += (file_size)delta;
+	}
+	text_file_close(file);
+
+	if (!ok)
+	{
+		index->count = 0;
+		return false; // Damaged
+	}
+	index->newlines = (i64)newlines;
+	index->indexed_length = (file_size)indexed_length;
+	index->tail_hash = tail_hash;
+
+	return true; // Success
+}
+// Save a line index
+bool text_file_line_index_save(text_file_line_index* index, const char* path)
+{
+	text_file file = fopen(path, "wb");
+	if (file == NULL)
+		return false; // Failed to create the file
+
+	fwrite("TFLI", 1, 4, file);
+	text_file_varint_write(1, file); // Version
+	text_file_varint_write((u64)index->stride, file);
+	text_file_varint_write((u64)index->newlines, file);
+	text_file_varint_write((u64)index->indexed_length, file);
+	text_file_varint_write(index->tail_hash, file);
+	text_file_varint_write((u64)index->count, file);
+	for (i64 i = 0; i < index->count; i++)
+		text_file_varint_write((u64)(index->offsets[i] - ((i > 0) ? index->offsets[i - 1] : 0)), file);
+
+	bool ok = (ferror(file) == 0);
+	ok &= (fclose(file) == 0);
+
+	return ok;
+}
+// Build or update the line index of a text file, indexing every 'stride' line (0 for TEXT_FILE_LINE_INDEX_STRIDE).
+// A saved index ("<filename>.lines") is reused, and if the file has only been appended to since, just the new
+// part of the file is scanned. The index is saved again when it changed, if it can be (not in a read-only directory).
+// Free it with text_file_line_index_free(..). Nothing is left to free when this returns false.
+bool text_file_line_index_build(text_file_line_index* index, str filename, i64 stride)
+{
+	memset(index, 0, sizeof(text_file_line_index));
+	index->stride = (stride > 0) ? stride : TEXT_FILE_LINE_INDEX_STRIDE;
+
+	char path[4096];
+	if (snprintf(path, sizeof(path), "%s.lines", (const char*)filename) >= (int)sizeof(path))
+		return false; // The file name is too long
+
+	text_file file = fopen((const char*)filename, "rb");
+	if (file == NULL)
+		return false; // The file does not exist
+	if (!text_file_set_position_end(file))
+	{
+		text_file_close(file);
+		return false; // Failure
+	}
+	file_size length = text_file_get_position(file);
+
+	// Reuse the saved index if the indexed part of the file is unchanged
+	if (text_file_line_index_load(index, path, index->stride))
+	{
+		u64 hash = 0;
+		if (index->indexed_length > length || !text_file_line_index_tail_hash(&hash, index->indexed_length, file) || hash != index->tail_hash)
+		{
+			index->count = 0; // Truncated or rewritten, start over
+			index->newlines = 0;
+			index->indexed_length = 0;
+		}
+	}
+	if (index->count == 0 && !text_file_line_index_add(index, 0))
+	{
+		text_file_close(file);
+		text_file_line_index_free(index);
+		return false; // Failed to allocate memory
+	}
+	if (index->indexed_length == length)
+	{
+		text_file_close(file);
+		return true; // Up to date
+	}
+
+	// Scan the new part of the file
+	const i64 BUFFER_SIZE = 1024 * 1024;
+	byte* buffer = (byte*)malloc(BUFFER_SIZE);
+	bool ok = (buffer != NULL) && text_file_set_position(index->indexed_length, file);
+	file_size position = index->indexed_length;
+	while (ok && position < length)
+	{
+		i64 bytes = fread(buffer, sizeof(byte), BUFFER_SIZE, file);
+		if (bytes == 0)
+			break;
+		for (i64 i = 0; ok; i++)
+		{
+			i64 found = text_file_find_byte(buffer + i, bytes - i, '\n');
+			if (found < 0)
+				break;
+			i += found;
+			index->newlines++;
+			if (index->newlines % index->stride == 0)
+				ok = text_file_line_index_add(index, position + i + 1);
+		}
+		position += bytes;
+	}
+	free(buffer);
+
+	index->indexed_length = position;
+	ok = ok && text_file_line_index_tail_hash(&index->tail_hash, position, file);
+	text_file_close(file);
+
+	if (!ok)
+	{
+		text_file_line_index_free(index);
+		return false; // Something went wrong while trying to read the file
+	}
+	text_file_line_index_save(index, path); // The index in memory is usable even when it can not be saved
+
+	return true; // Success
+}
+// Seek to the start of line 'line' (0 is the first line) using a line index and a short forward scan of at most 'stride' lines.
+// Lines after the indexed part of the file are found by scanning forward from the last indexed line.
+// Returns false if the file has fewer lines.
+bool text_file_set_position_line(i64 line, text_file_line_index* index, text_file file)
+{
+	if (line < 0 || index->count == 0)
+		return false; // Failure
+
+	i64 entry = line / index->stride;
+	if (entry >= index->count)
+		entry = index->count - 1;
+	i64 skip = line - (entry * index->stride); // Newlines left to skip
+
+	if (!text_file_set_position(index->offsets[entry], file))
+		return false; // Failure
+
+	byte buffer[16 * 1024];
+	while (skip > 0)
+	{
+		file_size chunk_position = text_file_get_position(file);
+		i64 bytes = fread(buffer, sizeof(byte), sizeof(buffer), file);
+		if (bytes == 0)
+			return false; // The file has fewer lines
+
+		for (i64 i = 0; i < bytes; i++)
+		{
+			i64 found = text_file_find_byte(buffer + i, bytes - i, '\n');
+			if (found < 0)
+				break;
+			i += found;
+			if (--skip == 0)
+			{
+				// Seek back and read up to the newline again. This keeps the position right in text mode as well.
+				if (!text_file_set_position(chunk_position, file))
+					return false; // Failure
+				return (fread(buffer, sizeof(byte), i + 1, file) == (size_t)(i + 1));
+			}
+		}
+	}
+
+	return true; // Success
+}
+// Release the memory of a line index
+void text_file_line_index_free(text_file_line_index* index)
+{
+	free(index->offsets);
+	memset(index, 0, sizeof(text_file_line_index));
+}
+
+//
+// Implementations: Threads
+//
+
+// Start a thread running 'proc(argument)'
+bool text_file_thread_start(text_file_thread* thread, text_file_thread_proc proc, void* argument)
+{
+#if defined(_WIN32)
+	*thread = CreateThread(NULL, 0, proc, argument, 0, NULL);
+	return (*thread != NULL);
+#else
+	return (pthread_create(thread, NULL, proc, argument) == 0);
+#endif
+}
+// Wait for a thread to finish
+void text_file_thread_join(text_file_thread thread)
+{
+#if defined(_WIN32)
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, NULL);
+#endif
+}
+// Get a monotonic time stamp in nanoseconds, for measuring durations
+u64 text_file_clock_ns(void)
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (u64)((counter.QuadPart / frequency.QuadPart) * 1000000000ULL + ((counter.QuadPart % frequency.QuadPart) * 1000000000ULL) / frequency.QuadPart);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return ((u64)now.tv_sec * 1000000000ULL) + (u64)now.tv_nsec;
+#endif
+}
+// Get the number of logical processors
+i32 text_file_cpu_count(void)
+{
+#if defined(_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (i32)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (i32)count : 1;
+#endif
+}
+// Read a value shared between threads
+i32 text_file_atomic_load_i32(volatile i32* value)
+{
+#if defined(_MSC_VER)
+	return (i32)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#else
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+// Write a value shared between threads
+void text_file_atomic_store_i32(volatile i32* value, i32 new_value)
+{
+#if defined(_MSC_VER)
+	InterlockedExchange((volatile LONG*)value, (LONG)new_value);
+#else
+	__atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+#endif
+}
+// Initialize a mutex
+void text_file_mutex_init(text_file_mutex* mutex)
+{
+#if defined(_WIN32)
+	InitializeSRWLock(mutex);
+#else
+	pthread_mutex_init(mutex, NULL);
+#endif
+}
+// Destroy a mutex
+void text_file_mutex_destroy(text_file_mutex* mutex)
+{
+#if defined(_WIN32)
+	(void)mutex; // Nothing to release
+#else
+	pthread_mutex_destroy(mutex);
+#endif
+}
+// Lock a mutex
+void text_file_mutex_lock(text_file_mutex* mutex)
+{
+#if defined(_WIN32)
+	AcquireSRWLockExclusive(mutex);
+#else
+	pthread_mutex_lock(mutex);
+#endif
+}
+// Unlock a mutex
+void text_file_mutex_unlock(text_file_mutex* mutex)
+{
+#if defined(_WIN32)
+	ReleaseSRWLockExclusive(mutex);
+#else
+	pthread_mutex_unlock(mutex);
+#endif
+}
+// Initialize a condition variable
+void text_file_condition_init(text_file_condition* condition)
+{
+#if defined(_WIN32)
+	InitializeConditionVariable(condition);
+#else
+	pthread_cond_init(condition, NULL);
+#endif
+}
+// Destroy a condition variable
+void text_file_condition_destroy(text_file_condition* condition)
+{
+#if defined(_WIN32)
+	(void)condition; // Nothing to release
+#else
+	pthread_cond_destroy(condition);
+#endif
+}
+// Wait on a condition variable. The mutex must be locked.
+void text_file_condition_wait(text_file_condition* condition, text_file_mutex* mutex)
+{
+#if defined(_WIN32)
+	SleepConditionVariableSRW(condition, mutex, INFINITE, 0);
+#else
+	pthread_cond_wait(condition, mutex);
+#endif
+}
+// Wake one thread waiting on a condition variable
+void text_file_condition_signal(text_file_condition* condition)
+{
+#if defined(_WIN32)
+	WakeConditionVariable(condition);
+#else
+	pthread_cond_signal(condition);
+#endif
+}
+// Wake all threads waiting on a condition variable
+void text_file_condition_broadcast(text_file_condition* condition)
+{
+#if defined(_WIN32)
+	WakeAllConditionVariable(condition);
+#else
+	pthread_cond_broadcast(condition);
+#endif
+}
+// Wait on a condition variable for at most 'milliseconds'. The mutex must be locked.
+void text_file_condition_wait_ms(text_file_condition* condition, text_file_mutex* mutex, i32 milliseconds)
+{
+#if defined(_WIN32)
+	SleepConditionVariableSRW(condition, mutex, (DWORD)milliseconds, 0);
+#else
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += milliseconds / 1000;
+	deadline.tv_nsec += (long)(milliseconds % 1000) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+	pthread_cond_timedwait(condition, mutex, &deadline);
+#endif
+}
+// Let other threads run
+void text_file_yield(void)
+{
+#if defined(_WIN32)
+	SwitchToThread();
+#else
+	sched_yield();
+#endif
+}
+// Sleep the calling thread
+void text_file_sleep_ms(i32 milliseconds)
+{
+#if defined(_WIN32)
+	Sleep((DWORD)milliseconds);
+#else
+	struct timespec time = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L };
+	while (nanosleep(&time, &time) != 0 && errno == EINTR)
+	{
+	}
+#endif
+}
+// Read a 64-bit value shared between threads
+i64 text_file_atomic_load_i64(volatile i64* value)
+{
+#if defined(_MSC_VER)
+	return InterlockedCompareExchange64(value, 0, 0);
+#else
+	return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+#endif
+}
+// Write a 64-bit value shared between threads
+void text_file_atomic_store_i64(volatile i64* value, i64 new_value)
+{
+#if defined(_MSC_VER)
+	InterlockedExchange64(value, new_value);
+#else
+	__atomic_store_n(value, new_value, __ATOMIC_SEQ_CST);
+#endif
+}
+// Replace a 64-bit value shared between threads if it still is 'expected'. Returns true if it was replaced.
+bool text_file_atomic_cas_i64(volatile i64* value, i64 expected, i64 new_value)
+{
+#if defined(_MSC_VER)
+	return (InterlockedCompareExchange64(value, new_value, expected) == expected);
+#else
+	return __atomic_compare_exchange_n(value, &expected, new_value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+// Add to a 64-bit value shared between threads. Returns the value before the addition.
+i64 text_file_atomic_add_i64(volatile i64* value, i64 amount)
+{
+#if defined(_MSC_VER)
+	return InterlockedExchangeAdd64(value, amount);
+#else
+	return __atomic_fetch_add(value, amount, __ATOMIC_SEQ_CST);
+#endif
+}
+
+//
+// Implementations: Parallel processing
+//
+
+// The work of one worker thread of text_file_process_parallel(..)
+typedef struct text_file_parallel_range
+{
+	str filename;
+	file_size start;					// First byte of the range. Always the start of a line.
+	file_size end;						// One past the last byte of the range
+	i64 chunk_size;
+	i32 range;
+	text_file_chunk_callback callback;
+	void* user;
+	volatile i32* stop;					// Set by the first worker that fails
+	bool ok;
+} text_file_parallel_range;
+
+// Find the start of the first line at or after 'position'
+file_size text_file_next_line_start(file_size position, file_size length, text_file file)
+{
+	if (position <= 0)
+		return 0;
+
+	// If the byte before 'position' is a newline, 'position' is already the start of a line
+	byte buffer[4096];
+	file_size offset = position - 1;
+	while (offset < length)
+	{
+		if (!text_file_set_position(offset, file))
+			return length;
+		i64 bytes = fread(buffer, sizeof(byte), sizeof(buffer), file);
+		if (bytes == 0)
+			return length;
+		i64 found = text_file_find_byte(buffer, bytes, '\n');
+		if (found >= 0)
+			return offset + found + 1;
+		offset += bytes;
+	}
+
+	return length;
+}
+// Worker thread: read one range in chunks that end on a newline and hand them to the callback
+TEXT_FILE_THREAD_PROC(text_file_parallel_worker, argument)
+{
+	text_file_parallel_range* work = (text_file_parallel_range*)argument;
+	work->ok = false;
+
+	text_file file = fopen((const char*)work->filename, "rb");
+	if (file == NULL)
+	{
+		text_file_atomic_store_i32(work->stop, 1);
+		TEXT_FILE_THREAD_RETURN;
+	}
+	setvbuf(file, NULL, _IONBF, 0); // Read straight into the chunk buffer
+
+	i64 capacity = work->chunk_size;
+	c8* buffer = (c8*)malloc(capacity);
+	bool ok = (buffer != NULL) && text_file_set_position(work->start, file);
+	file_size position = work->start;	// File position of buffer[0]
+	i64 used = 0;						// Bytes in the buffer
+	file_size remaining = work->end - work->start;
+
+	while (ok && text_file_atomic_load_i32(work->stop) == 0 && (remaining > 0 || used > 0))
+	{
+		if (used == capacity)
+		{
+			// A line is larger than the buffer
+			c8* larger = (c8*)realloc(buffer, capacity * 2);
+			if (larger == NULL)
+			{
+				ok = false;
+				break;
+			}
+			buffer = larger;
+			capacity *= 2;
+		}
+
+		i64 request = capacity - used;
+		if (request > remaining)
+			request = remaining;
+		i64 bytes = (request > 0) ? (i64)fread(buffer + used, sizeof(c8), request, file) : 0;
+		if (bytes < request)
+			remaining = 0; // The file got shorter or a read error. Hand over what there is.
+		else
+			remaining -= bytes;
+		used += bytes;
+
+		// Everything up to the last newline, or all of it at the end of the range
+		i64 length = used;
+		if (remaining > 0)
+		{
+			i64 newline = text_file_find_last_byte(buffer, used, '\n');
+			length = (newline >= 0) ? newline + 1 : 0;
+		}
+		if (length > 0)
+		{
+			ok = work->callback(buffer, length, position, work->range, work->user);
+			memmove(buffer, buffer + length, used - length);
+			used -= length;
+			position += length;
+		}
+	}
+	ok = ok && (ferror(file) == 0);
+
+	free(buffer);
+	text_file_close(file);
+
+	work->ok = ok;
+	if (!ok)
+		text_file_atomic_store_i32(work->stop, 1);
+
+	TEXT_FILE_THREAD_RETURN;
+}
+// Process a text file on several threads. The file is split into 'ranges' byte ranges aligned to line starts
+// (0 for one range per processor), and each range is read by its own worker thread with its own file handle in
+// chunks of about 'chunk_size' bytes (0 for TEXT_FILE_PARALLEL_CHUNK) that end on a newline. Every chunk is passed
+// to 'callback'. When all workers are done, 'reduce' (optional) is called for each range in file order.
+// Returns false if a callback returned false or reading failed.
+bool text_file_process_parallel(str filename, i32 ranges, i64 chunk_size, text_file_chunk_callback callback, text_file_reduce_callback reduce, void* user)
+{
+	if (ranges <= 0)
+		ranges = text_file_cpu_count();
+	if (chunk_size <= 0)
+		chunk_size = TEXT_FILE_PARALLEL_CHUNK;
+
+	text_file file = fopen((const char*)filename, "rb");
+	if (file == NULL)
+		return false; // The file does not exist
+	if (!text_file_set_position_end(file))
+	{
+		text_file_close(file);
+		return false; // Failure
+	}
+	file_size length = text_file_get_position(file);
+
+	text_file_parallel_range* work = (text_file_parallel_range*)calloc(ranges, sizeof(text_file_parallel_range));
+	text_file_thread* threads = (text_file_thread*)calloc(ranges, sizeof(text_file_thread));
+	bool* started = (bool*)calloc(ranges, sizeof(bool));
+	if (work == NULL || threads == NULL || started == NULL)
+	{
+		free(work);
+		free(threads);
+		free(started);
+		text_file_close(file);
+		return false; // Failed to allocate memory
+	}
+
+	// Split at even byte offsets moved forward to the next line start
+	volatile i32 stop = 0;
+	file_size start = 0;
+	for (i32 i = 0; i < ranges; i++)
+	{
+		file_size end = (i == ranges - 1) ? length : text_file_next_line_start((length / ranges) * (i + 1), length, file);
+		if (end < start)
+			end = start;
+
+		work[i].filename = filename;
+		work[i].start = start;
+		work[i].end = end;
+		work[i].chunk_size = chunk_size;
+		work[i].range = i;
+		work[i].callback = callback;
+		work[i].user = user;
+		work[i].stop = &stop;
+		start = end;
+	}
+	text_file_close(file);
+
+	bool ok = true;
+	for (i32 i = 0; i < ranges; i++)
+	{
+		started[i] = text_file_thread_start(&threads[i], text_file_parallel_worker, &work[i]);
+		if (!started[i])
+		{
+			ok = false;
+			text_file_atomic_store_i32(&stop, 1);
+			break;
+		}
+	}
+	for (i32 i = 0; i < ranges; i++)
+	{
+		if (started[i])
+		{
+			text_file_thread_join(threads[i]);
+			ok = ok && work[i].ok;
+		}
+	}
+
+	// Reduce in file order
+	for (i32 i = 0; ok && reduce != NULL && i < ranges; i++)
+		ok = reduce(i, user);
+
+	free(work);
+	free(threads);
+	free(started);
+
+	return ok;
+}
+
+//
+// Implementations: File lengths
+//
+
+// FNV-1a hash of a name or path
+u64 text_file_length_cache_hash(const c8* text, i64 length)
+{
+	u64 hash = 14695981039346656037ULL;
+	for (i64 i = 0; i < length; i++)
+		hash = (hash ^ text[i]) * 1099511628211ULL;
+
+	return hash;
+}
+// Initialize a length cache. A length is looked up again after 'ttl_ms' milliseconds, 0 for never on Linux where changes
+// are watched. Elsewhere 0 means TEXT_FILE_LENGTH_CACHE_TTL_MS.
+bool text_file_length_cache_init(text_file_length_cache* cache, i32 ttl_ms)
+{
+	memset(cache, 0, sizeof(text_file_length_cache));
+
+#if !defined(__linux__)
+	if (ttl_ms <= 0)
+		ttl_ms = TEXT_FILE_LENGTH_CACHE_TTL_MS;
+#endif
+	cache->ttl_ns = (ttl_ms > 0) ? (u64)ttl_ms * 1000000 : 0;
+
+	cache->capacity = 1024;
+	cache->entries = (text_file_length_entry*)calloc(cache->capacity, sizeof(text_file_length_entry));
+	cache->directory_slot_capacity = 64;
+	cache->directory_slots = (i32*)malloc(cache->directory_slot_capacity * sizeof(i32));
+	if (cache->entries == NULL || cache->directory_slots == NULL)
+	{
+		free(cache->entries);
+		free(cache->directory_slots);
+		return false; // Failed to allocate memory
+	}
+	memset(cache->directory_slots, 0xFF, cache->directory_slot_capacity * sizeof(i32));
+
+#if defined(__linux__)
+	// Without inotify (out of instances) the cache only trusts lengths for the TTL
+	cache->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+	return true; // Success
+}
+// Free a length cache
+void text_file_length_cache_free(text_file_length_cache* cache)
+{
+	for (i64 i = 0; i < cache->capacity; i++)
+		free(cache->entries[i].name);
+	for (i32 i = 0; i < cache->directory_count; i++)
+		free(cache->directories[i].path);
+	free(cache->entries);
+	free(cache->directories);
+	free(cache->directory_slots);
+#if defined(__linux__)
+	if (cache->inotify >= 0)
+		close(cache->inotify);
+	free(cache->descriptors);
+#endif
+
+	memset(cache, 0, sizeof(text_file_length_cache));
+}
+// Watch a directory of a length cache for files that are changed, created, deleted or moved (Linux only)
+void text_file_length_cache_watch(text_file_length_cache* cache, i32 directory)
+{
+	text_file_length_directory* entry = &cache->directories[directory];
+	entry->descriptor = -1;
+	entry->next = -1;
+#if defined(__linux__)
+	if (cache->inotify < 0)
+		return; // No inotify
+
+	// Out of watches (fs.inotify.max_user_watches) leaves the directory unwatched
+	int descriptor = inotify_add_watch(cache->inotify, (const char*)entry->path, IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	if (descriptor < 0)
+		return; // Not watched
+
+	if (descriptor >= cache->descriptor_capacity)
+	{
+		i32 capacity = (descriptor + 1 > cache->descriptor_capacity * 2) ? descriptor + 1 : cache->descriptor_capacity * 2;
+		i32* descriptors = (i32*)realloc(cache->descriptors, capacity * sizeof(i32));
+		if (descriptors == NULL)
+			return; // Not watched. Its events are ignored.
+		memset(descriptors + cache->descriptor_capacity, 0xFF, (capacity - cache->descriptor_capacity) * sizeof(i32));
+		cache->descriptors = descriptors;
+		cache->descriptor_capacity = capacity;
+	}
+
+	// inotify gives the same descriptor to two paths of one directory
+	entry->descriptor = descriptor;
+	entry->next = cache->descriptors[descriptor];
+	cache->descriptors[descriptor] = directory;
+#endif
+}
+// Get the index of a directory in a length cache. It is added (and watched) if it is new. Returns -1 if out of memory.
+i32 text_file_length_cache_directory(text_file_length_cache* cache, const c8* path, i64 length)
+{
+	if ((cache->directory_count + 1) * 4 > cache->directory_slot_capacity * 3)
+	{
+		i32 capacity = cache->directory_slot_capacity * 2;
+		i32* slots = (i32*)malloc(capacity * sizeof(i32));
+		if (slots == NULL)
+			return -1; // Failed to allocate memory
+		memset(slots, 0xFF, capacity * sizeof(i32));
+		for (i32 i = 0; i < cache->directory_count; i++)
+		{
+			i32 slot = (i32)(cache->directories[i].hash & (capacity - 1));
+			while (slots[slot] >= 0)
+				slot = (slot + 1) & (capacity - 1);
+			slots[slot] = i;
+		}
+		free(cache->directory_slots);
+		cache->directory_slots = slots;
+		cache->directory_slot_capacity = capacity;
+	}
+
+	u64 hash = text_file_length_cache_hash(path, length);
+	i32 slot = (i32)(hash & (cache->directory_slot_capacity - 1));
+	while (cache->directory_slots[slot] >= 0)
+	{
+		text_file_length_directory* entry = &cache->directories[cache->directory_slots[slot]];
+		if (entry->hash == hash && entry->length == length && memcmp(entry->path, path, length) == 0)
+			return cache->directory_slots[slot]; // Found
+		slot = (slot + 1) & (cache->directory_slot_capacity - 1);
+	}
+
+	if (cache->directory_count == cache->directory_capacity)
+	{
+		i32 capacity = (cache->directory_capacity > 0) ? cache->directory_capacity * 2 : 64;
+		text_file_length_directory* directories = (text_file_length_directory*)realloc(cache->directories, capacity * sizeof(text_file_length_directory));
+		if (directories == NULL)
+			return -1; // Failed to allocate memory
+		cache->directories = directories;
+		cache->directory_capacity = capacity;
+	}
+	c8* copy = (c8*)malloc(length + 1);
+	if (copy == NULL)
+		return -1; // Failed to allocate memory
+	memcpy(copy, path, length);
+	copy[length] = '\0';
+
+	i32 directory = cache->directory_count++;
+	cache->directories[directory].path = copy;
+	cache->directories[directory].length = length;
+	cache->directories[directory].hash = hash;
+	cache->directory_slots[slot] = directory;
+	text_file_length_cache_watch(cache, directory);
+
+	return directory;
+}
+// Find a file in a length cache. Returns its slot, or -1 if it is not cached.
+i64 text_file_length_cache_find(text_file_length_cache* cache, i32 directory, const c8* name, i64 name_length, u64 hash)
+{
+	i64 slot = (i64)(hash & (cache->capacity - 1));
+	while (cache->entries[slot].name != NULL)
+	{
+		text_file_length_entry* entry = &cache->entries[slot];
+		if (entry->hash == hash && entry->directory == directory && entry->name_length == name_length && memcmp(entry->name, name, name_length) == 0)
+			return slot; // Found
+		slot = (slot + 1) & (cache->capacity - 1);
+	}
+
+	return -1; // Not cached
+}
+// Get the slot of a file in a length cache. A new file gets an invalid entry. Returns -1 if out of memory.
+i64 text_file_length_cache_slot(text_file_length_cache* cache, str filename)
+{
+	// Split into the directory and the name
+	i64 length = (i64)strlen((const char*)filename);
+	i64 separator = length - 1;
+#if defined(_WIN32)
+	while (separator >= 0 && filename[separator] != '/' && filename[separator] != '\\')
+		separator--;
+#else
+	while (separator >= 0 && filename[separator] != '/')
+		separator--;
+#endif
+	const c8* name = filename + separator + 1;
+	i64 name_length = length - separator - 1;
+	i32 directory;
+	if (separator < 0)
+		directory = text_file_length_cache_directory(cache, (const c8*)".", 1);
+	else
+		directory = text_file_length_cache_directory(cache, filename, (separator > 0) ? separator : 1); // "/name" is in "/"
+	if (directory < 0)
+		return -1; // Failed to allocate memory
+	if (cache->directories[directory].descriptor == -2)
+		text_file_length_cache_watch(cache, directory); // The directory was moved or deleted, so watch its path again
+
+	u64 hash = text_file_length_cache_hash(name, name_length) ^ ((u64)directory * 0x9E3779B97F4A7C15ULL);
+	i64 slot = text_file_length_cache_find(cache, directory, name, name_length, hash);
+	if (slot >= 0)
+		return slot; // Cached
+
+	if ((cache->count + 1) * 4 > cache->capacity * 3)
+	{
+		i64 capacity = cache->capacity * 2;
+		text_file_length_entry* entries = (text_file_length_entry*)calloc(capacity, sizeof(text_file_length_entry));
+		if (entries == NULL)
+			return -1; // Failed to allocate memory
+		for (i64 i = 0; i < cache->capacity; i++)
+		{
+			if (cache->entries[i].name == NULL)
+				continue;
+			i64 moved = (i64)(cache->entries[i].hash & (capacity - 1));
+			while (entries[moved].name != NULL)
+				moved = (moved + 1) & (capacity - 1);
+			entries[moved] = cache->entries[i];
+		}
+		free(cache->entries);
+		cache->entries = entries;
+		cache->capacity = capacity;
+	}
+
+	c8* copy = (c8*)malloc(name_length + 1);
+	if (copy == NULL)
+		return -1; // Failed to allocate memory
+	memcpy(copy, name, name_length);
+	copy[name_length] = '\0';
+
+	slot = (i64)(hash & (cache->capacity - 1));
+	while (cache->entries[slot].name != NULL)
+		slot = (slot + 1) & (cache->capacity - 1);
+	text_file_length_entry* entry = &cache->entries[slot];
+	entry->name = copy;
+	entry->name_length = name_length;
+	entry->hash = hash;
+	entry->directory = directory;
+	entry->valid = false;
+	entry->length = -1;
+	entry->checked = 0;
+	cache->count++;
+
+	return slot;
+}
+// Invalidate the cached lengths of the files in a directory, or of all files with a negative 'directory'
+void text_file_length_cache_invalidate(text_file_length_cache* cache, i32 directory)
+{
+	for (i64 i = 0; i < cache->capacity; i++)
+	{
+		if (directory < 0 || cache->entries[i].directory == directory)
+			cache->entries[i].valid = false;
+	}
+}
+// Invalidate the cached lengths of the files that changed since the last call (Linux only)
+void text_file_length_cache_update(text_file_length_cache* cache)
+{
+#if defined(__linux__)
+	if (cache->inotify < 0)
+		return; // No inotify
+
+	u64 events[512]; // Aligned for struct inotify_event
+	ssize_t bytes;
+	while ((bytes = read(cache->inotify, events, sizeof(events))) > 0)
+	{
+		for (c8* event = (c8*)events; event < (c8*)events + bytes; event += sizeof(struct inotify_event) + ((struct inotify_event*)event)->len)
+		{
+			struct inotify_event* change = (struct inotify_event*)event;
+			if (change->mask & IN_Q_OVERFLOW)
+			{
+				text_file_length_cache_invalidate(cache, -1); // Events were lost
+				continue;
+			}
+			if (change->wd < 0 || change->wd >= cache->descriptor_capacity || cache->descriptors[change->wd] < 0)
+				continue; // Not a watched directory (any more)
+
+			if (change->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED | IN_UNMOUNT))
+			{
+				// The watch no longer follows the path. Forget the files in it and watch the path again when it is used.
+				for (i32 directory = cache->descriptors[change->wd]; directory >= 0; directory = cache->directories[directory].next)
+				{
+					text_file_length_cache_invalidate(cache, directory);
+					cache->directories[directory].descriptor = -2;
+				}
+				if (!(change->mask & IN_IGNORED))
+					inotify_rm_watch(cache->inotify, change->wd);
+				cache->descriptors[change->wd] = -1;
+				continue;
+			}
+
+			if (change->len == 0)
+				continue; // Not about a file in the directory
+			i64 name_length = (i64)strlen(change->name);
+			for (i32 directory = cache->descriptors[change->wd]; directory >= 0; directory = cache->directories[directory].next)
+			{
+				u64 hash = text_file_length_cache_hash((const c8*)change->name, name_length) ^ ((u64)directory * 0x9E3779B97F4A7C15ULL);
+				i64 slot = text_file_length_cache_find(cache, directory, (const c8*)change->name, name_length, hash);
+				if (slot >= 0)
+					cache->entries[slot].valid = false;
+			}
+		}
+	}
+#else
+	(void)cache;
+#endif
+}
+// Check if a cached length can be used without looking it up again
+bool text_file_length_cache_usable(text_file_length_cache* cache, const text_file_length_entry* entry, u64 now)
+{
+	if (!entry->valid)
+		return false; // Changed, or never looked up
+	if (cache->ttl_ns > 0 && now - entry->checked >= cache->ttl_ns)
+		return false; // Too old
+#if defined(__linux__)
+	if (cache->ttl_ns == 0 && cache->directories[entry->directory].descriptor < 0)
+		return false; // Changes to it are not seen
+#endif
+
+	return true; // Usable
+}
+// Get the length of a file for a length cache. A symbolic link is not 'cacheable' on Linux since its target is not watched.
+file_size text_file_length_cache_stat(str filename, bool* cacheable)
+{
+	*cacheable = true;
+#if defined(__linux__)
+	struct stat information;
+	if (lstat((const char*)filename, &information) != 0)
+		return -1; // The file does not exist. Creating it invalidates the entry.
+	if (S_ISLNK(information.st_mode))
+	{
+		*cacheable = false;
+		return text_file_get_length(filename);
+	}
+	if (S_ISDIR(information.st_mode))
+		return -1; // Not a file
+
+	return (file_size)information.st_size;
+#else
+	return text_file_get_length(filename);
+#endif
+}
+// Get the length of a file through a length cache. Returns -1 if the file is not found.
+// Note: Changes made through a hard link in another directory, or by renaming a parent directory, are only seen when
+//       the TTL runs out.
+file_size text_file_length_cache_get(text_file_length_cache* cache, str filename)
+{
+	text_file_length_cache_update(cache);
+
+	i64 slot = text_file_length_cache_slot(cache, filename);
+	if (slot < 0)
+		return text_file_get_length(filename); // Failed to allocate memory, so it is not cached
+
+	u64 now = (cache->ttl_ns > 0) ? text_file_clock_ns() : 0;
+	text_file_length_entry* entry = &cache->entries[slot];
+	if (text_file_length_cache_usable(cache, entry, now))
+		return entry->length; // Cached
+
+	bool cacheable;
+	entry->length = text_file_length_cache_stat(filename, &cacheable);
+	entry->valid = cacheable;
+	entry->checked = now;
+
+	return entry->length;
+}
+
+// Work shared by the threads of text_file_get_lengths(..)
+typedef struct text_file_lengths_work
+{
+	str* filenames;
+	file_size* lengths;
+	bool* cacheable;					// NULL without a cache
+	const i64* indexes;					// Indexes of the files to look up, NULL for all
+	i64 count;
+	volatile i64 next;					// Next file to take
+} text_file_lengths_work;
+
+// Look up the lengths of the files from 'next' on, TEXT_FILE_LENGTHS_BATCH at a time
+TEXT_FILE_THREAD_PROC(text_file_lengths_worker, argument)
+{
+	text_file_lengths_work* work = (text_file_lengths_work*)argument;
+
+	for (;;)
+	{
+		i64 start = text_file_atomic_add_i64(&work->next, TEXT_FILE_LENGTHS_BATCH);
+		if (start >= work->count)
+			break; // All taken
+		i64 end = (start + TEXT_FILE_LENGTHS_BATCH < work->count) ? start + TEXT_FILE_LENGTHS_BATCH : work->count;
+		for (i64 i = start; i < end; i++)
+		{
+			i64 index = (work->indexes != NULL) ? work->indexes[i] : i;
+			if (work->cacheable != NULL)
+				work->lengths[index] = text_file_length_cache_stat(work->filenames[index], &work->cacheable[index]);
+			else
+				work->lengths[index] = text_file_get_length(work->filenames[index]);
+		}
+	}
+
+	TEXT_FILE_THREAD_RETURN;
+}
+// Get the lengths of many files on up to 'threads' threads (0 for two per CPU). lengths[i] is -1 if filenames[i] is not
+// found. With a 'cache' only the files that are not cached are looked up, and they are cached afterwards.
+void text_file_get_lengths(file_size* lengths, str* filenames, i64 count, i32 threads, text_file_length_cache* cache)
+{
+	text_file_lengths_work work;
+	memset(&work, 0, sizeof(work));
+	work.filenames = filenames;
+	work.lengths = lengths;
+	work.count = count;
+
+	i64* indexes = NULL;
+	u64 now = 0;
+	if (cache != NULL)
+	{
+		// Take the cached lengths on this thread. The slots of the others are made before their lookups, so that the
+		// directories are watched first.
+		text_file_length_cache_update(cache);
+		now = (cache->ttl_ns > 0) ? text_file_clock_ns() : 0;
+		indexes = (i64*)malloc(count * sizeof(i64));
+		work.cacheable = (bool*)malloc(count * sizeof(bool));
+		if (indexes == NULL || work.cacheable == NULL)
+		{
+			free(indexes);
+			free(work.cacheable);
+			for (i64 i = 0; i < count; i++)
+				lengths[i] = text_file_length_cache_get(cache, filenames[i]); // Failed to allocate memory, so one by one
+			return;
+		}
+
+		work.count = 0;
+		for (i64 i = 0; i < count; i++)
+		{
+			i64 slot = text_file_length_cache_slot(cache, filenames[i]);
+			if (slot >= 0 && text_file_length_cache_usable(cache, &cache->entries[slot], now))
+				lengths[i] = cache->entries[slot].length;
+			else
+				indexes[work.count++] = i;
+		}
+		work.indexes = indexes;
+	}
+
+	if (threads <= 0)
+		threads = text_file_cpu_count() * 2; // Lookups mostly wait on the disk or the network
+	if (threads > work.count / TEXT_FILE_LENGTHS_PER_THREAD)
+		threads = (i32)(work.count / TEXT_FILE_LENGTHS_PER_THREAD);
+
+	// The calling thread is one of the threads
+	text_file_thread* started = (threads > 1) ? (text_file_thread*)malloc((threads - 1) * sizeof(text_file_thread)) : NULL;
+	i32 started_count = 0;
+	while (started != NULL && started_count < threads - 1 && text_file_thread_start(&started[started_count], text_file_lengths_worker, &work))
+		started_count++;
+	text_file_lengths_worker(&work);
+	for (i32 i = 0; i < started_count; i++)
+		text_file_thread_join(started[i]);
+	free(started);
+
+	if (cache != NULL)
+	{
+		for (i64 i = 0; i < work.count; i++)
+		{
+			i64 index = indexes[i];
+			i64 slot = text_file_length_cache_slot(cache, filenames[index]); // Found again, since new entries move the others
+			if (slot < 0)
+				continue; // Failed to allocate memory, so it is not cached
+			cache->entries[slot].length = lengths[index];
+			cache->entries[slot].valid = work.cacheable[index];
+			cache->entries[slot].checked = now;
+		}
+		free(indexes);
+		free(work.cacheable);
+	}
+}
+
+//
+// Implementations: Read-ahead text file
+//
+// On Windows the background thread writes into a pipe whose read end is 'file', the pipe buffer being the queue.
+// Elsewhere 'file' is a custom stdio stream (fopencookie or funopen) that takes the buffers straight from a ring
+// filled by the background thread, which also makes seeking possible.
+//
+
+#if defined(_WIN32)
+
+// Background thread: read the source file and write it into the pipe until the end of the file or the pipe is closed
+TEXT_FILE_THREAD_PROC(text_file_async_worker, argument)
+{
+	text_file_async* async = (text_file_async*)argument;
+	for (;;)
+	{
+		i64 bytes = fread(async->buffer, sizeof(byte), async->buffer_size, async->source);
+		DWORD written = 0;
+		if (bytes <= 0 || !WriteFile(async->pipe, async->buffer, (DWORD)bytes, &written, NULL))
+			break; // End of the file, or the reader closed the pipe
+	}
+	CloseHandle(async->pipe); // The reader sees the end of the file
+
+	TEXT_FILE_THREAD_RETURN;
+}
+
+#else
+
+// Background thread: keep the ring of buffers filled
+TEXT_FILE_THREAD_PROC(text_file_async_worker, argument)
+{
+	text_file_async* async = (text_file_async*)argument;
+
+	text_file_mutex_lock(&async->mutex);
+	while (!async->stop)
+	{
+		if (async->seek_pending)
+		{
+			async->seek_pending = false;
+			if (!text_file_set_position(async->seek_position, async->source))
+				async->error = true;
+			clearerr(async->source);
+			text_file_condition_broadcast(&async->not_empty);
+		}
+		if (async->count == async->depth || async->eof || async->error)
+		{
+			text_file_condition_wait(&async->not_full, &async->mutex);
+			continue;
+		}
+
+		// Fill the tail buffer without holding the lock. The caller never touches a buffer that is not filled yet.
+		i32 slot = async->tail;
+		u32 generation = async->generation;
+		text_file_mutex_unlock(&async->mutex);
+		i64 bytes = fread(async->buffers[slot], sizeof(byte), async->buffer_size, async->source);
+		bool error = (ferror(async->source) != 0);
+		text_file_mutex_lock(&async->mutex);
+
+		if (generation != async->generation)
+			continue; // The caller seeked meanwhile, so this data is from the wrong place
+
+		if (bytes > 0)
+		{
+			async->lengths[slot] = bytes;
+			async->tail = (async->tail + 1) % async->depth;
+			async->count++;
+		}
+		if (bytes < async->buffer_size)
+		{
+			async->error = error;
+			async->eof = !error;
+		}
+		text_file_condition_broadcast(&async->not_empty);
+	}
+	text_file_mutex_unlock(&async->mutex);
+
+	TEXT_FILE_THREAD_RETURN;
+}
+// Stream read function: copy from the head buffer, waiting for the background thread if the ring is empty
+i64 text_file_async_read(text_file_async* async, c8* data, i64 size)
+{
+	text_file_mutex_lock(&async->mutex);
+	while (async->count == 0 && (async->seek_pending || (!async->eof && !async->error)))
+		text_file_condition_wait(&async->not_empty, &async->mutex);
+	if (async->count == 0)
+	{
+		i64 result = async->error ? -1 : 0;
+		text_file_mutex_unlock(&async->mutex);
+		return result; // End of the file or error
+	}
+	i32 slot = async->head;
+	i64 available = async->lengths[slot] - async->consumed;
+	byte* source = async->buffers[slot] + async->consumed;
+	text_file_mutex_unlock(&async->mutex);
+
+	// The background thread does not write to a filled buffer, so it is copied without the lock
+	i64 bytes = (size < available) ? size : available;
+	memcpy(data, source, bytes);
+
+	text_file_mutex_lock(&async->mutex);
+	async->consumed += bytes;
+	async->position += bytes;
+	if (async->consumed == async->lengths[slot])
+	{
+		async->head = (async->head + 1) % async->depth;
+		async->count--;
+		async->consumed = 0;
+		text_file_condition_signal(&async->not_full);
+	}
+	text_file_mutex_unlock(&async->mutex);
+
+	return bytes;
+}
+// Stream seek function: drop the read-ahead and restart the background thread at the new position
+i32 text_file_async_seek(text_file_async* async, file_size* offset, int whence)
+{
+	text_file_mutex_lock(&async->mutex);
+	file_size target = *offset;
+	if (whence == SEEK_CUR)
+	{
+		target += async->position;
+	}
+	else if (whence == SEEK_END)
+	{
+		struct stat info;
+		if (fstat(fileno(async->source), &info) != 0)
+		{
+			text_file_mutex_unlock(&async->mutex);
+			return -1; // Failure
+		}
+		target += (file_size)info.st_size;
+	}
+	if (target < 0)
+	{
+		text_file_mutex_unlock(&async->mutex);
+		return -1; // Failure
+	}
+
+	// ftell(..) seeks by 0 from the current position, which must not throw the read-ahead away
+	if (target != async->position)
+	{
+		async->generation++;
+		async->seek_pending = true;
+		async->seek_position = target;
+		async->head = 0;
+		async->tail = 0;
+		async->count = 0;
+		async->consumed = 0;
+		async->eof = false;
+		async->error = false;
+		async->position = target;
+		text_file_condition_signal(&async->not_full);
+	}
+	text_file_mutex_unlock(&async->mutex);
+
+	*offset = target;
+
+	return 0; // Success
+}
+// Release the buffers and the source file of a read-ahead text file
+void text_file_async_free(text_file_async* async)
+{
+	text_file_close(async->source);
+	for (i32 i = 0; i < async->depth; i++)
+		free(async->buffers[i]);
+	free(async->buffers);
+	free(async->lengths);
+	text_file_condition_destroy(&async->not_empty);
+	text_file_condition_destroy(&async->not_full);
+	text_file_mutex_destroy(&async->mutex);
+}
+// Stream close function: stop the background thread and release everything
+i32 text_file_async_close(text_file_async* async)
+{
+	text_file_mutex_lock(&async->mutex);
+	async->stop = true;
+	text_file_condition_broadcast(&async->not_full);
+	text_file_mutex_unlock(&async->mutex);
+	text_file_thread_join(async->thread);
+
+	text_file_async_free(async);
+
+	return 0;
+}
+
+#if TEXT_FILE_FUNOPEN
+// funopen(..) adapters
+int text_file_async_stream_read(void* cookie, char* data, int size)
+{
+	return (int)text_file_async_read((text_file_async*)cookie, (c8*)data, size);
+}
+fpos_t text_file_async_stream_seek(void* cookie, fpos_t offset, int whence)
+{
+	file_size position = (file_size)offset;
+	return (text_file_async_seek((text_file_async*)cookie, &position, whence) == 0) ? (fpos_t)position : -1;
+}
+int text_file_async_stream_close(void* cookie)
+{
+	return text_file_async_close((text_file_async*)cookie);
+}
+#elif TEXT_FILE_FOPENCOOKIE
+// fopencookie(..) adapters
+ssize_t text_file_async_stream_read(void* cookie, char* data, size_t size)
+{
+	return (ssize_t)text_file_async_read((text_file_async*)cookie, (c8*)data, (i64)size);
+}
+int text_file_async_stream_seek(void* cookie, off_t* offset, int whence) // off_t is 64-bit with _FILE_OFFSET_BITS 64
+{
+	file_size position = (file_size)*offset;
+	if (text_file_async_seek((text_file_async*)cookie, &position, whence) != 0)
+		return -1;
+	*offset = (off_t)position;
+	return 0;
+}
+int text_file_async_stream_close(void* cookie)
+{
+	return text_file_async_close((text_file_async*)cookie);
+}
+#endif
+
+#endif
+
+// Open a text file for reading with read-ahead on a background thread. 'buffer_size' (0 for TEXT_FILE_ASYNC_BUFFER) is
+// the size of each read and 'depth' (0 for TEXT_FILE_ASYNC_DEPTH) how many buffers can be read ahead.
+// Use 'async->file' with the text_file_read_* functions and close it with text_file_close_async(..).
+// Note: On Windows the data comes through a pipe, so 'async->file' can not seek. Without custom streams
+//       (TEXT_FILE_FUNOPEN and TEXT_FILE_FOPENCOOKIE are 0) 'async->file' is the file itself, read without read-ahead.
+bool text_file_openfor_read_async(text_file_async* async, str filename, i64 buffer_size, i32 depth)
+{
+	memset(async, 0, sizeof(text_file_async));
+	async->buffer_size = (buffer_size > 0) ? buffer_size : TEXT_FILE_ASYNC_BUFFER;
+	async->depth = (depth > 0) ? depth : TEXT_FILE_ASYNC_DEPTH;
+
+	async->source = fopen((const char*)filename, "rb");
+	if (async->source == NULL)
+		return false; // The file does not exist
+#if !defined(_WIN32) && !TEXT_FILE_FUNOPEN && !TEXT_FILE_FOPENCOOKIE
+	// No custom streams, so the file is read on the calling thread
+	async->file = async->source;
+	async->source = NULL;
+	return true; // Success
+#endif
+	setvbuf(async->source, NULL, _IONBF, 0); // Read straight into the buffers
+
+#if defined(_WIN32)
+	HANDLE read_pipe = NULL;
+	async->buffer = (byte*)malloc(async->buffer_size);
+	if (async->buffer == NULL || !CreatePipe(&read_pipe, &async->pipe, NULL, (DWORD)(async->buffer_size * async->depth)))
+	{
+		free(async->buffer);
+		text_file_close(async->source);
+		return false; // Failed to create the pipe
+	}
+	int descriptor = _open_osfhandle((intptr_t)read_pipe, _O_RDONLY);
+	async->file = (descriptor != -1) ? _fdopen(descriptor, "r") : NULL;
+	if (async->file == NULL || !text_file_thread_start(&async->thread, text_file_async_worker, async))
+	{
+		if (async->file != NULL)
+			fclose(async->file);
+		else if (descriptor != -1)
+			_close(descriptor);
+		else
+			CloseHandle(read_pipe);
+		CloseHandle(async->pipe);
+		free(async->buffer);
+		text_file_close(async->source);
+		return false; // Failed to start
+	}
+#else
+	async->buffers = (byte**)calloc(async->depth, sizeof(byte*));
+	async->lengths = (i64*)calloc(async->depth, sizeof(i64));
+	bool ok = (async->buffers != NULL && async->lengths != NULL);
+	for (i32 i = 0; ok && i < async->depth; i++)
+	{
+		async->buffers[i] = (byte*)malloc(async->buffer_size);
+		ok = (async->buffers[i] != NULL);
+	}
+	if (!ok)
+	{
+		for (i32 i = 0; async->buffers != NULL && i < async->depth; i++)
+			free(async->buffers[i]);
+		free(async->buffers);
+		free(async->lengths);
+		text_file_close(async->source);
+		return false; // Failed to allocate memory
+	}
+	text_file_mutex_init(&async->mutex);
+	text_file_condition_init(&async->not_empty);
+	text_file_condition_init(&async->not_full);
+
+	if (!text_file_thread_start(&async->thread, text_file_async_worker, async))
+	{
+		text_file_async_free(async);
+		return false; // Failed to start
+	}
+
+#if TEXT_FILE_FUNOPEN
+	async->file = funopen(async, text_file_async_stream_read, NULL, text_file_async_stream_seek, text_file_async_stream_close);
+#elif TEXT_FILE_FOPENCOOKIE
+	cookie_io_functions_t functions = { text_file_async_stream_read, NULL, text_file_async_stream_seek, text_file_async_stream_close };
+	async->file = fopencookie(async, "r", functions);
+#endif
+	if (async->file == NULL)
+	{
+		text_file_async_close(async);
+		return false; // Failed to create the stream
+	}
+#endif
+
+	return true; // Success
+}
+// Close a read-ahead text file and stop its background thread
+void text_file_close_async(text_file_async* async)
+{
+#if defined(_WIN32)
+	TEXT_FILE_STATS_RELEASE(async->file);
+	fclose(async->file); // Closes the read end of the pipe, so the background thread stops writing
+	text_file_thread_join(async->thread);
+	text_file_close(async->source);
+	free(async->buffer);
+#else
+	TEXT_FILE_STATS_RELEASE(async->file);
+	fclose(async->file); // Calls text_file_async_close(..)
+#endif
+
+	memset(async, 0, sizeof(text_file_async));
+}
+
+//
+// Implementations: Log
+//
+// Producers reserve space in the ring with a compare-and-swap on 'head', copy their message in and then publish it by
+// storing its header. The writer thread takes published records from 'tail' in order, copies them into one batch,
+// zeroes their space (so a future header never looks published too early) and writes the batch with one fwrite(..).
+//
+
+// Copy 'length' bytes into the ring at 'position', wrapping around the end
+void text_file_log_copy_in(text_file_log* log, i64 position, const byte* data, i64 length)
+{
+	i64 offset = position & (log->capacity - 1);
+	i64 first = (length < log->capacity - offset) ? length : log->capacity - offset;
+	memcpy(log->ring + offset, data, first);
+	memcpy(log->ring, data + first, length - first);
+}
+// Copy 'length' bytes out of the ring at 'position' and zero them, wrapping around the end
+void text_file_log_copy_out(text_file_log* log, i64 position, byte* data, i64 length)
+{
+	i64 offset = position & (log->capacity - 1);
+	i64 first = (length < log->capacity - offset) ? length : log->capacity - offset;
+	if (data != NULL)
+	{
+		memcpy(data, log->ring + offset, first);
+		memcpy(data + first, log->ring, length - first);
+	}
+	memset(log->ring + offset, 0, first);
+	memset(log->ring, 0, length - first);
+}
+// Get the header of the record at 'position'. 0 while it is not published.
+i64 text_file_log_header(text_file_log* log, i64 position)
+{
+	return text_file_atomic_load_i64((volatile i64*)(log->ring + (position & (log->capacity - 1))));
+}
+// Writer thread: write published records in batches until stopped and the ring is empty
+TEXT_FILE_THREAD_PROC(text_file_log_writer, argument)
+{
+	text_file_log* log = (text_file_log*)argument;
+	i64 tail = log->tail;
+
+	for (;;)
+	{
+		// Take as many published records as there are
+		i64 batch_length = 0;
+		for (;;)
+		{
+			i64 header = text_file_log_header(log, tail);
+			if (header == 0)
+				break; // Not published yet
+			i64 length = header >> 1;
+			i64 size = 8 + ((length + 7) & ~7LL);
+			text_file_log_copy_out(log, tail + 8, log->batch + batch_length, length);
+			text_file_log_copy_out(log, tail + 8 + length, NULL, size - 8 - length); // Padding
+			text_file_atomic_store_i64((volatile i64*)(log->ring + (tail & (log->capacity - 1))), 0);
+			batch_length += length;
+			tail += size;
+		}
+		if (batch_length > 0)
+		{
+			text_file_atomic_store_i64(&log->tail, tail); // Room for the producers again
+			if (text_file_atomic_load_i64(&log->blocked) > 0)
+			{
+				text_file_mutex_lock(&log->mutex);
+				text_file_condition_broadcast(&log->drained);
+				text_file_mutex_unlock(&log->mutex);
+			}
+
+			if (fwrite(log->batch, sizeof(byte), batch_length, log->file) != (size_t)batch_length)
+				text_file_atomic_store_i32(&log->error, 1);
+
+			text_file_mutex_lock(&log->mutex);
+			text_file_atomic_store_i64(&log->written, tail);
+			text_file_condition_broadcast(&log->drained);
+			text_file_mutex_unlock(&log->mutex);
+			continue;
+		}
+
+		if (text_file_atomic_load_i32(&log->stop) != 0 && text_file_atomic_load_i64(&log->head) == tail)
+			break; // Stopped and everything is written
+
+		// Sleep until a producer publishes a record. The timeout covers a producer that is between reserving and publishing.
+		text_file_mutex_lock(&log->mutex);
+		text_file_atomic_store_i32(&log->sleeping, 1);
+		if (text_file_log_header(log, tail) == 0 && text_file_atomic_load_i32(&log->stop) == 0)
+			text_file_condition_wait_ms(&log->wake, &log->mutex, 10);
+		text_file_atomic_store_i32(&log->sleeping, 0);
+		text_file_mutex_unlock(&log->mutex);
+	}
+
+	TEXT_FILE_THREAD_RETURN;
+}
+// Wake the writer thread if it is sleeping
+void text_file_log_wake(text_file_log* log)
+{
+	if (text_file_atomic_load_i32(&log->sleeping) != 0)
+	{
+		text_file_mutex_lock(&log->mutex);
+		text_file_condition_signal(&log->wake);
+		text_file_mutex_unlock(&log->mutex);
+	}
+}
+// Open a text file in append mode as a log for many threads. 'capacity' is the size of the ring buffer
+// (0 for TEXT_FILE_LOG_CAPACITY, rounded up to a power of two) and 'policy' what to do when it is full.
+// Close it with text_file_close_log(..).
+bool text_file_openfor_write_log(text_file_log* log, str filename, i64 capacity, text_file_log_policy policy)
+{
+	memset(log, 0, sizeof(text_file_log));
+	log->capacity = 64;
+	while (log->capacity < ((capacity > 0) ? capacity : TEXT_FILE_LOG_CAPACITY))
+		log->capacity *= 2;
+	log->policy = policy;
+
+	log->file = text_file_openfor_write_append(filename);
+	if (log->file == NULL)
+		return false; // Failed to open the file
+	setvbuf(log->file, NULL, _IONBF, 0); // One write per batch
+
+	log->ring = (byte*)calloc(log->capacity, 1);
+	log->batch = (byte*)malloc(log->capacity);
+	if (log->ring == NULL || log->batch == NULL)
+	{
+		free(log->ring);
+		free(log->batch);
+		text_file_close(log->file);
+		return false; // Failed to allocate memory
+	}
+	text_file_mutex_init(&log->mutex);
+	text_file_condition_init(&log->wake);
+	text_file_condition_init(&log->drained);
+
+	if (!text_file_thread_start(&log->thread, text_file_log_writer, log))
+	{
+		text_file_condition_destroy(&log->wake);
+		text_file_condition_destroy(&log->drained);
+		text_file_mutex_destroy(&log->mutex);
+		free(log->ring);
+		free(log->batch);
+		text_file_close(log->file);
+		return false; // Failed to start the writer thread
+	}
+
+	return true; // Success
+}
+// Add a message to a log. It can be called from any number of threads at the same time. Messages are written in the
+// order they got their space in the ring and are never interleaved. Returns false if the message was dropped
+// (ring full with TEXT_FILE_LOG_DROP) or is larger than the ring.
+bool text_file_log_write(const byte* data, i64 length, text_file_log* log)
+{
+	i64 size = 8 + ((length + 7) & ~7LL);
+	if (length <= 0 || size > log->capacity)
+		return false; // Empty or too large
+
+	// Reserve space
+	i64 head;
+	for (;;)
+	{
+		head = text_file_atomic_load_i64(&log->head);
+		if (head + size - text_file_atomic_load_i64(&log->tail) > log->capacity)
+		{
+			if (log->policy == TEXT_FILE_LOG_DROP)
+			{
+				text_file_atomic_add_i64(&log->dropped, 1);
+				return false; // Full
+			}
+
+			// Sleep until the writer thread takes records out of the ring. 'blocked' is counted before 'tail' is
+			// checked again, so the writer thread sees it after advancing 'tail' and signals 'drained'.
+			text_file_mutex_lock(&log->mutex);
+			text_file_atomic_add_i64(&log->blocked, 1);
+			if (head + size - text_file_atomic_load_i64(&log->tail) > log->capacity)
+			{
+				text_file_condition_signal(&log->wake);
+				text_file_condition_wait(&log->drained, &log->mutex);
+			}
+			text_file_atomic_add_i64(&log->blocked, -1);
+			text_file_mutex_unlock(&log->mutex);
+			continue;
+		}
+		if (text_file_atomic_cas_i64(&log->head, head, head + size))
+			break;
+	}
+
+	// Copy the message in, then publish it with its header
+	text_file_log_copy_in(log, head + 8, data, length);
+	text_file_atomic_store_i64((volatile i64*)(log->ring + (head & (log->capacity - 1))), (length << 1) | 1);
+	text_file_log_wake(log);
+
+	return true; // Success
+}
+// Add a null terminated string to a log
+bool text_file_log_write_str(str text, text_file_log* log)
+{
+	return text_file_log_write(text, (i64)strlen((const char*)text), log);
+}
+// Wait until every message added before this call is written to the file. Returns false if writing failed.
+bool text_file_log_flush(text_file_log* log)
+{
+	i64 target = text_file_atomic_load_i64(&log->head);
+
+	text_file_mutex_lock(&log->mutex);
+	while (text_file_atomic_load_i64(&log->written) < target && text_file_atomic_load_i32(&log->error) == 0)
+	{
+		text_file_condition_signal(&log->wake);
+		text_file_condition_wait_ms(&log->drained, &log->mutex, 10);
+	}
+	text_file_mutex_unlock(&log->mutex);
+
+	return (text_file_atomic_load_i32(&log->error) == 0);
+}
+// Get the number of messages dropped because the ring was full
+i64 text_file_log_dropped(text_file_log* log)
+{
+	return text_file_atomic_load_i64(&log->dropped);
+}
+// Write everything that is left, stop the writer thread and close the log. No thread may write to it any more.
+// Returns false if writing failed.
+bool text_file_close_log(text_file_log* log)
+{
+	text_file_mutex_lock(&log->mutex);
+	text_file_atomic_store_i32(&log->stop, 1);
+	text_file_condition_signal(&log->wake);
+	text_file_mutex_unlock(&log->mutex);
+	text_file_thread_join(log->thread);
+
+	bool ok = (text_file_atomic_load_i32(&log->error) == 0);
+	TEXT_FILE_STATS_RELEASE(log->file);
+	ok &= (fclose(log->file) == 0);
+
+	text_file_condition_destroy(&log->wake);
+	text_file_condition_destroy(&log->drained);
+	text_file_mutex_destroy(&log->mutex);
+	free(log->ring);
+	free(log->batch);
+	memset(log, 0, sizeof(text_file_log));
+
+	return ok;
+}
+
+//
+// Implementations: Newline conversion
+//
+// The converters look for "\r" or "\n" 16 or 32 bytes at a time with text_file_find_byte(..) and copy the runs between
+// them with memcpy(..). There is about one newline per line, so nearly all of the data moves in long runs at memory speed.
+// On Windows the converted data goes through a pipe fed or drained by a background thread, elsewhere through a custom stdio stream.
+//
+
+// Convert "\r\n" to "\n" and keep lone "\r" as they are. A "\r" at the end of 'source' is held back in 'pending', as the
+// "\n" may come with the next call. Call it with 'length' 0 at the end to get a held back "\r". 'pending' starts as false.
+// 'destination' needs room for 'length' + 1 chars. Returns the number of chars written.
+i64 text_file_newlines_to_lf(c8* destination, const c8* source, i64 length, bool* pending)
+{
+	i64 written = 0;
+	if (*pending && (length == 0 || source[0] != '\n'))
+		destination[written++] = '\r'; // The held back "\r" was not part of a "\r\n"
+	*pending = false;
+
+	i64 run = 0; // Start of the run of chars that are copied as they are
+	for (i64 i = 0; i < length; i++)
+	{
+		i64 found = text_file_find_byte(source + i, length - i, '\r');
+		if (found < 0)
+			break;
+		i += found;
+		if (i + 1 == length)
+		{
+			memcpy(destination + written, source + run, i - run);
+			*pending = true;
+			return written + (i - run); // Hold back the "\r"
+		}
+		if (source[i + 1] == '\n')
+		{
+			memcpy(destination + written, source + run, i - run);
+			written += i - run;
+			run = i + 1; // Drop the "\r"
+		}
+	}
+	memcpy(destination + written, source + run, length - run);
+
+	return written + (length - run);
+}
+// Convert "\n" to "\r\n" and keep "\r\n" as it is. 'previous' is the last char of the previous call ('\0' at the start).
+// 'destination' needs room for 2 * 'length' chars. Returns the number of chars written.
+i64 text_file_newlines_to_crlf(c8* destination, const c8* source, i64 length, c8* previous)
+{
+	i64 written = 0;
+	i64 run = 0;
+	for (i64 i = 0; i < length; i++)
+	{
+		i64 found = text_file_find_byte(source + i, length - i, '\n');
+		if (found < 0)
+			break;
+		i += found;
+		c8 before = (i > 0) ? source[i - 1] : *previous;
+		if (before != '\r')
+		{
+			memcpy(destination + written, source + run, i - run);
+			written += i - run;
+			destination[written++] = '\r';
+			run = i; // The "\n" starts the next run
+		}
+	}
+	memcpy(destination + written, source + run, length - run);
+	if (length > 0)
+		*previous = source[length - 1];
+
+	return written + (length - run);
+}
+// Convert to the newline style of a newline converting text file, keeping its state between calls.
+// 'destination' needs room for 2 * 'length' + 1 chars.
+i64 text_file_newlines_convert(c8* destination, const c8* source, i64 length, text_file_newlines* newlines)
+{
+	if (newlines->newline == TEXT_FILE_NEWLINE_LF)
+		return text_file_newlines_to_lf(destination, source, length, &newlines->pending);
+
+	return text_file_newlines_to_crlf(destination, source, length, &newlines->previous);
+}
+
+#if defined(_WIN32)
+
+// Background thread. Reading: read and convert 'source' into the pipe. Writing: convert what comes from the pipe into 'source'.
+TEXT_FILE_THREAD_PROC(text_file_newlines_worker, argument)
+{
+	text_file_newlines* newlines = (text_file_newlines*)argument;
+	i64 chunk = newlines->buffer_size / 2;
+	c8* input = newlines->buffer + newlines->buffer_size + 1;
+	for (;;)
+	{
+		i64 bytes = 0;
+		if (newlines->writing)
+		{
+			DWORD read = 0;
+			if (!ReadFile(newlines->pipe, input, (DWORD)chunk, &read, NULL))
+				read = 0; // The writer closed the pipe
+			bytes = read;
+		}
+		else
+		{
+			bytes = fread(input, sizeof(c8), chunk, newlines->source);
+		}
+
+		i64 length = text_file_newlines_convert(newlines->buffer, input, bytes, newlines);
+		if (newlines->writing)
+		{
+			if (fwrite(newlines->buffer, sizeof(c8), length, newlines->source) != (size_t)length)
+				newlines->error = true;
+		}
+		else
+		{
+			DWORD written = 0;
+			if (length > 0 && !WriteFile(newlines->pipe, newlines->buffer, (DWORD)length, &written, NULL))
+				break; // The reader closed the pipe
+		}
+		if (bytes == 0)
+			break; // End of the input
+	}
+	if (!newlines->writing)
+		CloseHandle(newlines->pipe); // The reader sees the end of the file
+
+	TEXT_FILE_THREAD_RETURN;
+}
+
+#else
+
+// Stream read function: read from the source and convert into 'data'
+i64 text_file_newlines_read(text_file_newlines* newlines, c8* data, i64 size)
+{
+	if (newlines->staged_start < newlines->staged_length)
+	{
+		data[0] = newlines->staged[newlines->staged_start++];
+		return 1;
+	}
+
+	for (;;)
+	{
+		// Less than half of 'size', as every char can become two. Reads of 1 or 2 chars go through 'staged'.
+		bool small = (size < 3);
+		i64 request = small ? 1 : (size - 1) / 2;
+		if (request > newlines->buffer_size)
+			request = newlines->buffer_size;
+		i64 bytes = fread(newlines->buffer, sizeof(c8), request, newlines->source);
+		if (bytes == 0 && ferror(newlines->source) != 0)
+			return -1; // Error reading file
+		if (bytes == 0 && !newlines->pending)
+			return 0; // End of the file
+
+		i64 written = text_file_newlines_convert(small ? newlines->staged : data, newlines->buffer, bytes, newlines);
+		if (written > 0 && small)
+		{
+			data[0] = newlines->staged[0];
+			newlines->staged_start = 1;
+			newlines->staged_length = (i32)written;
+			return 1;
+		}
+		if (written > 0)
+			return written;
+	}
+}
+// Stream write function: convert 'data' and write it to the source
+i64 text_file_newlines_write(text_file_newlines* newlines, const c8* data, i64 size)
+{
+	i64 chunk = newlines->buffer_size / 2;
+	for (i64 i = 0; i < size; i += chunk)
+	{
+		i64 bytes = (size - i < chunk) ? size - i : chunk;
+		i64 length = text_file_newlines_convert(newlines->buffer, data + i, bytes, newlines);
+		if (fwrite(newlines->buffer, sizeof(c8), length, newlines->source) != (size_t)length)
+		{
+			newlines->error = true;
+			return -1; // Something went wrong while trying to write the data
+		}
+	}
+
+	return size;
+}
+// Stream close function: write a held back "\r"
+i32 text_file_newlines_close(text_file_newlines* newlines)
+{
+	if (newlines->writing && newlines->pending)
+	{
+		i64 length = text_file_newlines_convert(newlines->buffer, (const c8*)"", 0, newlines);
+		if (fwrite(newlines->buffer, sizeof(c8), length, newlines->source) != (size_t)length)
+			newlines->error = true;
+	}
+
+	return 0;
+}
+
+#if TEXT_FILE_FUNOPEN
+// funopen(..) adapters
+int text_file_newlines_stream_read(void* cookie, char* data, int size)
+{
+	return (int)text_file_newlines_read((text_file_newlines*)cookie, (c8*)data, size);
+}
+int text_file_newlines_stream_write(void* cookie, const char* data, int size)
+{
+	return (int)text_file_newlines_write((text_file_newlines*)cookie, (const c8*)data, size);
+}
+int text_file_newlines_stream_close(void* cookie)
+{
+	return text_file_newlines_close((text_file_newlines*)cookie);
+}
+#elif TEXT_FILE_FOPENCOOKIE
+// fopencookie(..) adapters
+ssize_t text_file_newlines_stream_read(void* cookie, char* data, size_t size)
+{
+	return (ssize_t)text_file_newlines_read((text_file_newlines*)cookie, (c8*)data, (i64)size);
+}
+ssize_t text_file_newlines_stream_write(void* cookie, const char* data, size_t size)
+{
+	i64 result = text_file_newlines_write((text_file_newlines*)cookie, (const c8*)data, (i64)size);
+	return (result < 0) ? 0 : (ssize_t)result; // fopencookie(..) takes 0 as an error
+}
+int text_file_newlines_stream_close(void* cookie)
+{
+	return text_file_newlines_close((text_file_newlines*)cookie);
+}
+#endif
+
+#endif
+
+// Open a text file with its newlines converted to one style, for reading or writing. Returns false where there are no
+// custom streams (see TEXT_FILE_FOPENCOOKIE).
+bool text_file_newlines_open(text_file_newlines* newlines, str filename, text_file_newline newline, bool writing)
+{
+	memset(newlines, 0, sizeof(text_file_newlines));
+	newlines->newline = newline;
+	newlines->writing = writing;
+	newlines->buffer_size = TEXT_FILE_NEWLINES_BUFFER;
+
+	newlines->source = fopen((const char*)filename, writing ? "wb" : "rb");
+	if (newlines->source == NULL)
+		return false; // The file does not exist
+	// Room for the converted data, plus on Windows the input of the background thread
+	newlines->buffer = (c8*)malloc(2 * newlines->buffer_size + 2);
+	if (newlines->buffer == NULL)
+	{
+		text_file_close(newlines->source);
+		return false; // Failed to allocate memory
+	}
+
+#if defined(_WIN32)
+	HANDLE read_pipe = NULL;
+	HANDLE write_pipe = NULL;
+	if (!CreatePipe(&read_pipe, &write_pipe, NULL, (DWORD)newlines->buffer_size))
+	{
+		free(newlines->buffer);
+		text_file_close(newlines->source);
+		return false; // Failed to create the pipe
+	}
+	newlines->pipe = writing ? read_pipe : write_pipe;
+	HANDLE end = writing ? write_pipe : read_pipe;
+	int descriptor = _open_osfhandle((intptr_t)end, writing ? _O_WRONLY : _O_RDONLY);
+	newlines->file = (descriptor != -1) ? _fdopen(descriptor, writing ? "wb" : "rb") : NULL;
+	if (newlines->file == NULL || !text_file_thread_start(&newlines->thread, text_file_newlines_worker, newlines))
+	{
+		if (newlines->file != NULL)
+			fclose(newlines->file);
+		else if (descriptor != -1)
+			_close(descriptor);
+		else
+			CloseHandle(end);
+		CloseHandle(newlines->pipe);
+		free(newlines->buffer);
+		text_file_close(newlines->source);
+		return false; // Failed to start
+	}
+#else
+#if TEXT_FILE_FUNOPEN
+	newlines->file = writing ? funopen(newlines, NULL, text_file_newlines_stream_write, NULL, text_file_newlines_stream_close) :
+		funopen(newlines, text_file_newlines_stream_read, NULL, NULL, text_file_newlines_stream_close);
+#elif TEXT_FILE_FOPENCOOKIE
+	cookie_io_functions_t functions = { text_file_newlines_stream_read, text_file_newlines_stream_write, NULL, text_file_newlines_stream_close };
+	newlines->file = fopencookie(newlines, writing ? "w" : "r", functions);
+#else
+	newlines->file = NULL; // No custom streams
+#endif
+	if (newlines->file == NULL)
+	{
+		free(newlines->buffer);
+		text_file_close(newlines->source);
+		return false; // Failed to create the stream
+	}
+#endif
+
+	return true; // Success
+}
+// Open a text file for reading with its newlines converted to 'newline' on the fly. Read from 'newlines->file'.
+// Note: 'newlines->file' can not seek.
+bool text_file_openfor_read_newlines(text_file_newlines* newlines, str filename, text_file_newline newline)
+{
+	return text_file_newlines_open(newlines, filename, newline, false);
+}
+// Open a text file for writing in truncate mode with the newlines of what is written converted to 'newline' on the fly.
+// Write to 'newlines->file'. Note: 'newlines->file' can not seek.
+bool text_file_openfor_write_newlines(text_file_newlines* newlines, str filename, text_file_newline newline)
+{
+	return text_file_newlines_open(newlines, filename, newline, true);
+}
+// Close a newline converting text file. Returns false if writing failed.
+bool text_file_close_newlines(text_file_newlines* newlines)
+{
+	TEXT_FILE_STATS_RELEASE(newlines->file);
+	bool ok = (fclose(newlines->file) == 0); // Flushes through the conversion
+#if defined(_WIN32)
+	text_file_thread_join(newlines->thread);
+	if (newlines->writing)
+		CloseHandle(newlines->pipe); // The background thread closes the write end of a reading pipe
+#endif
+	ok &= !newlines->error;
+	ok &= (fclose(newlines->source) == 0);
+	free(newlines->buffer);
+	memset(newlines, 0, sizeof(text_file_newlines));
+
+	return ok;
+}
+
+//
+// Implementations: UTF-8
+//
+// The validator is the lookup table algorithm of Keiser and Lemire ("Validating UTF-8 In Less Than One Instruction Per Byte").
+// Each byte and the byte before it index three 16 entry tables with their high and low nibbles (pshufb), and the AND of the
+// three results is non-zero exactly where the pair is not valid UTF-8. Missing and extra continuation bytes are found by
+// looking 2 and 3 bytes back. Blocks of ASCII are skipped with a single compare. Without SSSE3 the ASCII blocks are still
+// skipped with SSE2 and the rest is checked one character at a time. The exact offset of an error is always found by the
+// scalar decoder, starting a few bytes before the block the tables flagged.
+//
+
+// Decode one UTF-8 character. Returns its length in bytes (1 to 4), or 0 if it is not valid (overlong, a surrogate,
+// above U+10FFFF, a bad continuation byte or cut off by the end of 'data').
+u32 text_file_utf8_decode(const c8* data, i64 length, u32* code_point)
+{
+	u32 lead = data[0];
+	if (lead < 0x80)
+	{
+		*code_point = lead;
+		return 1;
+	}
+
+	u32 size;
+	u32 value;
+	u32 minimum;
+	if (lead >= 0xC2 && lead <= 0xDF)
+	{
+		size = 2;
+		value = lead & 0x1F;
+		minimum = 0x80;
+	}
+	else if (lead >= 0xE0 && lead <= 0xEF)
+	{
+		size = 3;
+		value = lead & 0x0F;
+		minimum = 0x800;
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4)
+	{
+		size = 4;
+		value = lead & 0x07;
+		minimum = 0x10000;
+	}
+	else
+	{
+		return 0; // A continuation byte, an overlong two byte lead or a lead above U+10FFFF
+	}
+
+	if (length < (i64)size)
+		return 0; // Cut off
+	for (u32 i = 1; i < size; i++)
+	{
+		if ((data[i] & 0xC0) != 0x80)
+			return 0; // Not a continuation byte
+		value = (value << 6) | (data[i] & 0x3F);
+	}
+	if (value < minimum || value > 0x10FFFF || (value >= 0xD800 && value <= 0xDFFF))
+		return 0; // Overlong, too large or a surrogate
+
+	*code_point = value;
+
+	return size;
+}
+// Find the first UTF-8 error of 'data' with the scalar decoder, starting at 'position' which must be the start of a character
+i64 text_file_utf8_find_error_from(const c8* data, i64 length, i64 position)
+{
+	while (position < length)
+	{
+#if TEXT_FILE_SSE2
+		// Skip ASCII 16 bytes at a time
+		if (length - position >= 16 && _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(data + position))) == 0)
+		{
+			position += 16;
+			continue;
+		}
+#endif
+		u32 code_point;
+		u32 size = text_file_utf8_decode(data + position, length - position, &code_point);
+		if (size == 0)
+			return position; // Error
+		position += size;
+	}
+
+	return -1; // Valid
+}
+// Check that 'data' is valid UTF-8. A character cut off by the end of 'data' counts as an error.
+// Returns -1 if it is valid, otherwise the byte offset of the first error.
+i64 text_file_utf8_find_error(const c8* data, i64 length)
+{
+#if TEXT_FILE_SSSE3
+	// Error flags of a byte pair. See the tables of the paper.
+	const i8 too_short = 1 << 0, too_long = 1 << 1, overlong_3 = 1 << 2, too_large = 1 << 3, surrogate = 1 << 4,
+		overlong_2 = 1 << 5, too_large_1000 = 1 << 6, overlong_4 = 1 << 6, two_continuations = (i8)(1 << 7);
+	const i8 carry = too_short | too_long | two_continuations;
+
+	const __m128i byte_1_high_table = _mm_setr_epi8(
+		too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+		two_continuations, two_continuations, two_continuations, two_continuations,
+		too_short | overlong_2, too_short, too_short | overlong_3 | surrogate,
+		too_short | too_large | too_large_1000 | overlong_4);
+	const __m128i byte_1_low_table = _mm_setr_epi8(
+		carry | overlong_3 | overlong_2 | overlong_4, carry | overlong_2, carry, carry,
+		carry | too_large, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000, carry | too_large | too_large_1000, carry | too_large | too_large_1000,
+		carry | too_large | too_large_1000 | surrogate, carry | too_large | too_large_1000, carry | too_large | too_large_1000);
+	const __m128i byte_2_high_table = _mm_setr_epi8(
+		too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+		too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 | overlong_4,
+		too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+		too_long | overlong_2 | two_continuations | surrogate | too_large,
+		too_long | overlong_2 | two_continuations | surrogate | too_large,
+		too_short, too_short, too_short, too_short);
+	// A character that starts in the last 3 bytes of a block and continues in the next one
+	const __m128i incomplete_limit = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+		(char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+
+	__m128i previous = _mm_setzero_si128();
+	__m128i previous_incomplete = _mm_setzero_si128();
+	i64 i = 0;
+	bool flagged = false;
+#if TEXT_FILE_AVX2
+	// The same with 32 byte blocks. The byte shifts of AVX2 stay inside each 16 byte lane, so the bytes before a block
+	// are put together from the high lane of the last block and the low lane of this one.
+	{
+		const __m256i byte_1_high_table_256 = _mm256_broadcastsi128_si256(byte_1_high_table);
+		const __m256i byte_1_low_table_256 = _mm256_broadcastsi128_si256(byte_1_low_table);
+		const __m256i byte_2_high_table_256 = _mm256_broadcastsi128_si256(byte_2_high_table);
+		const __m256i incomplete_limit_256 = _mm256_inserti128_si256(_mm256_set1_epi8(-1), incomplete_limit, 1);
+		const __m256i nibble_256 = _mm256_set1_epi8(0x0F);
+
+		__m256i previous_256 = _mm256_setzero_si256();
+		__m256i previous_incomplete_256 = _mm256_setzero_si256();
+		for (; i + 32 <= length; i += 32)
+		{
+			__m256i input = _mm256_loadu_si256((const __m256i*)(data + i));
+			__m256i error;
+			if (_mm256_movemask_epi8(input) == 0)
+			{
+				error = previous_incomplete_256; // ASCII
+			}
+			else
+			{
+				__m256i before = _mm256_permute2x128_si256(previous_256, input, 0x21);
+				__m256i previous_1 = _mm256_alignr_epi8(input, before, 15);
+				__m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table_256, _mm256_and_si256(_mm256_srli_epi16(previous_1, 4), nibble_256));
+				__m256i byte_1_low = _mm256_shuffle_epi8(byte_1_low_table_256, _mm256_and_si256(previous_1, nibble_256));
+				__m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table_256, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble_256));
+				__m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+				__m256i previous_2 = _mm256_alignr_epi8(input, before, 14);
+				__m256i previous_3 = _mm256_alignr_epi8(input, before, 13);
+				__m256i third = _mm256_subs_epu8(previous_2, _mm256_set1_epi8((char)(0xE0 - 0x80)));
+				__m256i fourth = _mm256_subs_epu8(previous_3, _mm256_set1_epi8((char)(0xF0 - 0x80)));
+				__m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+				error = _mm256_xor_si256(must_continue, special);
+			}
+			previous_incomplete_256 = _mm256_subs_epu8(input, incomplete_limit_256);
+			previous_256 = input;
+
+			if (!_mm256_testz_si256(error, error))
+			{
+				flagged = true;
+				break; // The error is in this block or cut off at the end of the last one
+			}
+		}
+		// Go on with 16 byte blocks from the high lane of the last block
+		previous = _mm256_extracti128_si256(previous_256, 1);
+		previous_incomplete = _mm256_extracti128_si256(previous_incomplete_256, 1);
+	}
+#endif
+	for (; !flagged && i + 16 <= length; i += 16)
+	{
+		__m128i input = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i error;
+		if (_mm_movemask_epi8(input) == 0)
+		{
+			error = previous_incomplete; // ASCII. Only a character left open by the last block can be wrong.
+		}
+		else
+		{
+			__m128i previous_1 = _mm_alignr_epi8(input, previous, 15);
+			__m128i byte_1_high = _mm_shuffle_epi8(byte_1_high_table, _mm_and_si128(_mm_srli_epi16(previous_1, 4), nibble));
+			__m128i byte_1_low = _mm_shuffle_epi8(byte_1_low_table, _mm_and_si128(previous_1, nibble));
+			__m128i byte_2_high = _mm_shuffle_epi8(byte_2_high_table, _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+			__m128i special = _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+			// A third or fourth byte must follow a three or four byte lead 2 or 3 bytes back
+			__m128i previous_2 = _mm_alignr_epi8(input, previous, 14);
+			__m128i previous_3 = _mm_alignr_epi8(input, previous, 13);
+			__m128i third = _mm_subs_epu8(previous_2, _mm_set1_epi8((char)(0xE0 - 0x80)));
+			__m128i fourth = _mm_subs_epu8(previous_3, _mm_set1_epi8((char)(0xF0 - 0x80)));
+			__m128i must_continue = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+			error = _mm_xor_si128(must_continue, special);
+		}
+		previous_incomplete = _mm_subs_epu8(input, incomplete_limit);
+		previous = input;
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+			break; // The error is in this block or cut off at the end of the last one
+	}
+
+	// Find the exact offset with the scalar decoder, starting at the character before the block. All before it is valid.
+	i64 start = (i >= 3) ? i - 3 : 0;
+	while (start > 0 && (data[start] & 0xC0) == 0x80)
+		start--;
+	return text_file_utf8_find_error_from(data, length, start); // The flagged block, or the last few bytes
+#else
+	return text_file_utf8_find_error_from(data, length, 0);
+#endif
+}
+// Prepare a validator for a new text
+void text_file_utf8_validator_init(text_file_utf8_validator* validator)
+{
+	memset(validator, 0, sizeof(text_file_utf8_validator));
+	validator->error_offset = -1;
+}
+// Validate the next piece of a text. Returns false once an error is found, and 'validator->error_offset' is the
+// offset of the error from the start of the text.
+bool text_file_utf8_validate(text_file_utf8_validator* validator, const c8* data, i64 length)
+{
+	if (validator->error_offset >= 0)
+		return false; // There was an error already
+
+	// Complete the character that was cut off at the end of the last piece
+	i64 i = 0;
+	if (validator->pending_length > 0)
+	{
+		c8 lead = validator->pending[0];
+		i32 size = (lead >= 0xF0) ? 4 : (lead >= 0xE0) ? 3 : 2;
+		while (validator->pending_length < size && i < length)
+			validator->pending[validator->pending_length++] = data[i++];
+		if (validator->pending_length < size)
+		{
+			validator->offset += length;
+			return true; // Still not complete
+		}
+		i64 error = text_file_utf8_find_error(validator->pending, size);
+		if (error >= 0)
+		{
+			validator->error_offset = validator->offset - (validator->pending_length - i) + error;
+			return false; // Error
+		}
+		validator->pending_length = 0;
+	}
+
+	// Keep a character that is cut off at the end for the next piece
+	i64 end = length;
+	for (i64 back = 1; back <= 3 && back <= length - i; back++)
+	{
+		c8 c = data[length - back];
+		if (c < 0x80)
+			break; // ASCII
+		if (c >= 0xC0)
+		{
+			i64 size = (c >= 0xF8) ? 1 : (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : 2; // A bad lead is left to the validation
+			if (size > back)
+				end = length - back;
+			break;
+		}
+	}
+
+	i64 error = text_file_utf8_find_error(data + i, end - i);
+	if (error >= 0)
+	{
+		validator->error_offset = validator->offset + i + error;
+		return false; // Error
+	}
+	memcpy(validator->pending, data + end, length - end);
+	validator->pending_length = (i32)(length - end);
+	validator->offset += length;
+
+	return true; // Success
+}
+// End a text. Returns false if there was an error or the text ends in the middle of a character.
+bool text_file_utf8_validate_end(text_file_utf8_validator* validator)
+{
+	if (validator->error_offset < 0 && validator->pending_length > 0)
+		validator->error_offset = validator->offset - validator->pending_length; // Cut off
+
+	return (validator->error_offset < 0);
+}
+// Read 'str' data from a text file like text_file_read_str(..) and check that it is valid UTF-8. The text is read and
+// checked in pieces of TEXT_FILE_UTF8_CHUNK bytes, each one while it is still in the cache. 'error_offset' (optional) is
+// set to the byte offset of the first error in 'text', or -1. Returns false if reading failed or the text is not valid UTF-8.
+bool text_file_read_str_utf8(str text, i64 length, i64* error_offset, text_file file)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_STR, file);
+	if (error_offset != NULL)
+		*error_offset = -1;
+
+	text_file_utf8_validator validator;
+	text_file_utf8_validator_init(&validator);
+
+	i64 total = 0;
+	bool valid = true;
+	while (total < length)
+	{
+		i64 request = (length - total < TEXT_FILE_UTF8_CHUNK) ? length - total : TEXT_FILE_UTF8_CHUNK;
+		i64 bytes = text_file_io_read(text + total, sizeof(char), request, file);
+		if (valid)
+			valid = text_file_utf8_validate(&validator, text + total, bytes);
+		total += bytes;
+		if (bytes < request)
+			break; // End of the file or error
+	}
+	text[total] = '\0';
+	if (ferror(file) != 0)
+		return false; // Error reading file
+
+	valid = text_file_utf8_validate_end(&validator);
+	if (error_offset != NULL)
+		*error_offset = validator.error_offset;
+
+	return valid;
+}
+// Transcode UTF-8 to UTF-16. 'destination' needs room for 'length' units. Returns the number of units written, or -1 if
+// the text is not valid UTF-8, with 'error_offset' (optional) set to the byte offset of the error. ASCII goes 16 bytes at a time.
+i64 text_file_utf8_to_utf16(u16* destination, const c8* source, i64 length, i64* error_offset)
+{
+	i64 written = 0;
+	i64 i = 0;
+	while (i < length)
+	{
+#if TEXT_FILE_SSE2
+		if (length - i >= 16)
+		{
+			__m128i input = _mm_loadu_si128((const __m128i*)(source + i));
+			if (_mm_movemask_epi8(input) == 0)
+			{
+				_mm_storeu_si128((__m128i*)(destination + written), _mm_unpacklo_epi8(input, _mm_setzero_si128()));
+				_mm_storeu_si128((__m128i*)(destination + written + 8), _mm_unpackhi_epi8(input, _mm_setzero_si128()));
+				written += 16;
+				i += 16;
+				continue;
+			}
+		}
+#endif
+		u32 code_point;
+		u32 size = text_file_utf8_decode(source + i, length - i, &code_point);
+		if (size == 0)
+		{
+			if (error_offset != NULL)
+				*error_offset = i;
+			return -1; // Not valid UTF-8
+		}
+		if (code_point >= 0x10000)
+		{
+			// Surrogate pair. It takes 4 bytes of UTF-8, so there is room for it.
+			code_point -= 0x10000;
+			destination[written++] = (u16)(0xD800 + (code_point >> 10));
+			destination[written++] = (u16)(0xDC00 + (code_point & 0x3FF));
+		}
+		else
+		{
+			destination[written++] = (u16)code_point;
+		}
+		i += size;
+	}
+	if (error_offset != NULL)
+		*error_offset = -1;
+
+	return written;
+}
+// Transcode UTF-8 to UTF-32. 'destination' needs room for 'length' units. Returns the number of units written, or -1 if
+// the text is not valid UTF-8, with 'error_offset' (optional) set to the byte offset of the error. ASCII goes 16 bytes at a time.
+i64 text_file_utf8_to_utf32(u32* destination, const c8* source, i64 length, i64* error_offset)
+{
+	i64 written = 0;
+	i64 i = 0;
+	while (i < length)
+	{
+#if TEXT_FILE_SSE2
+		if (length - i >= 16)
+		{
+			__m128i input = _mm_loadu_si128((const __m128i*)(source + i));
+			if (_mm_movemask_epi8(input) == 0)
+			{
+				__m128i zero = _mm_setzero_si128();
+				__m128i low = _mm_unpacklo_epi8(input, zero);
+				__m128i high = _mm_unpackhi_epi8(input, zero);
+				_mm_storeu_si128((__m128i*)(destination + written), _mm_unpacklo_epi16(low, zero));
+				_mm_storeu_si128((__m128i*)(destination + written + 4), _mm_unpackhi_epi16(low, zero));
+				_mm_storeu_si128((__m128i*)(destination + written + 8), _mm_unpacklo_epi16(high, zero));
+				_mm_storeu_si128((__m128i*)(destination + written + 12), _mm_unpackhi_epi16(high, zero));
+				written += 16;
+				i += 16;
+				continue;
+			}
+		}
+#endif
+		u32 size = text_file_utf8_decode(source + i, length - i, &destination[written]);
+		if (size == 0)
+		{
+			if (error_offset != NULL)
+				*error_offset = i;
+			return -1; // Not valid UTF-8
+		}
+		written++;
+		i += size;
+	}
+	if (error_offset != NULL)
+		*error_offset = -1;
+
+	return written;
+}
+
+//
+// Implementations: Search
+//
+// A single pattern is found with text_file_find_pattern(..), a few with Teddy. More patterns are found with an Aho-Corasick
+// automaton that is built into a full table of transitions over byte classes, so the search is one lookup per byte
+// whatever the number of patterns, and runs of bytes that start no pattern are skipped 16 at a time while it is at its root.
+// Files are read in chunks of TEXT_FILE_SEARCH_CHUNK bytes, and the last max_length - 1 bytes of a chunk are kept in front
+// of the next one, so matches across chunks are found and the start of every match is still in the buffer.
+//
+
+// Compile 'count' patterns for searching. The patterns are copied. Set 'lines' to get line numbers in the callback.
+bool text_file_search_compile(text_file_search* search, const c8** patterns, const i64* lengths, i32 count, bool lines)
+{
+	memset(search, 0, sizeof(text_file_search));
+	search->pattern_count = count;
+	search->lines = lines;
+
+	i64 total = 0;
+	for (i32 i = 0; i < count; i++)
+	{
+		if (lengths[i] <= 0)
+			return false; // Empty pattern
+		total += lengths[i];
+		if (lengths[i] > search->max_length)
+			search->max_length = lengths[i];
+	}
+	if (count <= 0)
+		return false; // Nothing to search for
+
+	search->text = (c8*)malloc(total);
+	search->starts = (i64*)malloc(count * sizeof(i64));
+	search->lengths = (i64*)malloc(count * sizeof(i64));
+	if (search->text == NULL || search->starts == NULL || search->lengths == NULL)
+	{
+		text_file_search_free(search);
+		return false; // Failed to allocate memory
+	}
+	i64 start = 0;
+	for (i32 i = 0; i < count; i++)
+	{
+		memcpy(search->text + start, patterns[i], lengths[i]);
+		search->starts[i] = start;
+		search->lengths[i] = lengths[i];
+		start += lengths[i];
+	}
+	if (count == 1)
+		return true; // Success. No automaton needed.
+#if TEXT_FILE_SSSE3
+	if (count <= TEXT_FILE_SEARCH_TEDDY)
+		return text_file_search_compile_teddy(search);
+#endif
+
+	// Give each byte that is in a pattern its own class
+	search->class_count = 1;
+	for (i64 i = 0; i < total; i++)
+	{
+		if (search->classes[search->text[i]] == 0)
+			search->classes[search->text[i]] = (u8)search->class_count++;
+	}
+	u32 stride = search->class_count;
+	if ((u64)(total + 1) * stride * 2 > 0xFFFFFFFFu)
+	{
+		text_file_search_free(search);
+		return false; // Too many states for the row offsets of the automaton
+	}
+
+	// Build the trie. State 0 is the root, and a transition of 0 from any other state means there is none yet.
+	u32 capacity = (u32)(total + 1);
+	search->transitions = (u32*)calloc((size_t)capacity * stride, sizeof(u32));
+	search->state_pattern = (i32*)malloc(capacity * sizeof(i32));
+	search->state_output = (u32*)calloc(capacity, sizeof(u32));
+	search->pattern_next = (i32*)malloc(count * sizeof(i32));
+	u32* fail = (u32*)calloc(capacity, sizeof(u32));
+	u32* queue = (u32*)malloc(capacity * sizeof(u32));
+	if (search->transitions == NULL || search->state_pattern == NULL || search->state_output == NULL ||
+		search->pattern_next == NULL || fail == NULL || queue == NULL)
+	{
+		free(fail);
+		free(queue);
+		text_file_search_free(search);
+		return false; // Failed to allocate memory
+	}
+	search->state_pattern[0] = -1;
+	search->state_count = 1;
+	for (i32 i = 0; i < count; i++)
+	{
+		u32 state = 0;
+		const c8* pattern = search->text + search->starts[i];
+		for (i64 j = 0; j < lengths[i]; j++)
+		{
+			u32* next = &search->transitions[(size_t)state * stride + search->classes[pattern[j]]];
+			if (*next == 0)
+			{
+				search->state_pattern[search->state_count] = -1;
+				*next = search->state_count++;
+			}
+			state = *next;
+		}
+		search->pattern_next[i] = search->state_pattern[state]; // Same text as an earlier pattern
+		search->state_pattern[state] = i;
+	}
+
+	// Fill in the missing transitions breadth first from the failure links: a missing transition goes where the
+	// longest proper suffix of the state would go.
+	u32 head = 0;
+	u32 tail = 0;
+	for (u32 c = 0; c < stride; c++)
+	{
+		if (search->transitions[c] != 0)
+			queue[tail++] = search->transitions[c];
+	}
+	while (head < tail)
+	{
+		u32 state = queue[head++];
+		search->state_output[state] = (search->state_pattern[fail[state]] >= 0) ? fail[state] : search->state_output[fail[state]];
+		for (u32 c = 0; c < stride; c++)
+		{
+			u32* next = &search->transitions[(size_t)state * stride + c];
+			u32 fallback = search->transitions[(size_t)fail[state] * stride + c];
+			if (*next != 0)
+			{
+				fail[*next] = fallback;
+				queue[tail++] = *next;
+			}
+			else
+			{
+				*next = fallback;
+			}
+		}
+	}
+	free(fail);
+	free(queue);
+
+	// Turn the states into row offsets and mark the states where a pattern ends, so the search needs no other lookup
+	for (size_t i = 0; i < (size_t)search->state_count * stride; i++)
+	{
+		u32 next = search->transitions[i];
+		bool output = search->state_pattern[next] >= 0 || search->state_output[next] != 0;
+		search->transitions[i] = ((next * stride) << 1) | (output ? 1 : 0);
+	}
+	for (u32 c = 0; c < 256; c++)
+	{
+		if (search->transitions[search->classes[c]] != 0)
+		{
+			if (c < 128)
+				search->first_low[c & 15] |= (c8)(1 << (c >> 4));
+			else
+				search->first_high[c & 15] |= (c8)(1 << ((c >> 4) - 8));
+		}
+	}
+
+	return true; // Success
+}
+#if TEXT_FILE_SSSE3
+// Put the patterns in buckets for Teddy. Pattern i goes in bucket i % 8.
+bool text_file_search_compile_teddy(text_file_search* search)
+{
+	search->bucket_patterns = (i32*)malloc(search->pattern_count * sizeof(i32));
+	if (search->bucket_patterns == NULL)
+	{
+		text_file_search_free(search);
+		return false; // Failed to allocate memory
+	}
+
+	search->teddy_length = 3;
+	for (i32 i = 0; i < search->pattern_count; i++)
+	{
+		if (search->lengths[i] < search->teddy_length)
+			search->teddy_length = (i32)search->lengths[i];
+	}
+	i32 used = 0;
+	for (i32 bucket = 0; bucket < 8; bucket++)
+	{
+		search->bucket_starts[bucket] = used;
+		for (i32 i = bucket; i < search->pattern_count; i += 8)
+		{
+			search->bucket_patterns[used++] = i;
+			const c8* pattern = search->text + search->starts[i];
+			for (i32 k = 0; k < search->teddy_length; k++)
+			{
+				search->teddy_low[k][pattern[k] & 15] |= (c8)(1 << bucket);
+				search->teddy_high[k][pattern[k] >> 4] |= (c8)(1 << bucket);
+			}
+		}
+	}
+	search->bucket_starts[8] = used;
+
+	return true; // Success
+}
+// Compare the patterns of the buckets in 'buckets' at 'start' and report the ones that end in the fresh part of 'buffer'.
+// Returns false if the callback stopped the search.
+bool text_file_search_verify(text_file_search_run* run, u32 buckets, const c8* buffer, i64 start, i64 fresh, i64 length, file_size base)
+{
+	text_file_search* search = run->search;
+	while (buckets != 0)
+	{
+		u32 bucket = text_file_trailing_zeros(buckets);
+		buckets &= buckets - 1;
+		for (i32 j = search->bucket_starts[bucket]; j < search->bucket_starts[bucket + 1]; j++)
+		{
+			i32 pattern = search->bucket_patterns[j];
+			i64 end = start + search->lengths[pattern];
+			if (end > length || end <= fresh)
+				continue; // Not all there, or found with the last chunk
+			if (memcmp(buffer + start, search->text + search->starts[pattern], search->lengths[pattern]) != 0)
+				continue; // No match
+			if (!text_file_search_report(run, pattern, buffer, base, start))
+				return false; // Stopped
+		}
+	}
+
+	return true; // Keep going
+}
+// Search 'buffer' with Teddy. Matches are reported in order of where they start.
+bool text_file_search_teddy(text_file_search_run* run, const c8* buffer, i64 fresh, i64 length, file_size base)
+{
+	text_file_search* search = run->search;
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	i32 lookups = search->teddy_length;
+	__m128i low_tables[3];
+	__m128i high_tables[3];
+	for (i32 k = 0; k < lookups; k++)
+	{
+		low_tables[k] = _mm_loadu_si128((const __m128i*)search->teddy_low[k]);
+		high_tables[k] = _mm_loadu_si128((const __m128i*)search->teddy_high[k]);
+	}
+
+	// Matches that end in the fresh part can start up to max_length - 1 bytes before it
+	i64 i = fresh - (search->max_length - 1);
+	if (i < 0)
+		i = 0;
+	for (; i + lookups - 1 + 16 <= length; i += 16)
+	{
+		__m128i buckets = _mm_set1_epi8(-1);
+		for (i32 k = 0; k < lookups; k++)
+		{
+			__m128i input = _mm_loadu_si128((const __m128i*)(buffer + i + k));
+			__m128i low = _mm_shuffle_epi8(low_tables[k], _mm_and_si128(input, nibble));
+			__m128i high = _mm_shuffle_epi8(high_tables[k], _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+			buckets = _mm_and_si128(buckets, _mm_and_si128(low, high));
+		}
+		u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(buckets, _mm_setzero_si128())) ^ 0xFFFF;
+		if (mask == 0)
+			continue; // No candidates. This is the common case.
+
+		c8 bucket_bytes[16];
+		_mm_storeu_si128((__m128i*)bucket_bytes, buckets);
+		while (mask != 0)
+		{
+			u32 offset = text_file_trailing_zeros(mask);
+			mask &= mask - 1;
+			if (!text_file_search_verify(run, bucket_bytes[offset], buffer, i + offset, fresh, length, base))
+				return false; // Stopped
+		}
+	}
+	// The last few positions are compared with every bucket
+	for (; i < length; i++)
+	{
+		if (!text_file_search_verify(run, 0xFF, buffer, i, fresh, length, base))
+			return false; // Stopped
+	}
+
+	return true; // Keep going
+}
+// Get a mask of the bytes of a 16 byte block that start a pattern, from nibble table lookups (pshufb)
+u32 text_file_search_candidates(text_file_search* search, const c8* block)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+	const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+	__m128i input = _mm_loadu_si128((const __m128i*)block);
+	__m128i low = _mm_and_si128(input, nibble);
+	__m128i high = _mm_and_si128(_mm_srli_epi16(input, 4), nibble);
+	__m128i upper = _mm_cmpgt_epi8(high, _mm_set1_epi8(7));
+	__m128i row = _mm_or_si128(_mm_andnot_si128(upper, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)search->first_low), low)),
+		_mm_and_si128(upper, _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)search->first_high), low)));
+	__m128i bit = _mm_shuffle_epi8(bits, high);
+	return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128())) ^ 0xFFFF;
+}
+#endif
+// Free compiled patterns
+void text_file_search_free(text_file_search* search)
+{
+	free(search->text);
+	free(search->starts);
+	free(search->lengths);
+	free(search->transitions);
+	free(search->state_pattern);
+	free(search->state_output);
+	free(search->pattern_next);
+	free(search->bucket_patterns);
+	memset(search, 0, sizeof(text_file_search));
+}
+// Report a match to the callback. 'buffer' starts at file offset 'base' and holds the bytes up to the last counted line.
+bool text_file_search_report(text_file_search_run* run, i32 pattern, const c8* buffer, file_size base, i64 start)
+{
+	i64 line = 0;
+	if (run->search->lines)
+	{
+		file_size offset = base + start;
+		i64 counted = run->line_position - base;
+		if (offset >= run->line_position)
+		{
+			run->line_count += text_file_count_byte(buffer + counted, start - counted, '\n');
+			run->line_position = offset;
+			line = run->line_count + 1;
+		}
+		else
+		{
+			line = run->line_count + 1 - text_file_count_byte(buffer + start, counted - start, '\n'); // A longer pattern that started before the last match
+		}
+	}
+
+	return run->callback(pattern, base + start, line, run->user);
+}
+// Search 'buffer', whose bytes from 'fresh' on were not searched before. Returns false if the callback stopped the search.
+bool text_file_search_block(text_file_search_run* run, const c8* buffer, i64 fresh, i64 length, file_size base)
+{
+	text_file_search* search = run->search;
+	if (search->pattern_count == 1)
+	{
+		// The kept bytes are shorter than the pattern, so every match found here ends in the fresh part
+		i64 pattern_length = search->lengths[0];
+		i64 position = 0;
+		for (;;)
+		{
+			i64 found = text_file_find_pattern(buffer + position, length - position, search->text, pattern_length);
+			if (found < 0)
+				break;
+			if (!text_file_search_report(run, 0, buffer, base, position + found))
+				return false; // Stopped
+			position += found + 1;
+		}
+	}
+#if TEXT_FILE_SSSE3
+	else if (search->teddy_length > 0)
+	{
+		if (!text_file_search_teddy(run, buffer, fresh, length, base))
+			return false; // Stopped
+	}
+#endif
+	else
+	{
+		u32 row = run->state;
+		i64 i = fresh;
+		while (i < length)
+		{
+			i64 end = (length - i < 16) ? length : i + 16;
+#if TEXT_FILE_SSSE3
+			// While the automaton is at its root, all bytes that do not start a pattern leave it there.
+			// Skip them, 16 at a time.
+			if (row == 0 && end - i == 16)
+			{
+				u32 mask = text_file_search_candidates(search, buffer + i);
+				if (mask == 0)
+				{
+					i = end;
+					continue;
+				}
+				i += text_file_trailing_zeros(mask);
+			}
+#endif
+			for (; i < end; i++)
+			{
+				u32 next = search->transitions[row + search->classes[buffer[i]]];
+				row = next >> 1;
+				if ((next & 1) == 0)
+					continue; // No match here. This is the common case.
+
+				// Every pattern that ends here: this state, then its suffixes
+				for (u32 output = row / search->class_count; output != 0; output = search->state_output[output])
+				{
+					for (i32 pattern = search->state_pattern[output]; pattern >= 0; pattern = search->pattern_next[pattern])
+					{
+						if (!text_file_search_report(run, pattern, buffer, base, i + 1 - search->lengths[pattern]))
+							return false; // Stopped
+					}
+				}
+			}
+		}
+		run->state = row;
+	}
+
+	// Count the rest of the lines while the buffer is still there
+	if (search->lines && base + length > run->line_position)
+	{
+		i64 counted = run->line_position - base;
+		run->line_count += text_file_count_byte(buffer + counted, length - counted, '\n');
+		run->line_position = base + length;
+	}
+
+	return true; // Keep going
+}
+// Search a text file from its current position to the end, calling 'callback' for each match. Matches come in order of
+// where they start (one pattern, Teddy) or end (automaton). Offsets are from the start of the file. Only one chunk of
+// the file is in memory at a time.
+bool text_file_search_file(text_file_search* search, text_file file, text_file_search_callback callback, void* user)
+{
+	file_size base = text_file_get_position(file);
+	if (base < 0)
+		return false; // Failure
+
+	i64 keep = search->max_length - 1;
+	c8* buffer = (c8*)malloc(keep + TEXT_FILE_SEARCH_CHUNK);
+	if (buffer == NULL)
+		return false; // Failed to allocate memory
+
+	text_file_search_run run = { search, callback, user, 0, base, 0 };
+	i64 kept = 0;
+	for (;;)
+	{
+		i64 bytes = text_file_io_read(buffer + kept, sizeof(c8), TEXT_FILE_SEARCH_CHUNK, file);
+		if (bytes == 0)
+			break; // End of the file or error
+		i64 length = kept + bytes;
+		if (!text_file_search_block(&run, buffer, kept, length, base))
+			break; // Stopped
+
+		i64 next_kept = (length < keep) ? length : keep;
+		memmove(buffer, buffer + length - next_kept, next_kept);
+		base += length - next_kept;
+		kept = next_kept;
+	}
+	free(buffer);
+
+	return (ferror(file) == 0);
+}
+// Search all of a memory mapped text file, calling 'callback' for each match like text_file_search_file(..)
+bool text_file_search_mapped(text_file_search* search, text_file_mapped* mapped, text_file_search_callback callback, void* user)
+{
+	text_file_search_run run = { search, callback, user, 0, 0, 0 };
+	if (mapped->data != NULL)
+		text_file_search_block(&run, mapped->data, 0, mapped->length, 0);
+
+	return true; // Success
+}
+
+//
+// Implementations: Follow
+//
+
+// Open a file for following. On Windows the file is shared for delete too, so the writer can still rename it away.
+text_file text_file_follow_open_file(str filename)
+{
+#if defined(_WIN32)
+	HANDLE handle = CreateFileA((const char*)filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return NULL; // The file does not exist
+	int descriptor = _open_osfhandle((intptr_t)handle, _O_RDONLY);
+	if (descriptor == -1)
+	{
+		CloseHandle(handle);
+		return NULL; // Failure
+	}
+	text_file file = _fdopen(descriptor, "rb");
+	if (file == NULL)
+		_close(descriptor);
+#else
+	text_file file = fopen((const char*)filename, "rb");
+#endif
+	// Every read seeks to the remembered position first, so the stdio buffer would only be thrown away
+	if (file != NULL)
+		setvbuf(file, NULL, _IONBF, 0);
+
+	return file;
+}
+// Get the identity and the size of an open file, or of 'filename' if 'file' is NULL. 'created' is only set on Windows.
+bool text_file_follow_identity(text_file file, str filename, u64* device, u64* inode, u64* created, file_size* size)
+{
+#if defined(_WIN32)
+	HANDLE handle = INVALID_HANDLE_VALUE;
+	if (file != NULL)
+		handle = (HANDLE)_get_osfhandle(_fileno(file));
+	else if (filename != NULL)
+		handle = CreateFileA((const char*)filename, FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+	if (handle == INVALID_HANDLE_VALUE)
+		return false; // The file does not exist
+	BY_HANDLE_FILE_INFORMATION information;
+	bool ok = GetFileInformationByHandle(handle, &information) != 0;
+	if (file == NULL)
+		CloseHandle(handle);
+	if (!ok)
+		return false; // Failure
+	*device = information.dwVolumeSerialNumber;
+	*inode = ((u64)information.nFileIndexHigh << 32) | information.nFileIndexLow;
+	*created = ((u64)information.ftCreationTime.dwHighDateTime << 32) | information.ftCreationTime.dwLowDateTime;
+	*size = (file_size)(((u64)information.nFileSizeHigh << 32) | information.nFileSizeLow);
+#else
+	struct stat status;
+	if (file != NULL)
+	{
+		if (fstat(fileno(file), &status) != 0)
+			return false; // Failure
+	}
+	else if (filename == NULL || stat((const char*)filename, &status) != 0)
+		return false; // The file does not exist
+	*device = (u64)status.st_dev;
+	*inode = (u64)status.st_ino;
+	*created = 0;
+	*size = (file_size)status.st_size;
+#endif
+
+	return true; // Success
+}
+// Put a followed file in the ready list of its watch, unless it is there already
+void text_file_follow_set_ready(text_file_follow* follow)
+{
+	text_file_watch* watch = follow->watch;
+	if (follow->ready)
+		return; // Already there
+
+	watch->ready[(watch->ready_start + watch->ready_count) % watch->capacity] = follow;
+	watch->ready_count++;
+	follow->ready = true;
+}
+// Start watching the open file of a followed file for changes
+bool text_file_follow_attach(text_file_follow* follow)
+{
+#if defined(__linux__)
+	text_file_watch* watch = follow->watch;
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/self/fd/%d", fileno(follow->file)); // Watch the open file, not whatever has the name now
+	follow->descriptor = inotify_add_watch(watch->inotify, path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+	if (follow->descriptor < 0)
+		follow->descriptor = inotify_add_watch(watch->inotify, (const char*)follow->path, IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+	if (follow->descriptor < 0)
+		return false; // Failure
+
+	if (follow->descriptor >= watch->descriptor_capacity)
+	{
+		i32 capacity = (watch->descriptor_capacity > 0) ? watch->descriptor_capacity : 64;
+		while (capacity <= follow->descriptor)
+			capacity *= 2;
+		text_file_follow** descriptors = (text_file_follow**)realloc(watch->descriptors, capacity * sizeof(text_file_follow*));
+		if (descriptors == NULL)
+		{
+			follow->descriptor = -1;
+			return false; // Failed to allocate memory
+		}
+		memset(descriptors + watch->descriptor_capacity, 0, (capacity - watch->descriptor_capacity) * sizeof(text_file_follow*));
+		watch->descriptors = descriptors;
+		watch->descriptor_capacity = capacity;
+	}
+	// inotify gives the same descriptor to two watches of one file
+	follow->next = watch->descriptors[follow->descriptor];
+	watch->descriptors[follow->descriptor] = follow;
+#else
+	(void)follow;
+#endif
+
+	return true; // Success
+}
+// Stop watching the open file of a followed file
+void text_file_follow_detach(text_file_follow* follow)
+{
+#if defined(__linux__)
+	text_file_watch* watch = follow->watch;
+	if (follow->descriptor < 0)
+		return; // Not watched
+
+	text_file_follow** link = &watch->descriptors[follow->descriptor];
+	while (*link != NULL && *link != follow)
+		link = &(*link)->next;
+	if (*link != NULL)
+		*link = follow->next;
+	if (watch->descriptors[follow->descriptor] == NULL)
+		inotify_rm_watch(watch->inotify, follow->descriptor); // The last one of this file
+	follow->descriptor = -1;
+	follow->next = NULL;
+#else
+	(void)follow;
+#endif
+}
+// Look at what has the name of a followed file now. If it is a new file, the rest of the old file has been read,
+// so switch over to the new one. Returns true if it switched.
+bool text_file_follow_rotate(text_file_follow* follow)
+{
+	u64 device, inode, created;
+	file_size size;
+	if (!text_file_follow_identity(NULL, follow->path, &device, &inode, &created, &size))
+	{
+		if (!follow->missing)
+		{
+			follow->missing = true;
+			follow->watch->missing_count++;
+		}
+		return false; // Renamed or deleted, and nothing new yet
+	}
+	if (follow->missing)
+	{
+		follow->missing = false;
+		follow->watch->missing_count--;
+	}
+#if defined(_WIN32)
+	if (device == follow->device && inode == follow->inode && created == follow->created)
+		return false; // Still the same file
+#else
+	if (device == follow->device && inode == follow->inode)
+		return false; // Still the same file
+#endif
+
+	text_file file = text_file_follow_open_file(follow->path);
+	if (file == NULL)
+		return false; // Gone again. Try later.
+	text_file_follow_detach(follow);
+	text_file_close(follow->file);
+	follow->file = file;
+	text_file_follow_identity(file, NULL, &follow->device, &follow->inode, &created, &size);
+#if defined(_WIN32)
+	follow->created = created;
+#endif
+	follow->position = 0;
+	follow->rotations++;
+	follow->switched = true;
+	text_file_follow_attach(follow);
+
+	return true; // Switched to the new file
+}
+// Prepare a watch for followed files
+bool text_file_watch_init(text_file_watch* watch)
+{
+	memset(watch, 0, sizeof(text_file_watch));
+#if defined(__linux__)
+	watch->inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watch->inotify < 0)
+		return false; // Failure
+#endif
+	watch->last_poll = text_file_clock_ns();
+
+	return true; // Success
+}
+// Release a watch. Close its followed files first.
+void text_file_watch_free(text_file_watch* watch)
+{
+#if defined(__linux__)
+	if (watch->inotify >= 0)
+		close(watch->inotify);
+	free(watch->descriptors);
+#endif
+	free(watch->follows);
+	free(watch->ready);
+	memset(watch, 0, sizeof(text_file_watch));
+}
+// Check the followed files that need polling: the missing ones, and all of them where there is no inotify
+void text_file_watch_poll(text_file_watch* watch)
+{
+	for (i32 i = 0; i < watch->count; i++)
+	{
+		text_file_follow* follow = watch->follows[i];
+		if (follow->missing)
+		{
+			text_file_follow_set_ready(follow); // Reading looks for the new file
+			continue;
+		}
+#if !defined(__linux__)
+		u64 device, inode, created;
+		file_size size;
+		if (!text_file_follow_identity(follow->file, NULL, &device, &inode, &created, &size) || size != follow->position)
+		{
+			text_file_follow_set_ready(follow); // Grown or truncated
+			continue;
+		}
+#if defined(_WIN32)
+		// Cheap check of the name (no handle is opened): is it still there, with the size and creation time of our file?
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if (!GetFileAttributesExA((const char*)follow->path, GetFileExInfoStandard, &attributes) ||
+			(((u64)attributes.ftCreationTime.dwHighDateTime << 32) | attributes.ftCreationTime.dwLowDateTime) != follow->created ||
+			(file_size)(((u64)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow) != size)
+			text_file_follow_set_ready(follow); // Rotated
+#else
+		if (!text_file_follow_identity(NULL, follow->path, &device, &inode, &created, &size) ||
+			device != follow->device || inode != follow->inode)
+			text_file_follow_set_ready(follow); // Rotated
+#endif
+#endif
+	}
+}
+// Wait until a followed file may have new data and return it, or NULL after 'timeout_ms' (-1 waits forever). Read the
+// returned file until text_file_follow_read(..) returns 0 or text_file_follow_read_line(..) returns false.
+text_file_follow* text_file_watch_wait(text_file_watch* watch, i32 timeout_ms)
+{
+	u64 start = text_file_clock_ns();
+	for (;;)
+	{
+		if (watch->ready_count > 0)
+		{
+			text_file_follow* follow = watch->ready[watch->ready_start];
+			watch->ready_start = (watch->ready_start + 1) % watch->capacity;
+			watch->ready_count--;
+			follow->ready = false;
+			return follow; // Success
+		}
+
+		u64 now = text_file_clock_ns();
+		i64 elapsed_ms = (i64)((now - start) / 1000000);
+		if (timeout_ms >= 0 && elapsed_ms >= timeout_ms)
+			return NULL; // Timed out
+
+#if defined(__linux__)
+		bool polling = watch->missing_count > 0;
+#else
+		bool polling = true;
+#endif
+		i64 poll_ms = TEXT_FILE_FOLLOW_POLL_MS - (i64)((now - watch->last_poll) / 1000000);
+		if (polling && poll_ms <= 0)
+		{
+			watch->last_poll = now;
+			text_file_watch_poll(watch);
+			continue;
+		}
+
+		// Sleep until the next poll, the timeout or (Linux) a change, whatever comes first
+		i64 wait_ms = (timeout_ms >= 0) ? timeout_ms - elapsed_ms : -1;
+		if (polling && (wait_ms < 0 || poll_ms < wait_ms))
+			wait_ms = poll_ms;
+#if defined(__linux__)
+		struct pollfd descriptor = { watch->inotify, POLLIN, 0 };
+		if (poll(&descriptor, 1, (int)wait_ms) <= 0)
+			continue; // Timed out or interrupted
+
+		u64 events[512]; // Aligned for struct inotify_event
+		ssize_t bytes;
+		while ((bytes = read(watch->inotify, events, sizeof(events))) > 0)
+		{
+			for (c8* event = (c8*)events; event < (c8*)events + bytes; event += sizeof(struct inotify_event) + ((struct inotify_event*)event)->len)
+			{
+				struct inotify_event* change = (struct inotify_event*)event;
+				if (change->mask & IN_Q_OVERFLOW)
+				{
+					// Events were lost, so any followed file may have new data
+					for (i32 i = 0; i < watch->count; i++)
+						text_file_follow_set_ready(watch->follows[i]);
+					continue;
+				}
+				if (change->wd < 0 || change->wd >= watch->descriptor_capacity)
+					continue; // A watch that was removed
+				for (text_file_follow* follow = watch->descriptors[change->wd]; follow != NULL; follow = follow->next)
+					text_file_follow_set_ready(follow);
+				if ((change->mask & IN_IGNORED) != 0)
+				{
+					// The file is gone and so is its watch
+					text_file_follow* follow = watch->descriptors[change->wd];
+					watch->descriptors[change->wd] = NULL;
+					while (follow != NULL)
+					{
+						text_file_follow* next = follow->next;
+						follow->descriptor = -1;
+						follow->next = NULL;
+						follow = next;
+					}
+				}
+			}
+		}
+#else
+		text_file_sleep_ms((i32)wait_ms);
+#endif
+	}
+}
+// Open a file for following and add it to 'watch'. With 'from_end' only what is appended from now on is read.
+bool text_file_openfor_follow(text_file_follow* follow, str filename, bool from_end, text_file_watch* watch)
+{
+	memset(follow, 0, sizeof(text_file_follow));
+	follow->watch = watch;
+	follow->boundary = -1;
+#if defined(__linux__)
+	follow->descriptor = -1;
+#endif
+
+	if (watch->count == watch->capacity)
+	{
+		// The ready ring grows with the list, and is unrolled into the new one
+		i32 capacity = (watch->capacity > 0) ? watch->capacity * 2 : 16;
+		text_file_follow** follows = (text_file_follow**)realloc(watch->follows, capacity * sizeof(text_file_follow*));
+		if (follows == NULL)
+			return false; // Failed to allocate memory
+		watch->follows = follows;
+		text_file_follow** ready = (text_file_follow**)malloc(capacity * sizeof(text_file_follow*));
+		if (ready == NULL)
+			return false; // Failed to allocate memory
+		for (i32 i = 0; i < watch->ready_count; i++)
+			ready[i] = watch->ready[(watch->ready_start + i) % watch->capacity];
+		free(watch->ready);
+		watch->ready = ready;
+		watch->ready_start = 0;
+		watch->capacity = capacity;
+	}
+
+	size_t length = strlen((const char*)filename);
+	follow->path = (c8*)malloc(length + 1);
+	follow->buffer = (c8*)malloc(TEXT_FILE_FOLLOW_BUFFER);
+	follow->file = text_file_follow_open_file(filename);
+	if (follow->path == NULL || follow->buffer == NULL || follow->file == NULL)
+	{
+		text_file_close_follow(follow);
+		return false; // Failure
+	}
+	memcpy(follow->path, filename, length + 1);
+	follow->capacity = TEXT_FILE_FOLLOW_BUFFER;
+
+	u64 created;
+	file_size size;
+	if (!text_file_follow_identity(follow->file, NULL, &follow->device, &follow->inode, &created, &size))
+	{
+		text_file_close_follow(follow);
+		return false; // Failure
+	}
+#if defined(_WIN32)
+	follow->created = created;
+#endif
+	follow->position = from_end ? size : 0;
+
+	follow->index = watch->count;
+	watch->follows[watch->count++] = follow;
+	if (!text_file_follow_attach(follow))
+	{
+		text_file_close_follow(follow);
+		return false; // Failure
+	}
+	if (size > follow->position)
+		text_file_follow_set_ready(follow); // Something to read already
+
+	return true; // Success
+}
+// Read what was appended to a followed file since the last read, up to 'capacity' bytes. Returns the number of bytes,
+// 0 if there is nothing new, or -1 on error.
+i64 text_file_follow_read(c8* data, i64 capacity, text_file_follow* follow)
+{
+	for (;;)
+	{
+		u64 device, inode, created;
+		file_size size;
+		if (!text_file_follow_identity(follow->file, NULL, &device, &inode, &created, &size))
+			return -1; // Failure
+		if (size < follow->position)
+		{
+			// Truncated. Read it again from the start.
+			follow->position = 0;
+			follow->truncations++;
+			follow->switched = true;
+		}
+		if (size > follow->position)
+		{
+			i64 request = (size - follow->position < capacity) ? size - follow->position : capacity;
+			if (!text_file_set_position(follow->position, follow->file))
+				return -1; // Failure
+			i64 bytes = text_file_io_read(data, sizeof(c8), request, follow->file);
+			if (bytes == 0 && ferror(follow->file) != 0)
+				return -1; // Error reading file
+			follow->position += bytes;
+			return bytes; // Success
+		}
+
+		// All of this file has been read. Is there a new one?
+		if (!text_file_follow_rotate(follow))
+			return 0; // Nothing new
+	}
+}
+// Read the next complete line appended to a followed file. 'line' points into the follow buffer, without the "\r\n"
+// or "\n", and stays valid until the next call. A partial line is kept until the rest of it is appended, unless the
+// file is truncated or rotated first: then it is returned as a line of its own. Returns false if there is no complete line.
+bool text_file_follow_read_line(c8** line, i64* length, text_file_follow* follow)
+{
+	for (;;)
+	{
+		i64 limit = (follow->boundary >= 0) ? follow->boundary : follow->end;
+		i64 found = text_file_find_byte(follow->buffer + follow->scanned, limit - follow->scanned, '\n');
+		if (found >= 0)
+		{
+			i64 newline = follow->scanned + found;
+			*line = follow->buffer + follow->start;
+			*length = newline - follow->start;
+			if (*length > 0 && (*line)[*length - 1] == '\r')
+				(*length)--;
+			follow->start = newline + 1;
+			follow->scanned = follow->start;
+			return true; // Success
+		}
+		if (follow->boundary >= 0)
+		{
+			// The end of the data of a truncated or rotated file
+			i64 boundary = follow->boundary;
+			follow->boundary = -1;
+			follow->scanned = boundary;
+			if (follow->start < boundary)
+			{
+				*line = follow->buffer + follow->start;
+				*length = boundary - follow->start;
+				follow->start = boundary;
+				return true; // Success
+			}
+			continue;
+		}
+		follow->scanned = follow->end;
+
+		// Move the partial line to the front of the buffer, or grow the buffer if the line fills all of it
+		if (follow->start > 0)
+		{
+			memmove(follow->buffer, follow->buffer + follow->start, follow->end - follow->start);
+			follow->end -= follow->start;
+			follow->scanned -= follow->start;
+			follow->start = 0;
+		}
+		else if (follow->end == follow->capacity)
+		{
+			c8* buffer = (c8*)realloc(follow->buffer, follow->capacity * 2);
+			if (buffer == NULL)
+				return false; // Failed to allocate memory
+			follow->buffer = buffer;
+			follow->capacity *= 2;
+		}
+
+		follow->switched = false;
+		i64 bytes = text_file_follow_read(follow->buffer + follow->end, follow->capacity - follow->end, follow);
+		if (bytes < 0)
+			return false; // Failure
+		if (follow->switched && follow->end > follow->start)
+			follow->boundary = follow->end;
+		if (bytes == 0 && follow->boundary < 0)
+			return false; // No complete line yet
+		follow->end += bytes;
+	}
+}
+// Stop following a file and remove it from its watch
+void text_file_close_follow(text_file_follow* follow)
+{
+	text_file_watch* watch = follow->watch;
+	if (watch != NULL && follow->index < watch->count && watch->follows[follow->index] == follow)
+	{
+		text_file_follow_detach(follow);
+		text_file_follow* last = watch->follows[--watch->count];
+		watch->follows[follow->index] = last;
+		last->index = follow->index;
+		if (follow->ready)
+		{
+			// Take it out of the ready ring
+			i32 kept = 0;
+			for (i32 i = 0; i < watch->ready_count; i++)
+			{
+				text_file_follow* ready = watch->ready[(watch->ready_start + i) % watch->capacity];
+				if (ready != follow)
+					watch->ready[(watch->ready_start + kept++) % watch->capacity] = ready;
+			}
+			watch->ready_count = kept;
+		}
+		if (follow->missing)
+			watch->missing_count--;
+	}
+	if (follow->file != NULL)
+		text_file_close(follow->file);
+	free(follow->path);
+	free(follow->buffer);
+
+	memset(follow, 0, sizeof(text_file_follow));
+}
+
+//
+// Implementations: CSV
+//
+
+// Read a CSV file into typed columns. The file is scanned 64 bytes at a time: delimiters, quotes and newlines are found
+// with SIMD compares, what is inside quotes is masked out with a running xor of the quote bits, and the fields between the
+// remaining delimiters and newlines are parsed with the number parsers of this file. Fields may be quoted ("a,b" and "a""b"),
+// lines may end with "\r\n" or "\n", and empty lines are skipped. If 'header' is true, the first row is kept in 'csv->names'.
+// Returns false if the file could not be opened or a field is bad; then 'csv->error_row' and 'csv->error_column' tell where.
+// Call text_file_close_csv(..) in both cases.
+bool text_file_read_csv(text_file_csv* csv, str filename, c8 delimiter, const text_file_column_type* types, i32 column_count, bool header)
+{
+	memset(csv, 0, sizeof(text_file_csv));
+	csv->delimiter = delimiter;
+	csv->column_count = column_count;
+	csv->header = header;
+	csv->error_row = -1;
+	csv->error_column = -1;
+
+	if (column_count <= 0 || !text_file_openfor_read_mapped(&csv->mapped, filename))
+		return false; // The file does not exist
+
+	csv->columns = (text_file_column*)calloc(column_count, sizeof(text_file_column));
+	csv->names = header ? (text_file_view*)calloc(column_count, sizeof(text_file_view)) : NULL;
+	if (csv->columns == NULL || (header && csv->names == NULL))
+	{
+		text_file_close_csv(csv);
+		return false; // Failed to allocate memory
+	}
+	for (i32 i = 0; i < column_count; i++)
+		csv->columns[i].type = types[i];
+
+	// Start with half of a guess of the number of rows, as text_file_csv_grow(..) doubles it
+	csv->row_capacity = (csv->mapped.length / (8 * column_count) + 16) / 2;
+	if (!text_file_csv_grow(csv))
+	{
+		text_file_close_csv(csv);
+		return false; // Failed to allocate memory
+	}
+
+	const c8* data = (const c8*)csv->mapped.data;
+	i64 length = csv->mapped.length;
+	i64 field_start = 0;
+	u64 inside = 0; // All ones if the previous block ended inside quotes
+	bool ok = true;
+
+	for (i64 block = 0; ok && block < length; block += 64)
+	{
+		const c8* bytes = data + block;
+		c8 padded[64];
+		if (length - block < 64)
+		{
+			// The last partial block. Zeroes are not structural.
+			memset(padded, 0, sizeof(padded));
+			memcpy(padded, bytes, length - block);
+			bytes = padded;
+		}
+
+		u64 quotes, delimiters, newlines;
+		text_file_csv_classify(bytes, delimiter, &quotes, &delimiters, &newlines);
+		u64 quoted = text_file_prefix_xor(quotes) ^ inside;
+		inside = (u64)((i64)quoted >> 63);
+		u64 structural = (delimiters | newlines) & ~quoted;
+
+		while (ok && structural != 0)
+		{
+			i64 position = block + text_file_trailing_zeros_u64(structural);
+			structural &= structural - 1;
+			ok = text_file_csv_field(csv, data + field_start, position - field_start, data[position] == '\n');
+			field_start = position + 1;
+		}
+	}
+
+	if (ok && inside != 0)
+	{
+		csv->error_row = csv->record;
+		csv->error_column = csv->column;
+		ok = false; // A quote is never closed
+	}
+	if (ok && (field_start < length || csv->column > 0))
+		ok = text_file_csv_field(csv, data + field_start, length - field_start, true); // The last line has no newline
+
+	return ok;
+}
+// Get the values of an i64 column. Returns NULL if the column has another type.
+i64* text_file_csv_i64(text_file_csv* csv, i32 column)
+{
+	return (csv->columns[column].type == TEXT_FILE_COLUMN_I64) ? (i64*)csv->columns[column].values : NULL;
+}
+// Get the values of an f64 column. Returns NULL if the column has another type.
+f64* text_file_csv_f64(text_file_csv* csv, i32 column)
+{
+	return (csv->columns[column].type == TEXT_FILE_COLUMN_F64) ? (f64*)csv->columns[column].values : NULL;
+}
+// Get the values of a bool column. Returns NULL if the column has another type.
+bool* text_file_csv_bool(text_file_csv* csv, i32 column)
+{
+	return (csv->columns[column].type == TEXT_FILE_COLUMN_BOOL) ? (bool*)csv->columns[column].values : NULL;
+}
+// Get the values of a string column. Returns NULL if the column has another type. The views are valid until text_file_close_csv(..).
+text_file_view* text_file_csv_string(text_file_csv* csv, i32 column)
+{
+	return (csv->columns[column].type == TEXT_FILE_COLUMN_STRING) ? (text_file_view*)csv->columns[column].values : NULL;
+}
+// Close a CSV file and release its columns
+void text_file_close_csv(text_file_csv* csv)
+{
+	if (csv->columns != NULL)
+	{
+		for (i32 i = 0; i < csv->column_count; i++)
+			free(csv->columns[i].values);
+		free(csv->columns);
+	}
+	free(csv->names);
+	while (csv->strings != NULL)
+	{
+		text_file_csv_block* next = csv->strings->next;
+		free(csv->strings);
+		csv->strings = next;
+	}
+	if (csv->mapped.file != NULL)
+		text_file_close_mapped(&csv->mapped);
+
+	memset(csv, 0, sizeof(text_file_csv));
+}
+// Get the masks of the quotes, delimiters and newlines of a 64 byte block. Bit i is set if byte i matches.
+void text_file_csv_classify(const c8* block, c8 delimiter, u64* quotes, u64* delimiters, u64* newlines)
+{
+#if TEXT_FILE_AVX2
+	__m256i quote32 = _mm256_set1_epi8('"');
+	__m256i delimiter32 = _mm256_set1_epi8((char)delimiter);
+	__m256i newline32 = _mm256_set1_epi8('\n');
+	__m256i low = _mm256_loadu_si256((const __m256i*)block);
+	__m256i high = _mm256_loadu_si256((const __m256i*)(block + 32));
+	*quotes = (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, quote32)) |
+		((u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, quote32)) << 32);
+	*delimiters = (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, delimiter32)) |
+		((u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, delimiter32)) << 32);
+	*newlines = (u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline32)) |
+		((u64)(u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline32)) << 32);
+#elif TEXT_FILE_SSE2
+	__m128i quote16 = _mm_set1_epi8('"');
+	__m128i delimiter16 = _mm_set1_epi8((char)delimiter);
+	__m128i newline16 = _mm_set1_epi8('\n');
+	*quotes = 0;
+	*delimiters = 0;
+	*newlines = 0;
+	for (i32 i = 0; i < 4; i++)
+	{
+		__m128i bytes = _mm_loadu_si128((const __m128i*)(block + i * 16));
+		*quotes |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, quote16)) << (i * 16);
+		*delimiters |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, delimiter16)) << (i * 16);
+		*newlines |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline16)) << (i * 16);
+	}
+#else
+	*quotes = 0;
+	*delimiters = 0;
+	*newlines = 0;
+	for (i32 i = 0; i < 64; i++)
+	{
+		*quotes |= (u64)(block[i] == '"') << i;
+		*delimiters |= (u64)(block[i] == delimiter) << i;
+		*newlines |= (u64)(block[i] == '\n') << i;
+	}
+#endif
+}
+// Double the number of rows the columns can hold
+bool text_file_csv_grow(text_file_csv* csv)
+{
+	i64 capacity = csv->row_capacity * 2;
+	for (i32 i = 0; i < csv->column_count; i++)
+	{
+		text_file_column* column = &csv->columns[i];
+		size_t size = (column->type == TEXT_FILE_COLUMN_STRING) ? sizeof(text_file_view) :
+			(column->type == TEXT_FILE_COLUMN_BOOL) ? sizeof(bool) : sizeof(i64);
+		void* values = realloc(column->values, capacity * size);
+		if (values == NULL)
+			return false; // Failed to allocate memory
+		column->values = values;
+	}
+	csv->row_capacity = capacity;
+
+	return true; // Success
+}
+// Replace the escaped quotes ("") of a quoted string. The result is copied into the string blocks of the CSV file.
+bool text_file_csv_unescape(text_file_view* view, text_file_csv* csv)
+{
+	text_file_csv_block* block = csv->strings;
+	if (block == NULL || block->capacity - block->used < view->length)
+	{
+		i64 capacity = (view->length > 64 * 1024) ? view->length : 64 * 1024;
+		block = (text_file_csv_block*)malloc(sizeof(text_file_csv_block) + capacity);
+		if (block == NULL)
+			return false; // Failed to allocate memory
+		block->next = csv->strings;
+		block->used = 0;
+		block->capacity = capacity;
+		csv->strings = block;
+	}
+
+	c8* text = (c8*)(block + 1) + block->used;
+	i64 length = 0;
+	for (i64 i = 0; i < view->length; i++)
+	{
+		text[length++] = view->text[i];
+		if (view->text[i] == '"' && i + 1 < view->length && view->text[i + 1] == '"')
+			i++; // Keep one of the two quotes
+	}
+	block->used += length;
+	view->text = text;
+	view->length = length;
+
+	return true; // Success
+}
+// Store a field that ends at a delimiter, or at a newline if 'end_of_row' is true
+bool text_file_csv_field(text_file_csv* csv, const c8* text, i64 length, bool end_of_row)
+{
+	if (end_of_row && length > 0 && text[length - 1] == '\r')
+		length--;
+	if (end_of_row && csv->column == 0 && length == 0)
+		return true; // Skip an empty line
+
+	if (csv->column >= csv->column_count)
+	{
+		csv->error_row = csv->record;
+		csv->error_column = csv->column;
+		return false; // Too many fields
+	}
+
+	// Take off the quotes
+	text_file_view view = { text, length };
+	bool quoted = (length >= 2 && text[0] == '"' && text[length - 1] == '"');
+	if (quoted)
+	{
+		view.text++;
+		view.length -= 2;
+	}
+
+	i64 row = csv->row_count;
+	text_file_column* column = &csv->columns[csv->column];
+	bool ok = true;
+	if (csv->header && csv->record == 0)
+	{
+		if (quoted && memchr(view.text, '"', view.length) != NULL)
+			ok = text_file_csv_unescape(&view, csv);
+		csv->names[csv->column] = view;
+	}
+	else if (column->type == TEXT_FILE_COLUMN_STRING)
+	{
+		if (quoted && memchr(view.text, '"', view.length) != NULL)
+			ok = text_file_csv_unescape(&view, csv);
+		((text_file_view*)column->values)[row] = view;
+	}
+	else
+	{
+		while (view.length > 0 && text_file_is_space(view.text[view.length - 1]))
+			view.length--;
+
+		i64 consumed = 0;
+		if (column->type == TEXT_FILE_COLUMN_I64)
+			ok = text_file_parse_signed(&((i64*)column->values)[row], LLONG_MIN, LLONG_MAX, view.text, view.length, &consumed);
+		else if (column->type == TEXT_FILE_COLUMN_F64)
+			ok = text_file_parse_f64(&((f64*)column->values)[row], view.text, view.length, &consumed);
+		else
+		{
+			// The same spellings as text_file_read_bool(..) plus "true" and "false" in any case
+			bool* value = &((bool*)column->values)[row];
+			consumed = view.length;
+			if (view.length == 1 && (view.text[0] == '0' || view.text[0] == '1'))
+				*value = (view.text[0] == '1');
+			else if (view.length == 4 && (view.text[0] | 0x20) == 't' && (view.text[1] | 0x20) == 'r' &&
+				(view.text[2] | 0x20) == 'u' && (view.text[3] | 0x20) == 'e')
+				*value = true;
+			else if (view.length == 5 && (view.text[0] | 0x20) == 'f' && (view.text[1] | 0x20) == 'a' &&
+				(view.text[2] | 0x20) == 'l' && (view.text[3] | 0x20) == 's' && (view.text[4] | 0x20) == 'e')
+				*value = false;
+			else
+				ok = false;
+		}
+		ok = ok && (consumed == view.length); // Nothing may follow the value
+	}
+
+	if (ok && end_of_row && csv->column != csv->column_count - 1)
+		ok = false; // Too few fields
+	if (!ok)
+	{
+		csv->error_row = csv->record;
+		csv->error_column = csv->column;
+		return false; // Bad field
+	}
+
+	if (!end_of_row)
+	{
+		csv->column++;
+		return true; // Success
+	}
+
+	// Next row
+	if (!(csv->header && csv->record == 0))
+		csv->row_count++;
+	csv->record++;
+	csv->column = 0;
+	if (csv->row_count == csv->row_capacity)
+		return text_file_csv_grow(csv);
+
+	return true; // Success
+}
+
+//
+// Implementations: Arrays
+//
+
+// Get the most chars a value of a type takes as text
+u8 text_file_type_width(text_file_type type)
+{
+	static const u8 widths[] = { 4, 6, 11, 20, 3, 5, 10, 20, TEXT_FILE_FLOAT_BUFFER, TEXT_FILE_FLOAT_BUFFER, 1, 0 };
+	return widths[type];
+}
+// Format element 'index' of an array of a type. Floats are formatted like text_file_format_f32(..) and text_file_format_f64(..).
+// Returns the number of chars written to 'buffer'.
+u8 text_file_format_value(text_file_type type, const void* data, i64 index, c8* buffer)
+{
+	switch (type)
+	{
+	case TEXT_FILE_TYPE_I8: return text_file_format_signed((signed char)((const i8*)data)[index], buffer);
+	case TEXT_FILE_TYPE_I16: return text_file_format_signed(((const i16*)data)[index], buffer);
+	case TEXT_FILE_TYPE_I32: return text_file_format_signed(((const i32*)data)[index], buffer);
+	case TEXT_FILE_TYPE_I64: return text_file_format_signed(((const i64*)data)[index], buffer);
+	case TEXT_FILE_TYPE_U8: return text_file_format_unsigned(((const u8*)data)[index], buffer);
+	case TEXT_FILE_TYPE_U16: return text_file_format_unsigned(((const u16*)data)[index], buffer);
+	case TEXT_FILE_TYPE_U32: return text_file_format_unsigned(((const u32*)data)[index], buffer);
+	case TEXT_FILE_TYPE_U64: return text_file_format_unsigned(((const u64*)data)[index], buffer);
+	case TEXT_FILE_TYPE_F32: return text_file_format_f32(((const f32*)data)[index], buffer);
+	case TEXT_FILE_TYPE_F64: return text_file_format_f64(((const f64*)data)[index], buffer);
+	case TEXT_FILE_TYPE_BOOL: buffer[0] = ((const bool*)data)[index] ? '1' : '0'; return 1;
+	case TEXT_FILE_TYPE_BYTE: return 0; // Not a value
+	}
+
+	return 0;
+}
+// Parse text into element 'index' of an array of a type. Leading white space is skipped. 'consumed' is set to the number of chars used.
+bool text_file_parse_value(text_file_type type, void* data, i64 index, const c8* text, i64 length, i64* consumed)
+{
+	i64 signed_value = 0;
+	u64 unsigned_value = 0;
+
+	switch (type)
+	{
+	case TEXT_FILE_TYPE_I8:
+		if (!text_file_parse_signed(&signed_value, SCHAR_MIN, SCHAR_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((i8*)data)[index] = (i8)signed_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_I16:
+		if (!text_file_parse_signed(&signed_value, SHRT_MIN, SHRT_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((i16*)data)[index] = (i16)signed_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_I32:
+		if (!text_file_parse_signed(&signed_value, INT_MIN, INT_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((i32*)data)[index] = (i32)signed_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_I64:
+		return text_file_parse_signed(&((i64*)data)[index], LLONG_MIN, LLONG_MAX, text, length, consumed);
+	case TEXT_FILE_TYPE_U8:
+		if (!text_file_parse_unsigned(&unsigned_value, UCHAR_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((u8*)data)[index] = (u8)unsigned_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_U16:
+		if (!text_file_parse_unsigned(&unsigned_value, USHRT_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((u16*)data)[index] = (u16)unsigned_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_U32:
+		if (!text_file_parse_unsigned(&unsigned_value, UINT_MAX, text, length, consumed))
+			return false; // Not a number or out of range
+		((u32*)data)[index] = (u32)unsigned_value;
+		return true; // Success
+	case TEXT_FILE_TYPE_U64:
+		return text_file_parse_unsigned(&((u64*)data)[index], ULLONG_MAX, text, length, consumed);
+	case TEXT_FILE_TYPE_F32:
+		return text_file_parse_f32(&((f32*)data)[index], text, length, consumed);
+	case TEXT_FILE_TYPE_F64:
+		return text_file_parse_f64(&((f64*)data)[index], text, length, consumed);
+	case TEXT_FILE_TYPE_BOOL:
+	{
+		i64 i = 0;
+		while (i < length && text_file_is_space(text[i]))
+			i++;
+		if (i == length || (text[i] != '0' && text[i] != '1'))
+			return false; // Not a bool
+		((bool*)data)[index] = (text[i] == '1');
+		if (consumed != NULL)
+			*consumed = i + 1;
+		return true; // Success
+	}
+	case TEXT_FILE_TYPE_BYTE:
+		return false; // Not a value
+	}
+
+	return false; // Unknown type
+}
+// Write an array of numbers as text with 'separator' (may be NULL) between them. The numbers are formatted into a large
+// block that is written with one I/O call, instead of one call per number.
+bool text_file_write_array(text_file_type type, const void* data, i64 count, str separator, text_file file)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_WRITE_ARRAY, file);
+	if (type == TEXT_FILE_TYPE_BYTE)
+		return false; // Use text_file_write_byte(..)
+
+	i64 separator_length = (separator != NULL) ? (i64)strlen((const char*)separator) : 0;
+	i64 width = text_file_type_width(type) + separator_length; // The most chars one number and its separator take
+
+	c8 stack[4096];
+	c8* buffer = stack;
+	i64 capacity = sizeof(stack);
+	if (count * width > capacity && width <= TEXT_FILE_ARRAY_BUFFER)
+	{
+		capacity = (count * width < TEXT_FILE_ARRAY_BUFFER) ? count * width : TEXT_FILE_ARRAY_BUFFER;
+		buffer = (c8*)malloc(capacity);
+		if (buffer == NULL)
+			return false; // Failed to allocate memory
+	}
+	else if (width > capacity)
+	{
+		return false; // The separator is too long
+	}
+
+	bool ok = true;
+	i64 used = 0;
+	for (i64 i = 0; ok && i < count; i++)
+	{
+		if (capacity - used < width)
+		{
+			ok = (text_file_io_write(buffer, sizeof(c8), used, file) == (size_t)used);
+			used = 0;
+		}
+		if (i > 0 && separator_length > 0)
+		{
+			memcpy(buffer + used, separator, separator_length);
+			used += separator_length;
+		}
+		used += text_file_format_value(type, data, i, buffer + used);
+	}
+	if (ok && used > 0)
+		ok = (text_file_io_write(buffer, sizeof(c8), used, file) == (size_t)used);
+
+	if (buffer != stack)
+		free(buffer);
+
+	return ok;
+}
+// Read an array of 'count' numbers separated by 'separator' (may be NULL). White space around the numbers and the separator
+// is skipped. The text is read and parsed in large blocks, and what was read past the last number is given back with a
+// relative seek. Returns false if there are fewer than 'count' numbers or one is out of range. Note: On Windows, open the
+// file in binary mode (or make the array the last thing in it), as relative seeks are not reliable in text mode.
+bool text_file_read_array(text_file_type type, void* data, i64 count, str separator, text_file file)
+{
+	TEXT_FILE_STATS_CALL(TEXT_FILE_CALL_READ_ARRAY, file);
+	if (type == TEXT_FILE_TYPE_BYTE)
+		return false; // Use text_file_read_byte(..)
+
+	const i64 token = 512; // Longest number (with white space and separator) that is parsed in one piece
+
+	// The separator without white space. When only white space is left, the numbers are separated by any white space.
+	const c8* separator_text = (separator != NULL) ? separator : (const c8*)"";
+	i64 separator_length = (i64)strlen((const char*)separator_text);
+	while (separator_length > 0 && text_file_is_space(separator_text[0]))
+	{
+		separator_text++;
+		separator_length--;
+	}
+	while (separator_length > 0 && text_file_is_space(separator_text[separator_length - 1]))
+		separator_length--;
+	if (separator_length > token / 2)
+		return false; // The separator is too long
+
+	// Estimate of the chars per number, so that the reads don't go far past the last one
+	i64 width = text_file_type_width(type) + separator_length + 2;
+
+	c8 stack[4096];
+	c8* buffer = stack;
+	i64 capacity = sizeof(stack);
+	if (count * width + token > capacity)
+	{
+		capacity = (count * width + token < TEXT_FILE_ARRAY_BUFFER) ? count * width + token : TEXT_FILE_ARRAY_BUFFER;
+		buffer = (c8*)malloc(capacity);
+		if (buffer == NULL)
+			return false; // Failed to allocate memory
+	}
+
+	bool ok = true;
+	bool eof = false;
+	i64 start = 0;
+	i64 end = 0;
+	for (i64 i = 0; ok && i < count; i++)
+	{
+		// Refill so that a whole number is in the buffer
+		if (end - start < token && !eof)
+		{
+			memmove(buffer, buffer + start, end - start);
+			end -= start;
+			start = 0;
+			i64 request = (count - i) * width + token;
+			if (request > capacity - end)
+				request = capacity - end;
+			i64 bytes = text_file_io_read(buffer + end, sizeof(c8), request, file);
+			if (bytes < request)
+				eof = true;
+			end += bytes;
+		}
+
+		const c8* text = buffer + start;
+		i64 length = end - start;
+		i64 at = 0;
+		if (i > 0 && separator_length > 0)
+		{
+			while (at < length && text_file_is_space(text[at]))
+				at++;
+			if (length - at < separator_length || memcmp(text + at, separator_text, separator_length) != 0)
+			{
+				ok = false; // Missing separator
+				break;
+			}
+			at += separator_length;
+		}
+
+		i64 consumed = 0;
+		ok = text_file_parse_value(type, data, i, text + at, length - at, &consumed);
+		start += at + consumed;
+	}
+
+	// Give back what was read past the last number
+	if (end > start && text_file_io_seek(file, -(end - start), SEEK_CUR) != 0)
+		ok = false;
+
+	if (buffer != stack)
+		free(buffer);
+
+	return ok;
+}
+// Write an array of 'i8' as text with 'separator' between the values
+bool text_file_write_i8_array(const i8* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_I8, data, count, separator, file);
+}
+// Write an array of 'i16' as text with 'separator' between the values
+bool text_file_write_i16_array(const i16* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_I16, data, count, separator, file);
+}
+// Write an array of 'i32' as text with 'separator' between the values
+bool text_file_write_i32_array(const i32* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_I32, data, count, separator, file);
+}
+// Write an array of 'i64' as text with 'separator' between the values
+bool text_file_write_i64_array(const i64* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_I64, data, count, separator, file);
+}
+// Write an array of 'u8' as text with 'separator' between the values
+bool text_file_write_u8_array(const u8* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_U8, data, count, separator, file);
+}
+// Write an array of 'u16' as text with 'separator' between the values
+bool text_file_write_u16_array(const u16* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_U16, data, count, separator, file);
+}
+// Write an array of 'u32' as text with 'separator' between the values
+bool text_file_write_u32_array(const u32* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_U32, data, count, separator, file);
+}
+// Write an array of 'u64' as text with 'separator' between the values
+bool text_file_write_u64_array(const u64* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_U64, data, count, separator, file);
+}
+// Write an array of 'f32' as text with 'separator' between the values
+bool text_file_write_f32_array(const f32* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_F32, data, count, separator, file);
+}
+// Write an array of 'f64' as text with 'separator' between the values
+bool text_file_write_f64_array(const f64* data, i64 count, str separator, text_file file)
+{
+	return text_file_write_array(TEXT_FILE_TYPE_F64, data, count, separator, file);
+}
+// Read an array of 'count' 'i8' separated by 'separator' from a text file
+bool text_file_read_i8_array(i8* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_I8, data, count, separator, file);
+}
+// Read an array of 'count' 'i16' separated by 'separator' from a text file
+bool text_file_read_i16_array(i16* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_I16, data, count, separator, file);
+}
+// Read an array of 'count' 'i32' separated by 'separator' from a text file
+bool text_file_read_i32_array(i32* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_I32, data, count, separator, file);
+}
+// Read an array of 'count' 'i64' separated by 'separator' from a text file
+bool text_file_read_i64_array(i64* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_I64, data, count, separator, file);
+}
+// Read an array of 'count' 'u8' separated by 'separator' from a text file
+bool text_file_read_u8_array(u8* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_U8, data, count, separator, file);
+}
+// Read an array of 'count' 'u16' separated by 'separator' from a text file
+bool text_file_read_u16_array(u16* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_U16, data, count, separator, file);
+}
+// Read an array of 'count' 'u32' separated by 'separator' from a text file
+bool text_file_read_u32_array(u32* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_U32, data, count, separator, file);
+}
+// Read an array of 'count' 'u64' separated by 'separator' from a text file
+bool text_file_read_u64_array(u64* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_U64, data, count, separator, file);
+}
+// Read an array of 'count' 'f32' separated by 'separator' from a text file
+bool text_file_read_f32_array(f32* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_F32, data, count, separator, file);
+}
+// Read an array of 'count' 'f64' separated by 'separator' from a text file
+bool text_file_read_f64_array(f64* data, i64 count, str separator, text_file file)
+{
+	return text_file_read_array(TEXT_FILE_TYPE_F64, data, count, separator, file);
+}
+
+//
+// Implementations: Records
+//
+
+// Compile a fixed width record format. Each record is the fields one after the other followed by 'terminator' (may be NULL,
+// at most 4 chars). The plan is what text_file_read_records(..) runs for each record; release it with text_file_record_plan_free(..).
+bool text_file_record_plan_compile(text_file_record_plan* plan, const text_file_record_field* fields, i32 field_count, str terminator)
+{
+	memset(plan, 0, sizeof(text_file_record_plan));
+
+	plan->terminator_length = (terminator != NULL) ? (i32)strlen((const char*)terminator) : 0;
+	if (plan->terminator_length > (i32)sizeof(plan->terminator))
+		return false; // The terminator is too long
+	if (terminator != NULL)
+		memcpy(plan->terminator, terminator, plan->terminator_length);
+
+	plan->steps = (text_file_record_step*)malloc((field_count > 0 ? field_count : 1) * sizeof(text_file_record_step));
+	if (plan->steps == NULL)
+		return false; // Failed to allocate memory
+
+	i32 position = 0;
+	for (i32 i = 0; i < field_count; i++)
+	{
+		const text_file_record_field* field = &fields[i];
+		if (field->width <= 0 || field->width > TEXT_FILE_ARRAY_BUFFER)
+		{
+			text_file_record_plan_free(plan);
+			return false; // Bad width
+		}
+		if (field->offset >= 0)
+		{
+			text_file_record_step* step = &plan->steps[plan->step_count++];
+			step->type = field->type;
+			step->position = position;
+			step->width = field->width;
+			step->offset = field->offset;
+		}
+		position += field->width;
+	}
+	plan->record_width = position + plan->terminator_length;
+	if (plan->record_width == 0)
+	{
+		text_file_record_plan_free(plan);
+		return false; // Empty record
+	}
+
+	return true; // Success
+}
+// Release a record plan
+void text_file_record_plan_free(text_file_record_plan* plan)
+{
+	free(plan->steps);
+	memset(plan, 0, sizeof(text_file_record_plan));
+}
+// Parse the text of one record ('plan->record_width' chars) into a record struct. A number field may have white space
+// before and after the value, but nothing else: "  1x2" is a bad field, not 1.
+bool text_file_parse_record(void* record, const text_file_record_plan* plan, const c8* text)
+{
+	for (i32 i = 0; i < plan->step_count; i++)
+	{
+		const text_file_record_step* step = &plan->steps[i];
+		byte* destination = (byte*)record + step->offset;
+		const c8* field = text + step->position;
+		if (step->type == TEXT_FILE_TYPE_BYTE)
+		{
+			memcpy(destination, field, step->width);
+			continue;
+		}
+
+		i64 consumed = 0;
+		if (!text_file_parse_value(step->type, destination, 0, field, step->width, &consumed))
+			return false; // Bad field
+		while (consumed < step->width && text_file_is_space(field[consumed]))
+			consumed++;
+		if (consumed != step->width)
+			return false; // Something follows the value
+	}
+
+	return true; // Success
+}
+// Read one record into a record struct
+bool text_file_read_record(void* record, const text_file_record_plan* plan, text_file file)
+{
+	return text_file_read_records(record, 1, 0, plan, file);
+}
+// Read 'count' records into an array of record structs of 'record_size' bytes each. The records are read in blocks of
+// up to TEXT_FILE_ARRAY_BUFFER chars with one I/O call per block, instead of one per field. The terminator of the last
+// record may be missing at the end of the file. Returns false if there are fewer records, a field is bad or a terminator is wrong.
+bool text_file_read_records(void* records, i64 count, i64 record_size, const text_file_record_plan* plan, text_file file)
+{
+	i64 width = plan->record_width;
+	i64 per_block = TEXT_FILE_ARRAY_BUFFER / width;
+	if (per_block < 1)
+		per_block = 1;
+	if (per_block > count)
+		per_block = count;
+
+	c8 stack[4096];
+	c8* buffer = stack;
+	if (per_block * width > (i64)sizeof(stack))
+	{
+		buffer = (c8*)malloc(per_block * width);
+		if (buffer == NULL)
+			return false; // Failed to allocate memory
+	}
+
+	bool ok = true;
+	for (i64 done = 0; ok && done < count; done += per_block)
+	{
+		i64 records_left = count - done;
+		i64 block = (records_left < per_block) ? records_left : per_block;
+		i64 request = block * width;
+		i64 bytes = text_file_io_read(buffer, sizeof(c8), request, file);
+		if (bytes == request - plan->terminator_length && done + block == count)
+			memcpy(buffer + bytes, plan->terminator, plan->terminator_length); // The end of the file
+		else if (bytes != request)
+			ok = false; // Too few records
+
+		for (i64 i = 0; ok && i < block; i++)
+		{
+			const c8* text = buffer + i * width;
+			ok = (memcmp(text + width - plan->terminator_length, plan->terminator, plan->terminator_length) == 0) &&
+				text_file_parse_record((byte*)records + (done + i) * record_size, plan, text);
+		}
+	}
+
+	if (buffer != stack)
+		free(buffer);
+
+	return ok;
+}
+
+//
+// Implementations: Copy
+//
+
+// Copy a whole text file. The destination is created or truncated. The data doesn't pass through user space where the OS
+// allows it: CopyFile on Windows, and a reflink (copy on write clone), copy_file_range(..) or sendfile(..) on Linux.
+// The memory use is constant in any case. Returns false if the source does not exist or the copy failed.
+bool text_file_copy(str source, str destination)
+{
+#if defined(_WIN32)
+	return (CopyFileA((const char*)source, (const char*)destination, FALSE) != 0);
+#else
+	text_file in = fopen((const char*)source, "rb");
+	if (in == NULL)
+		return false; // The source does not exist
+
+	struct stat info;
+	if (fstat(fileno(in), &info) != 0)
+	{
+		text_file_close(in);
+		return false; // Failed to get the file size
+	}
+
+	// Opening the destination truncates it, which would destroy a source that is the same file under another name
+	struct stat existing;
+	if (stat((const char*)destination, &existing) == 0 && existing.st_dev == info.st_dev && existing.st_ino == info.st_ino)
+	{
+		text_file_close(in);
+		return false; // The destination is the source
+	}
+
+	text_file out = fopen((const char*)destination, "wb");
+	if (out == NULL)
+	{
+		text_file_close(in);
+		return false; // Failed to create the destination
+	}
+	fchmod(fileno(out), info.st_mode & 07777); // Keep the permissions
+
+	bool ok = false;
+	if (!S_ISREG(info.st_mode) || info.st_size == 0)
+		ok = text_file_copy_stream(in, out); // A pipe or a file like the ones in /proc (length 0) has no length to copy
+	else
+	{
+#if defined(__linux__)
+		// A reflink shares the blocks instead of copying them (btrfs, XFS, ..). Instant for any file size.
+		ok = (ioctl(fileno(out), FICLONE, fileno(in)) == 0);
+#endif
+		if (!ok)
+			ok = text_file_copy_range(in, 0, (file_size)info.st_size, out, 0);
+	}
+
+	text_file_close(in);
+	if (fclose(out) != 0)
+		ok = false; // Failed to write the rest of the destination
+
+	return ok;
+#endif
+}
+// Copy 'length' bytes at 'source_position' of one text file to 'destination_position' of another. The file positions
+// of both files are kept. Uses copy_file_range(..) and then sendfile(..) on Linux and falls back to a chunked copy.
+// Returns false if the source ends before 'length' bytes or the copy failed.
+bool text_file_copy_range(text_file source, file_size source_position, file_size length, text_file destination, file_size destination_position)
+{
+	if (length <= 0)
+		return (length == 0);
+
+#if defined(__linux__)
+	// Write out anything buffered so that the kernel sees the same contents as the streams
+	if (fflush(destination) != 0 || fflush(source) != 0)
+		return false; // Something went wrong while trying to write the data
+
+	int in = fileno(source);
+	int out = fileno(destination);
+	off_t in_position = (off_t)source_position;
+	off_t out_position = (off_t)destination_position;
+	file_size left = length;
+
+	// copy_file_range(..) copies within the kernel or the file system (server side copy on NFS and SMB)
+	while (TEXT_FILE_GNU && left > 0)
+	{
+		size_t request = (left > (1 << 30)) ? (1 << 30) : (size_t)left;
+#if TEXT_FILE_GNU
+		ssize_t bytes = copy_file_range(in, &in_position, out, &out_position, request, 0);
+#else
+		ssize_t bytes = -1; // Not declared
+		errno = ENOSYS;
+#endif
+		if (bytes < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP || errno == EBADF)
+				break; // Not supported between these files. Try sendfile(..).
+			return false; // Something went wrong while trying to copy the data
+		}
+		if (bytes == 0)
+			return false; // The source ended early
+		left -= bytes;
+	}
+
+	// sendfile(..) still copies in the kernel, but it writes at the file offset of 'out', so move it there and back
+	off_t out_offset = lseek(out, 0, SEEK_CUR);
+	if (left > 0 && out_offset >= 0 && lseek(out, out_position, SEEK_SET) == out_position)
+	{
+		bool failed = false;
+		while (left > 0)
+		{
+			size_t request = (left > (1 << 30)) ? (1 << 30) : (size_t)left;
+			ssize_t bytes = sendfile(out, in, &in_position, request);
+			if (bytes < 0 && errno == EINTR)
+				continue;
+			if (bytes <= 0)
+			{
+				failed = (bytes == 0 || (errno != EINVAL && errno != ENOSYS));
+				break;
+			}
+			left -= bytes;
+			out_position += bytes;
+		}
+		if (lseek(out, out_offset, SEEK_SET) != out_offset || failed)
+			return false; // Something went wrong while trying to copy the data
+	}
+	if (left == 0)
+		return true; // Success
+
+	return text_file_copy_chunked(source, (file_size)in_position, left, destination, (file_size)out_position);
+#else
+	return text_file_copy_chunked(source, source_position, length, destination, destination_position);
+#endif
+}
+// Copy a range of one text file to another through a buffer of TEXT_FILE_COPY_CHUNK bytes. The file positions of both files are kept.
+bool text_file_copy_chunked(text_file source, file_size source_position, file_size length, text_file destination, file_size destination_position)
+{
+	file_size source_saved = _ftelli64(source);
+	file_size destination_saved = _ftelli64(destination);
+	if (source_saved < 0 || destination_saved < 0)
+		return false; // Not a seekable file
+
+	byte* buffer = (byte*)malloc(TEXT_FILE_COPY_CHUNK);
+	if (buffer == NULL)
+		return false; // Failed to allocate memory
+
+	bool ok = (_fseeki64(source, source_position, SEEK_SET) == 0 && _fseeki64(destination, destination_position, SEEK_SET) == 0);
+	while (ok && length > 0)
+	{
+		size_t request = (length > TEXT_FILE_COPY_CHUNK) ? TEXT_FILE_COPY_CHUNK : (size_t)length;
+		size_t bytes = fread(buffer, sizeof(byte), request, source);
+		ok = (bytes == request && fwrite(buffer, sizeof(byte), bytes, destination) == bytes);
+		length -= (file_size)bytes;
+	}
+	free(buffer);
+
+	// Restore the positions. The destination is flushed first so that the data lands where it was written.
+	if (fflush(destination) != 0)
+		ok = false;
+	if (_fseeki64(source, source_saved, SEEK_SET) != 0 || _fseeki64(destination, destination_saved, SEEK_SET) != 0)
+		ok = false;
+
+	return ok;
+}
+// Copy the rest of a text file to another until the end of the file, through a buffer of TEXT_FILE_COPY_CHUNK bytes.
+// For files that can not seek or have no length (pipes, /proc, ..).
+bool text_file_copy_stream(text_file source, text_file destination)
+{
+	byte* buffer = (byte*)malloc(TEXT_FILE_COPY_CHUNK);
+	if (buffer == NULL)
+		return false; // Failed to allocate memory
+
+	bool ok = true;
+	size_t bytes;
+	while (ok && (bytes = fread(buffer, sizeof(byte), TEXT_FILE_COPY_CHUNK, source)) > 0)
+		ok = (fwrite(buffer, sizeof(byte), bytes, destination) == bytes);
+	if (ferror(source))
+		ok = false; // Something went wrong while trying to read the data
+	free(buffer);
+
+	return ok;
+}
+
+//
+// Implementations: Statistics
+//
+
+#if TEXT_FILE_STATS
+// Number of handles that can have statistics at the same time
+#define TEXT_FILE_STATS_SLOTS 256
+
+// The statistics of one handle. 'key' is the handle, 0 for a free slot and -1 for a released one.
+typedef struct text_file_stats_slot
+{
+	volatile i64 key;
+	FILE* dump;
+	text_file_stats stats;
+} text_file_stats_slot;
+
+static text_file_stats_slot text_file_stats_slots[TEXT_FILE_STATS_SLOTS];
+static volatile i64 text_file_stats_lock;
+
+// Get the first slot to probe for a handle
+u32 text_file_stats_hash(text_file file)
+{
+	return (u32)((((u64)(size_t)file >> 4) * 0x9E3779B97F4A7C15ULL) >> 56) % TEXT_FILE_STATS_SLOTS;
+}
+// Get the statistics of a handle. Returns NULL if they are not enabled for it.
+// Lookups don't lock; only text_file_stats_enable(..) and text_file_stats_release(..) change the slots.
+text_file_stats* text_file_stats_find(text_file file)
+{
+	u32 slot = text_file_stats_hash(file);
+	for (u32 i = 0; i < TEXT_FILE_STATS_SLOTS; i++)
+	{
+		text_file_stats_slot* entry = &text_file_stats_slots[(slot + i) % TEXT_FILE_STATS_SLOTS];
+		i64 key = text_file_atomic_load_i64(&entry->key);
+		if (key == (i64)(size_t)file)
+			return &entry->stats;
+		if (key == 0)
+			return NULL; // Not found
+	}
+
+	return NULL; // Not found
+}
+// Count a call of a function
+void text_file_stats_call(text_file_call call, text_file file)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats != NULL)
+		stats->calls[call]++;
+}
+// Add the time since 'start' to the formatting and parsing time
+void text_file_stats_convert(u64 start, text_file file)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats != NULL)
+		stats->convert_ns += text_file_clock_ns() - start;
+}
+// Count an I/O call of 'bytes' bytes that took the time since 'start'
+void text_file_stats_io(text_file_stats* stats, i64 bytes, u64 start)
+{
+	stats->io_ns += text_file_clock_ns() - start;
+	u8 bucket = text_file_bit_length((u64)bytes);
+	if (bucket >= TEXT_FILE_STATS_BUCKETS)
+		bucket = TEXT_FILE_STATS_BUCKETS - 1;
+	stats->sizes[bucket]++;
+}
+// fread(..) that counts the call in the statistics of the handle
+size_t text_file_io_read(void* data, size_t size, size_t count, text_file file)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats == NULL)
+		return fread(data, size, count, file);
+
+	u64 start = text_file_clock_ns();
+	size_t result = fread(data, size, count, file);
+	stats->read_calls++;
+	stats->bytes_read += (i64)(result * size);
+	text_file_stats_io(stats, (i64)(count * size), start);
+
+	return result;
+}
+// fwrite(..) that counts the call in the statistics of the handle
+size_t text_file_io_write(const void* data, size_t size, size_t count, text_file file)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats == NULL)
+		return fwrite(data, size, count, file);
+
+	u64 start = text_file_clock_ns();
+	size_t result = fwrite(data, size, count, file);
+	stats->write_calls++;
+	stats->bytes_written += (i64)(result * size);
+	text_file_stats_io(stats, (i64)(count * size), start);
+
+	return result;
+}
+// _fseeki64(..) that counts the call in the statistics of the handle
+int text_file_io_seek(text_file file, file_size offset, int origin)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats == NULL)
+		return _fseeki64(file, offset, origin);
+
+	u64 start = text_file_clock_ns();
+	int result = _fseeki64(file, offset, origin);
+	stats->seek_calls++;
+	stats->io_ns += text_file_clock_ns() - start;
+
+	return result;
+}
+// Take or give back the lock of the slots
+void text_file_stats_lock_slots(bool lock)
+{
+	if (!lock)
+	{
+		text_file_atomic_store_i64(&text_file_stats_lock, 0);
+		return;
+	}
+	while (!text_file_atomic_cas_i64(&text_file_stats_lock, 0, 1))
+		text_file_yield();
+}
+// Drop the statistics of a handle that is being closed. They are printed first if a dump stream was given.
+void text_file_stats_release(text_file file)
+{
+	text_file_stats* stats = text_file_stats_find(file);
+	if (stats == NULL)
+		return; // Not enabled for this handle
+
+	text_file_stats_slot* entry = (text_file_stats_slot*)((byte*)stats - offsetof(text_file_stats_slot, stats));
+	if (entry->dump != NULL)
+	{
+		fprintf(entry->dump, "text_file %p:\n", (void*)file);
+		text_file_stats_print(stats, entry->dump);
+	}
+
+	text_file_stats_lock_slots(true);
+	text_file_atomic_store_i64(&entry->key, -1); // Keep probing past it
+	text_file_stats_lock_slots(false);
+}
+#endif
+
+// Turn on the statistics for a text file. They are printed to 'dump' (if not NULL) when the file is closed.
+// Returns false if TEXT_FILE_STATS is not defined to 1 or too many handles have statistics.
+bool text_file_stats_enable(text_file file, FILE* dump)
+{
+#if TEXT_FILE_STATS
+	if (text_file_stats_find(file) != NULL)
+		return true; // Already enabled
+
+	text_file_stats_lock_slots(true);
+	u32 slot = text_file_stats_hash(file);
+	for (u32 i = 0; i < TEXT_FILE_STATS_SLOTS; i++)
+	{
+		text_file_stats_slot* entry = &text_file_stats_slots[(slot + i) % TEXT_FILE_STATS_SLOTS];
+		if (entry->key == 0 || entry->key == -1)
+		{
+			memset(&entry->stats, 0, sizeof(text_file_stats));
+			entry->dump = dump;
+			text_file_atomic_store_i64(&entry->key, (i64)(size_t)file); // Publish it after it is set up
+			text_file_stats_lock_slots(false);
+			return true; // Success
+		}
+	}
+	text_file_stats_lock_slots(false);
+
+	return false; // All slots are taken
+#else
+	(void)file;
+	(void)dump;
+	return false; // Not compiled in
+#endif
+}
+// Get a copy of the statistics of a text file. Returns false if they are not enabled for it.
+bool text_file_get_stats(text_file_stats* stats, text_file file)
+{
+	memset(stats, 0, sizeof(text_file_stats));
+#if TEXT_FILE_STATS
+	text_file_stats* source = text_file_stats_find(file);
+	if (source == NULL)
+		return false; // Not enabled for this handle
+
+	memcpy(stats, source, sizeof(text_file_stats));
+	return true; // Success
+#else
+	(void)file;
+	return false; // Not compiled in
+#endif
+}
+// Print statistics in a human readable form
+void text_file_stats_print(const text_file_stats* stats, FILE* out)
+{
+	static const char* names[TEXT_FILE_CALL_COUNT] =
+	{
+		"write_i8", "write_i16", "write_i32", "write_i64", "write_u8", "write_u16", "write_u32", "write_u64",
+		"write_f32", "write_f64", "write_f32_shortest", "write_f64_shortest", "write_bool", "write_byte", "write_str",
+		"read_i8", "read_i16", "read_i32", "read_i64", "read_u8", "read_u16", "read_u32", "read_u64",
+		"read_f32", "read_f64", "read_bool", "read_byte", "read_str", "read_line", "set_position", "get_position",
+		"write_array", "read_array"
+	};
+
+	fprintf(out, "  read:    %lld bytes in %lld calls\n", stats->bytes_read, stats->read_calls);
+	fprintf(out, "  written: %lld bytes in %lld calls\n", stats->bytes_written, stats->write_calls);
+	fprintf(out, "  seeks:   %lld\n", stats->seek_calls);
+	fprintf(out, "  time:    %.3f ms I/O, %.3f ms formatting and parsing\n", stats->io_ns / 1e6, stats->convert_ns / 1e6);
+	for (i32 i = 0; i < TEXT_FILE_CALL_COUNT; i++)
+	{
+		if (stats->calls[i] > 0)
+			fprintf(out, "  %-20s %lld calls\n", names[i], stats->calls[i]);
+	}
+	for (i32 i = 0; i < TEXT_FILE_STATS_BUCKETS; i++)
+	{
+		if (stats->sizes[i] == 0)
+			continue;
+		u64 low = (i == 0) ? 0 : (1ULL << (i - 1));
+		u64 high = (i == 0) ? 0 : (1ULL << i) - 1;
+		if (i == TEXT_FILE_STATS_BUCKETS - 1)
+			fprintf(out, "  I/O of %llu+ bytes: %lld\n", low, stats->sizes[i]);
+		else
+			fprintf(out, "  I/O of %llu-%llu bytes: %lld\n", low, high, stats->sizes[i]);
+	}
+}
+
+//
+// C++ layer (C++17 and later)
+//
+// Move-only RAII handles over the C functions, and read<T>/write<T> that pick the C function for each type at compile
+// time with if constexpr. Text goes in and out as std::string_view, and arrays as std::span (C++20) or pointer and count.
+// Floats are written in their shortest round trip form, so no printf is involved.
+//
+#if defined(__cplusplus) && (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#define TEXT_FILE_CPP 1
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#define TEXT_FILE_CPP_SPAN 1
+#include <span>
+#else
+#define TEXT_FILE_CPP_SPAN 0
+#endif
+
+namespace text_files
+{
+	template <typename T>
+	inline constexpr bool unsupported_type = false;
+
+	// The text_file_type of a C++ type. Arrays of chars are copied as they are (records only).
+	template <typename T>
+	constexpr text_file_type type_of()
+	{
+		using U = std::remove_cv_t<T>;
+		if constexpr (std::is_same_v<U, bool>)
+			return TEXT_FILE_TYPE_BOOL;
+		else if constexpr (std::is_same_v<U, char>)
+			return TEXT_FILE_TYPE_I8; // i8 is char
+		else if constexpr (std::is_floating_point_v<U> && sizeof(U) == sizeof(f32))
+			return TEXT_FILE_TYPE_F32;
+		else if constexpr (std::is_floating_point_v<U> && sizeof(U) == sizeof(f64))
+			return TEXT_FILE_TYPE_F64;
+		else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+			return (sizeof(U) == 1) ? TEXT_FILE_TYPE_I8 : (sizeof(U) == 2) ? TEXT_FILE_TYPE_I16 : (sizeof(U) == 4) ? TEXT_FILE_TYPE_I32 : TEXT_FILE_TYPE_I64;
+		else if constexpr (std::is_integral_v<U>)
+			return (sizeof(U) == 1) ? TEXT_FILE_TYPE_U8 : (sizeof(U) == 2) ? TEXT_FILE_TYPE_U16 : (sizeof(U) == 4) ? TEXT_FILE_TYPE_U32 : TEXT_FILE_TYPE_U64;
+		else if constexpr (std::is_array_v<U> && sizeof(std::remove_extent_t<U>) == 1)
+			return TEXT_FILE_TYPE_BYTE;
+		else
+			static_assert(unsupported_type<T>, "text_file.h has no formatter or parser for this type");
+	}
+
+	// Write a number or bool with the formatter of its type
+	template <typename T>
+	bool write_value(T value, text_file handle)
+	{
+		constexpr text_file_type type = type_of<T>();
+		if constexpr (type == TEXT_FILE_TYPE_BOOL)
+			return text_file_write_bool(value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_I8)
+			return text_file_write_i8((i8)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_I16)
+			return text_file_write_i16((i16)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_I32)
+			return text_file_write_i32((i32)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_I64)
+			return text_file_write_i64((i64)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_U8)
+			return text_file_write_u8((u8)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_U16)
+			return text_file_write_u16((u16)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_U32)
+			return text_file_write_u32((u32)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_U64)
+			return text_file_write_u64((u64)value, handle);
+		else if constexpr (type == TEXT_FILE_TYPE_F32)
+			return text_file_write_f32_shortest((f32)value, handle);
+		else
+			return text_file_write_f64_shortest((f64)value, handle);
+	}
+	// Read a number of 'length' chars, or a bool, with the parser of its type
+	template <typename T>
+	bool read_value(T& value, u8 length, text_file handle)
+	{
+		constexpr text_file_type type = type_of<T>();
+		bool ok = false;
+		if constexpr (type == TEXT_FILE_TYPE_BOOL)
+		{
+			(void)length;
+			return text_file_read_bool(&value, handle);
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_I8 || type == TEXT_FILE_TYPE_I16 || type == TEXT_FILE_TYPE_I32 || type == TEXT_FILE_TYPE_I64)
+		{
+			i64 parsed = 0;
+			i64 min = (type == TEXT_FILE_TYPE_I8) ? SCHAR_MIN : (type == TEXT_FILE_TYPE_I16) ? SHRT_MIN : (type == TEXT_FILE_TYPE_I32) ? INT_MIN : LLONG_MIN;
+			i64 max = (type == TEXT_FILE_TYPE_I8) ? SCHAR_MAX : (type == TEXT_FILE_TYPE_I16) ? SHRT_MAX : (type == TEXT_FILE_TYPE_I32) ? INT_MAX : LLONG_MAX;
+			ok = text_file_read_signed(&parsed, min, max, length, 20, handle);
+			value = (T)parsed;
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_U8 || type == TEXT_FILE_TYPE_U16 || type == TEXT_FILE_TYPE_U32 || type == TEXT_FILE_TYPE_U64)
+		{
+			u64 parsed = 0;
+			u64 max = (type == TEXT_FILE_TYPE_U8) ? UCHAR_MAX : (type == TEXT_FILE_TYPE_U16) ? USHRT_MAX : (type == TEXT_FILE_TYPE_U32) ? UINT_MAX : ULLONG_MAX;
+			ok = text_file_read_unsigned(&parsed, max, length, 20, handle);
+			value = (T)parsed;
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_F32)
+		{
+			f32 parsed = 0;
+			ok = text_file_read_f32(&parsed, length, handle);
+			value = (T)parsed;
+		}
+		else
+		{
+			f64 parsed = 0;
+			ok = text_file_read_f64(&parsed, length, handle);
+			value = (T)parsed;
+		}
+		return ok;
+	}
+	// Read a number of 'length' chars, or a bool, at 'position'. Thread safe, see text_file_pread(..).
+	template <typename T>
+	bool read_value_at(T& value, u8 length, file_size position, text_file handle)
+	{
+		constexpr text_file_type type = type_of<T>();
+		bool ok = false;
+		if constexpr (type == TEXT_FILE_TYPE_BOOL)
+		{
+			(void)length;
+			return text_file_read_bool_at(&value, position, handle);
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_I8 || type == TEXT_FILE_TYPE_I16 || type == TEXT_FILE_TYPE_I32 || type == TEXT_FILE_TYPE_I64)
+		{
+			i64 parsed = 0;
+			i64 min = (type == TEXT_FILE_TYPE_I8) ? SCHAR_MIN : (type == TEXT_FILE_TYPE_I16) ? SHRT_MIN : (type == TEXT_FILE_TYPE_I32) ? INT_MIN : LLONG_MIN;
+			i64 max = (type == TEXT_FILE_TYPE_I8) ? SCHAR_MAX : (type == TEXT_FILE_TYPE_I16) ? SHRT_MAX : (type == TEXT_FILE_TYPE_I32) ? INT_MAX : LLONG_MAX;
+			ok = text_file_read_signed_at(&parsed, min, max, length, 20, position, handle);
+			value = (T)parsed;
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_U8 || type == TEXT_FILE_TYPE_U16 || type == TEXT_FILE_TYPE_U32 || type == TEXT_FILE_TYPE_U64)
+		{
+			u64 parsed = 0;
+			u64 max = (type == TEXT_FILE_TYPE_U8) ? UCHAR_MAX : (type == TEXT_FILE_TYPE_U16) ? USHRT_MAX : (type == TEXT_FILE_TYPE_U32) ? UINT_MAX : ULLONG_MAX;
+			ok = text_file_read_unsigned_at(&parsed, max, length, 20, position, handle);
+			value = (T)parsed;
+		}
+		else if constexpr (type == TEXT_FILE_TYPE_F32)
+		{
+			f32 parsed = 0;
+			ok = text_file_read_f32_at(&parsed, length, position, handle);
+			value = (T)parsed;
+		}
+		else
+		{
+			f64 parsed = 0;
+			ok = text_file_read_f64_at(&parsed, length, position, handle);
+			value = (T)parsed;
+		}
+		return ok;
+	}
+
+	// A text file that is closed when it goes out of scope
+	class file
+	{
+	public:
+		file() noexcept = default;
+		explicit file(text_file handle) noexcept : handle_(handle) {}
+		file(const file&) = delete;
+		file& operator=(const file&) = delete;
+		file(file&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+		file& operator=(file&& other) noexcept
+		{
+			if (this != &other)
+			{
+				close();
+				handle_ = std::exchange(other.handle_, nullptr);
+			}
+			return *this;
+		}
+		~file() { close(); }
+
+		static file open_read(const std::string& filename) { return file(text_file_openfor_read((str)filename.c_str())); }
+		static file open_write_new(const std::string& filename) { return file(text_file_openfor_write_new((str)filename.c_str())); }
+		static file open_write_append(const std::string& filename) { return file(text_file_openfor_write_append((str)filename.c_str())); }
+
+		explicit operator bool() const noexcept { return handle_ != nullptr; }
+		text_file handle() const noexcept { return handle_; }
+		text_file release() noexcept { return std::exchange(handle_, nullptr); }
+		void close() noexcept
+		{
+			if (handle_ != nullptr)
+				text_file_close(std::exchange(handle_, nullptr));
+		}
+
+		// Numbers and bools
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+		bool write(T value) { return write_value(value, handle_); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+		bool read(T& value, u8 length) { return read_value(value, length, handle_); }
+		bool read(bool& value) { return text_file_read_bool(&value, handle_); }
+		template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T>>>
+		bool read_at(T& value, u8 length, file_size position) const { return read_value_at(value, length, position, handle_); }
+		bool read_at(bool& value, file_size position) const { return text_file_read_bool_at(&value, position, handle_); }
+
+		// Text, without strlen(..) or a copy
+		bool write(std::string_view text) { return text_file_write_byte((byte*)text.data(), (i64)text.size(), handle_); }
+		bool write(const char* text) { return write(std::string_view(text)); }
+		// Read up to 'length' chars into 'text'. It is shorter at the end of the file.
+		bool read(std::string& text, i64 length)
+		{
+			text.resize((size_t)length);
+			i64 bytes = (i64)text_file_io_read(text.data(), sizeof(char), (size_t)length, handle_);
+			text.resize((size_t)bytes);
+			return ferror(handle_) == 0;
+		}
+		bool read_at(std::string& text, i64 length, file_size position) const
+		{
+			text.resize((size_t)length);
+			i64 bytes = 0;
+			bool ok = text_file_pread(text.data(), length, position, &bytes, handle_);
+			text.resize((size_t)bytes);
+			return ok;
+		}
+		bool read(byte* data, i64 length) { return text_file_read_byte(data, length, handle_); }
+
+		// Arrays of numbers, one I/O call per block
+		template <typename T>
+		bool write_array(const T* values, i64 count, const char* separator) { return text_file_write_array(type_of<T>(), values, count, (str)separator, handle_); }
+		template <typename T>
+		bool read_array(T* values, i64 count, const char* separator) { return text_file_read_array(type_of<T>(), values, count, (str)separator, handle_); }
+#if TEXT_FILE_CPP_SPAN
+		bool read(std::span<byte> data) { return read(data.data(), (i64)data.size()); }
+		template <typename T>
+		bool write_array(std::span<const T> values, const char* separator) { return write_array(values.data(), (i64)values.size(), separator); }
+		template <typename T>
+		bool read_array(std::span<T> values, const char* separator) { return read_array(values.data(), (i64)values.size(), separator); }
+#endif
+
+		file_size position() const { return text_file_get_position(handle_); }
+		bool seek(file_size position) { return text_file_set_position(position, handle_); }
+		bool seek_relative(file_size offset) { return text_file_set_position_relative(offset, handle_); }
+		bool seek_begin() { return text_file_set_position_begin(handle_); }
+		bool seek_end() { return text_file_set_position_end(handle_); }
+
+	private:
+		text_file handle_ = nullptr;
+	};
+
+	// A memory mapped text file seen as one std::string_view
+	class mapped
+	{
+	public:
+		mapped() noexcept = default;
+		explicit mapped(const std::string& filename) { open_ = text_file_openfor_read_mapped(&mapped_, (str)filename.c_str()); }
+		mapped(const mapped&) = delete;
+		mapped& operator=(const mapped&) = delete;
+		mapped(mapped&& other) noexcept : mapped_(other.mapped_), open_(std::exchange(other.open_, false)) {}
+		mapped& operator=(mapped&& other) noexcept
+		{
+			if (this != &other)
+			{
+				close();
+				mapped_ = other.mapped_;
+				open_ = std::exchange(other.open_, false);
+			}
+			return *this;
+		}
+		~mapped() { close(); }
+
+		explicit operator bool() const noexcept { return open_; }
+		std::string_view view() const noexcept { return open_ ? std::string_view((const char*)mapped_.data, (size_t)mapped_.length) : std::string_view(); }
+		text_file_mapped* get() noexcept { return &mapped_; }
+		void close() noexcept
+		{
+			if (std::exchange(open_, false))
+				text_file_close_mapped(&mapped_);
+		}
+
+	private:
+		text_file_mapped mapped_ = {};
+		bool open_ = false;
+	};
+
+	// Reads a text file one line at a time. The lines are views into the reader's buffer, valid until the next call.
+	class line_reader
+	{
+	public:
+		explicit line_reader(const std::string& filename, i64 buffer_size = 0) { open_ = text_file_openfor_read_lines(&reader_, (str)filename.c_str(), buffer_size); }
+		line_reader(const line_reader&) = delete;
+		line_reader& operator=(const line_reader&) = delete;
+		line_reader(line_reader&& other) noexcept : reader_(other.reader_), open_(std::exchange(other.open_, false)) {}
+		~line_reader()
+		{
+			if (open_)
+				text_file_close_lines(&reader_);
+		}
+
+		explicit operator bool() const noexcept { return open_; }
+		bool next(std::string_view& line)
+		{
+			c8* data;
+			i64 length;
+			if (!open_ || !text_file_read_line(&data, &length, &reader_))
+				return false; // End of the file
+			line = std::string_view((const char*)data, (size_t)length);
+			return true;
+		}
+
+	private:
+		text_file_line_reader reader_ = {};
+		bool open_ = false;
+	};
+
+	// Reads the lines of a text file from the last to the first. The lines are views into the reader's buffer.
+	class reverse_line_reader
+	{
+	public:
+		explicit reverse_line_reader(const std::string& filename, i64 buffer_size = 0) { open_ = text_file_openfor_read_lines_reverse(&reader_, (str)filename.c_str(), buffer_size); }
+		reverse_line_reader(const reverse_line_reader&) = delete;
+		reverse_line_reader& operator=(const reverse_line_reader&) = delete;
+		reverse_line_reader(reverse_line_reader&& other) noexcept : reader_(other.reader_), open_(std::exchange(other.open_, false)) {}
+		~reverse_line_reader()
+		{
+			if (open_)
+				text_file_close_lines_reverse(&reader_);
+		}
+
+		explicit operator bool() const noexcept { return open_; }
+		bool next(std::string_view& line)
+		{
+			c8* data;
+			i64 length;
+			if (!open_ || !text_file_read_line_reverse(&data, &length, &reader_))
+				return false; // Start of the file
+			line = std::string_view((const char*)data, (size_t)length);
+			return true;
+		}
+
+	private:
+		text_file_reverse_line_reader reader_ = {};
+		bool open_ = false;
+	};
+
+	// A fixed width record plan built from member pointers, so the type and offset of each field come from the struct:
+	//
+	//		text_files::record_plan<order> plan;
+	//		plan.field(&order::id, 8).field(&order::price, 12).skip(2).field(&order::code, 4).field(&order::paid, 1).compile("\n");
+	//		plan.read(orders, 1000, file);
+	template <typename Record>
+	class record_plan
+	{
+		static_assert(std::is_standard_layout_v<Record>, "Record fields are found by offset, so the record must be standard layout");
+
+	public:
+		record_plan() = default;
+		record_plan(const record_plan&) = delete;
+		record_plan& operator=(const record_plan&) = delete;
+		~record_plan() { release(); }
+
+		// Add a field of 'width' chars stored in 'member'
+		template <typename T>
+		record_plan& field(T Record::* member, i32 width)
+		{
+			alignas(Record) unsigned char storage[sizeof(Record)] = {};
+			const Record* record = reinterpret_cast<const Record*>(storage);
+			i32 offset = (i32)(reinterpret_cast<const unsigned char*>(&(record->*member)) - storage);
+			if constexpr (std::is_array_v<T>)
+				assert(width <= (i32)sizeof(T)); // The chars are copied as they are and must fit
+			fields_.push_back({ type_of<T>(), width, offset });
+			return *this;
+		}
+		// Add 'width' chars that are skipped
+		record_plan& skip(i32 width)
+		{
+			fields_.push_back({ TEXT_FILE_TYPE_BYTE, width, -1 });
+			return *this;
+		}
+		// Compile the fields added so far. Records end with 'terminator', which may be empty.
+		bool compile(const char* terminator = "\n")
+		{
+			release();
+			compiled_ = text_file_record_plan_compile(&plan_, fields_.data(), (i32)fields_.size(), (str)terminator);
+			return compiled_;
+		}
+
+		i32 record_width() const noexcept { return plan_.record_width; }
+		bool read(Record& record, file& source) const { return compiled_ && text_file_read_record(&record, &plan_, source.handle()); }
+		bool read(Record* records, i64 count, file& source) const { return compiled_ && text_file_read_records(records, count, sizeof(Record), &plan_, source.handle()); }
+#if TEXT_FILE_CPP_SPAN
+		bool read(std::span<Record> records, file& source) const { return read(records.data(), (i64)records.size(), source); }
+#endif
+		// Parse one record from text that is already in memory
+		bool parse(Record& record, std::string_view text) const
+		{
+			if (!compiled_ || (i64)text.size() < plan_.record_width - plan_.terminator_length)
+				return false; // Not a whole record
+			return text_file_parse_record(&record, &plan_, (const c8*)text.data());
+		}
+
+	private:
+		void release()
+		{
+			if (std::exchange(compiled_, false))
+				text_file_record_plan_free(&plan_);
+		}
+
+		std::vector<text_file_record_field> fields_;
+		text_file_record_plan plan_ = {};
+		bool compiled_ = false;
+	};
+}
+#endif
@@ -0,0 +1,705 @@
+//
+// Benchmarks for text_file.h: throughput and latency of the read/write functions
+//
+// Build:
+//		Windows:	cl /O2 text_file_bench.c
+//		Linux:		gcc -O2 text_file_bench.c -o text_file_bench -pthread -lm
+//
+// Usage:
+//		text_file_bench [options]
+//
+//		--sizes 4K,1M,256M		File sizes to sweep (K, M and G suffixes). Default: 4K,64K,1M,16M,256M
+//		--filter name			Only run benchmarks whose name contains 'name'
+//		--cold					Also run the read benchmarks with a cold page cache (Linux only)
+//		--format csv|json		Output format. Default: csv
+//		--out file				Write the results to 'file' instead of stdout
+//		--dir path				Directory for the temporary files. Default: current directory
+//		--compare baseline.csv	Compare with saved csv results and flag regressions
+//		--threshold percent		Throughput drop that counts as a regression. Default: 10
+//		--baseline				Run the integer benchmarks on the sprintf/sscanf code that the digit-pair formatter
+//								and the integer parser replaced, to measure the speedup against it
+//
+// Every benchmark writes or reads a file of the given size, timing batches of calls. Throughput is reported in MB/s
+// and calls/s, latency as the p50/p90/p99 of the per call time of each batch. With --compare, the exit code is 1
+// if any benchmark got slower than the threshold.
+//
+// Example: save a baseline, change the code, compare
+//
+//		text_file_bench --out baseline.csv
+//		text_file_bench --compare baseline.csv
+//
+// Example: the integer read/write speedup over sprintf/sscanf
+//
+//		text_file_bench --baseline --sizes 16M --out before.csv
+//		text_file_bench --sizes 16M --compare before.csv
+//
+
+#include "text_file.h"
+
+#include <math.h>
+
+//
+// Benchmark types
+//
+
+// The data types that can be benchmarked
+typedef enum bench_type
+{
+	BENCH_I8, BENCH_I16, BENCH_I32, BENCH_I64, BENCH_U8, BENCH_U16, BENCH_U32, BENCH_U64,
+	BENCH_F32, BENCH_F64, BENCH_F32_SHORTEST, BENCH_F64_SHORTEST, BENCH_BOOL, BENCH_BYTE, BENCH_STR,
+	BENCH_LINES, BENCH_MAPPED, BENCH_ASYNC
+} bench_type;
+
+// Value distributions for the numeric benchmarks
+typedef enum bench_distribution
+{
+	BENCH_SMALL,	// 0 to 99
+	BENCH_UNIFORM,	// Uniform over the whole range of the type
+	BENCH_DIGITS	// Uniform number of digits
+} bench_distribution;
+
+// A benchmark
+typedef struct bench_case
+{
+	const char* name;
+	bench_type type;
+	bool read;
+	u8 width;		// Field width of the read benchmarks
+} bench_case;
+
+// The result of one benchmark run
+typedef struct bench_result
+{
+	char name[64];
+	char distribution[16];
+	i64 size;
+	char cache[8];
+	i64 calls;
+	i64 bytes;
+	f64 seconds;
+	f64 mb_per_second;
+	f64 calls_per_second;
+	f64 p50_ns;
+	f64 p90_ns;
+	f64 p99_ns;
+} bench_result;
+
+// Per call times of the batches of one run
+typedef struct bench_samples
+{
+	f64* values;
+	i64 count;
+	i64 capacity;
+} bench_samples;
+
+// Number of calls timed together. Single calls are too short for the clock.
+#define BENCH_BATCH 256
+
+static const bench_case bench_cases[] =
+{
+	{ "write_i8", BENCH_I8, false, 0 },
+	{ "write_i16", BENCH_I16, false, 0 },
+	{ "write_i32", BENCH_I32, false, 0 },
+	{ "write_i64", BENCH_I64, false, 0 },
+	{ "write_u8", BENCH_U8, false, 0 },
+	{ "write_u16", BENCH_U16, false, 0 },
+	{ "write_u32", BENCH_U32, false, 0 },
+	{ "write_u64", BENCH_U64, false, 0 },
+	{ "write_f32", BENCH_F32, false, 0 },
+	{ "write_f64", BENCH_F64, false, 0 },
+	{ "write_f32_shortest", BENCH_F32_SHORTEST, false, 0 },
+	{ "write_f64_shortest", BENCH_F64_SHORTEST, false, 0 },
+	{ "write_bool", BENCH_BOOL, false, 0 },
+	{ "write_byte", BENCH_BYTE, false, 64 },
+	{ "write_str", BENCH_STR, false, 64 },
+	{ "read_i8", BENCH_I8, true, 4 },
+	{ "read_i16", BENCH_I16, true, 6 },
+	{ "read_i32", BENCH_I32, true, 11 },
+	{ "read_i64", BENCH_I64, true, 20 },
+	{ "read_u8", BENCH_U8, true, 3 },
+	{ "read_u16", BENCH_U16, true, 5 },
+	{ "read_u32", BENCH_U32, true, 10 },
+	{ "read_u64", BENCH_U64, true, 20 },
+	{ "read_f32", BENCH_F32, true, 16 },
+	{ "read_f64", BENCH_F64, true, 24 },
+	{ "read_bool", BENCH_BOOL, true, 1 },
+	{ "read_byte", BENCH_BYTE, true, 64 },
+	{ "read_str", BENCH_STR, true, 64 },
+	{ "read_line", BENCH_LINES, true, 64 },
+	{ "read_mapped", BENCH_MAPPED, true, 64 },
+	{ "read_async", BENCH_ASYNC, true, 64 },
+};
+
+static const char* bench_distribution_names[] = { "small", "uniform", "digits" };
+
+// Run the integer benchmarks on the sprintf/sscanf code (--baseline)
+static bool bench_baseline = false;
+
+//
+// Implementations: Helpers
+//
+
+// xorshift64 random numbers, the same sequence on every platform
+u64 bench_random(void)
+{
+	static u64 state = 88172645463325252ULL;
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+// A random value of the given distribution as raw bits. Integers use the low bits, floats are returned as f64 bits.
+u64 bench_value(bench_type type, bench_distribution distribution)
+{
+	bool is_float = (type == BENCH_F32 || type == BENCH_F64 || type == BENCH_F32_SHORTEST || type == BENCH_F64_SHORTEST);
+	if (is_float)
+	{
+		f64 value;
+		if (distribution == BENCH_SMALL)
+			value = (f64)(bench_random() % 10000) / 100.0;
+		else if (distribution == BENCH_DIGITS)
+			value = (f64)(bench_random() % 100000000) * pow(10.0, (f64)(i32)(bench_random() % 20) - 10.0);
+		else
+			value = (f64)(bench_random() >> 11) / (f64)(1ULL << 53) * 1e6;
+		if (type == BENCH_F32 || type == BENCH_F32_SHORTEST)
+			value = (f32)value;
+		u64 bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	if (distribution == BENCH_SMALL)
+		return bench_random() % 100;
+	if (distribution == BENCH_DIGITS)
+	{
+		// Pick the number of digits first, then a value with that many digits
+		u64 digits = 1 + bench_random() % 19;
+		u64 low = 1;
+		for (u64 i = 1; i < digits; i++)
+			low *= 10;
+		return low + bench_random() % (low * 9);
+	}
+	return bench_random();
+}
+// Parse a size like "4K", "16M" or "10G"
+i64 bench_parse_size(const char* text)
+{
+	char* end = NULL;
+	f64 value = strtod(text, &end);
+	if (*end == 'K' || *end == 'k')
+		value *= 1024.0;
+	else if (*end == 'M' || *end == 'm')
+		value *= 1024.0 * 1024.0;
+	else if (*end == 'G' || *end == 'g')
+		value *= 1024.0 * 1024.0 * 1024.0;
+	return (i64)value;
+}
+// Add a per call time to the samples
+void bench_samples_add(bench_samples* samples, f64 value)
+{
+	if (samples->count == samples->capacity)
+	{
+		samples->capacity = (samples->capacity > 0) ? samples->capacity * 2 : 1024;
+		samples->values = (f64*)realloc(samples->values, samples->capacity * sizeof(f64));
+		if (samples->values == NULL)
+		{
+			printf("Error: Failed to allocate memory\n");
+			exit(1); // Exit to OS
+		}
+	}
+	samples->values[samples->count++] = value;
+}
+// Compare function for qsort(..)
+int bench_compare_f64(const void* a, const void* b)
+{
+	f64 x = *(const f64*)a;
+	f64 y = *(const f64*)b;
+	return (x > y) - (x < y);
+}
+// Get a percentile of the samples. They must be sorted.
+f64 bench_percentile(bench_samples* samples, f64 percentile)
+{
+	if (samples->count == 0)
+		return 0.0;
+	i64 index = (i64)(percentile / 100.0 * (f64)(samples->count - 1) + 0.5);
+	return samples->values[index];
+}
+// Drop a file from the page cache, so that the next read comes from the disk
+bool bench_evict(const char* filename)
+{
+#if defined(__linux__)
+	int descriptor = open(filename, O_RDONLY);
+	if (descriptor < 0)
+		return false;
+	fdatasync(descriptor);
+	bool ok = (posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED) == 0);
+	close(descriptor);
+	return ok;
+#else
+	(void)filename;
+	return false; // Not supported
+#endif
+}
+
+//
+// Implementations: Baseline
+//
+// The integer writers and readers as they were before the digit-pair formatter and the hand-written parser:
+// sprintf(..) and two strlen(..) per write, calloc(..), sscanf(..) and free(..) per read.
+//
+
+// Write one integer with sprintf(..)
+bool bench_baseline_write(bench_type type, u64 value, text_file file)
+{
+	char buffer[21] = { 0 };
+	switch (type)
+	{
+	case BENCH_I8: sprintf(buffer, "%hhi", (i8)value); break;
+	case BENCH_I16: sprintf(buffer, "%hi", (i16)value); break;
+	case BENCH_I32: sprintf(buffer, "%i", (i32)value); break;
+	case BENCH_I64: sprintf(buffer, "%lli", (i64)value); break;
+	case BENCH_U8: sprintf(buffer, "%hhu", (u8)value); break;
+	case BENCH_U16: sprintf(buffer, "%hu", (u16)value); break;
+	case BENCH_U32: sprintf(buffer, "%u", (u32)value); break;
+	default: sprintf(buffer, "%llu", value); break;
+	}
+	if (fwrite(buffer, sizeof(char), strlen(buffer), file) != strlen(buffer))
+		return false;
+
+	return true;
+}
+// Read one integer of 'width' chars with sscanf(..)
+bool bench_baseline_read(bench_type type, u8 width, text_file file)
+{
+	static const u8 max_lengths[] = { 4, 6, 11, 20, 3, 5, 10, 20 };
+	static const char* formats[] = { "%hhi", "%hi", "%i", "%lli", "%hhu", "%hu", "%u", "%llu" };
+	u8 length = (width > max_lengths[type]) ? max_lengths[type] : width;
+
+	char* value = (char*)calloc(max_lengths[type] + 1, sizeof(char));
+	if (value == NULL)
+		return false;
+	if (fread(value, sizeof(char), length, file) != length)
+	{
+		free(value);
+		return false;
+	}
+	u64 data = 0; // Large enough for every format
+	bool ok = (sscanf(value, formats[type], (void*)&data) == 1);
+	free(value);
+
+	return ok;
+}
+
+//
+// Implementations: Benchmarks
+//
+
+// Write one value
+bool bench_write_one(bench_type type, u64 value, text_file file)
+{
+	static byte block[64] = "The quick brown fox jumps over the lazy dog. 0123456789 abcdef\n";
+	f64 real;
+	memcpy(&real, &value, sizeof(real));
+
+	if (bench_baseline && type <= BENCH_U64)
+		return bench_baseline_write(type, value, file);
+
+	switch (type)
+	{
+	case BENCH_I8: return text_file_write_i8((i8)value, file);
+	case BENCH_I16: return text_file_write_i16((i16)value, file);
+	case BENCH_I32: return text_file_write_i32((i32)value, file);
+	case BENCH_I64: return text_file_write_i64((i64)value, file);
+	case BENCH_U8: return text_file_write_u8((u8)value, file);
+	case BENCH_U16: return text_file_write_u16((u16)value, file);
+	case BENCH_U32: return text_file_write_u32((u32)value, file);
+	case BENCH_U64: return text_file_write_u64(value, file);
+	case BENCH_F32: return text_file_write_f32((f32)real, file);
+	case BENCH_F64: return text_file_write_f64(real, file);
+	case BENCH_F32_SHORTEST: return text_file_write_f32_shortest((f32)real, file);
+	case BENCH_F64_SHORTEST: return text_file_write_f64_shortest(real, file);
+	case BENCH_BOOL: return text_file_write_bool((value & 1) != 0, file);
+	case BENCH_BYTE: return text_file_write_byte(block, sizeof(block), file);
+	case BENCH_STR: return text_file_write_str(block, file);
+	default: return false;
+	}
+}
+// Create a file of about 'size' bytes with fixed width fields for a read benchmark
+bool bench_create_input(const char* filename, const bench_case* test, bench_distribution distribution, i64 size)
+{
+	FILE* file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
+
+	char field[128];
+	for (i64 written = 0; written < size; written += test->width)
+	{
+		u64 value = bench_value(test->type, distribution);
+		f64 real;
+		memcpy(&real, &value, sizeof(real));
+		switch (test->type)
+		{
+		case BENCH_I8: snprintf(field, sizeof(field), "%*hhi", test->width, (signed char)value); break;
+		case BENCH_I16: snprintf(field, sizeof(field), "%*hi", test->width, (i16)value); break;
+		case BENCH_I32: snprintf(field, sizeof(field), "%*i", test->width, (i32)value); break;
+		case BENCH_I64: snprintf(field, sizeof(field), "%*lli", test->width, (i64)value); break;
+		case BENCH_U8: snprintf(field, sizeof(field), "%*hhu", test->width, (u8)value); break;
+		case BENCH_U16: snprintf(field, sizeof(field), "%*hu", test->width, (u16)value); break;
+		case BENCH_U32: snprintf(field, sizeof(field), "%*u", test->width, (u32)value); break;
+		case BENCH_U64: snprintf(field, sizeof(field), "%*llu", test->width, value); break;
+		case BENCH_F32: snprintf(field, sizeof(field), "%*.9g", test->width, real); break;
+		case BENCH_F64: snprintf(field, sizeof(field), "%*.17g", test->width, real); break;
+		case BENCH_BOOL: snprintf(field, sizeof(field), "%c", (value & 1) ? '1' : '0'); break;
+		default: snprintf(field, sizeof(field), "%.*s\n", test->width - 1, "The quick brown fox jumps over the lazy dog. 0123456789 abcdefgh"); break;
+		}
+		fwrite(field, 1, test->width, file);
+	}
+
+	return (fclose(file) == 0);
+}
+// Read one value. Returns false at the end of the file.
+bool bench_read_one(bench_type type, u8 width, text_file file)
+{
+	static c8 buffer[256];
+	if (bench_baseline && type <= BENCH_U64)
+		return bench_baseline_read(type, width, file);
+
+	switch (type)
+	{
+	case BENCH_I8: { i8 value; return text_file_read_i8(&value, width, file); }
+	case BENCH_I16: { i16 value; return text_file_read_i16(&value, width, file); }
+	case BENCH_I32: { i32 value; return text_file_read_i32(&value, width, file); }
+	case BENCH_I64: { i64 value; return text_file_read_i64(&value, width, file); }
+	case BENCH_U8: { u8 value; return text_file_read_u8(&value, width, file); }
+	case BENCH_U16: { u16 value; return text_file_read_u16(&value, width, file); }
+	case BENCH_U32: { u32 value; return text_file_read_u32(&value, width, file); }
+	case BENCH_U64: { u64 value; return text_file_read_u64(&value, width, file); }
+	case BENCH_F32: { f32 value; return text_file_read_f32(&value, width, file); }
+	case BENCH_F64: { f64 value; return text_file_read_f64(&value, width, file); }
+	case BENCH_BOOL: { bool value; return text_file_read_bool(&value, file); }
+	case BENCH_BYTE: return text_file_read_byte(buffer, width, file);
+	case BENCH_STR: return text_file_read_str(buffer, width, file) && buffer[0] != '\0';
+	default: return false;
+	}
+}
+// Run one benchmark and fill in the result
+bool bench_run(const bench_case* test, bench_distribution distribution, i64 size, bool cold, const char* directory, bench_result* result)
+{
+	char filename[1024];
+	snprintf(filename, sizeof(filename), "%s/text_file_bench_%s.tmp", directory, test->name);
+
+	memset(result, 0, sizeof(bench_result));
+	snprintf(result->name, sizeof(result->name), "%s", test->name);
+	snprintf(result->distribution, sizeof(result->distribution), "%s", bench_distribution_names[distribution]);
+	snprintf(result->cache, sizeof(result->cache), "%s", cold ? "cold" : "warm");
+	result->size = size;
+
+	bench_samples samples = { 0 };
+	bool ok = true;
+	u64 start = 0;
+
+	if (!test->read)
+	{
+		// Pre-generate the values so that only the write is timed
+		u64 values[BENCH_BATCH];
+		text_file file = text_file_openfor_write_new((str)filename);
+		if (file == NULL)
+			return false;
+		start = text_file_clock_ns();
+		while (ok && result->bytes < size)
+		{
+			for (i32 i = 0; i < BENCH_BATCH; i++)
+				values[i] = bench_value(test->type, distribution);
+			u64 batch_start = text_file_clock_ns();
+			for (i32 i = 0; ok && i < BENCH_BATCH; i++)
+				ok = bench_write_one(test->type, values[i], file);
+			bench_samples_add(&samples, (f64)(text_file_clock_ns() - batch_start) / BENCH_BATCH);
+			result->calls += BENCH_BATCH;
+			result->bytes = text_file_get_position(file);
+		}
+		text_file_close(file);
+	}
+	else
+	{
+		if (!bench_create_input(filename, test, distribution, size))
+			return false;
+		if (cold && !bench_evict(filename))
+		{
+			remove(filename);
+			return false; // Not supported here
+		}
+		result->bytes = text_file_get_length((str)filename);
+		start = text_file_clock_ns();
+
+		if (test->type == BENCH_LINES)
+		{
+			text_file_line_reader reader;
+			ok = text_file_openfor_read_lines(&reader, (str)filename, 0);
+			c8* line;
+			i64 length;
+			while (ok)
+			{
+				u64 batch_start = text_file_clock_ns();
+				i32 i = 0;
+				while (i < BENCH_BATCH && text_file_read_line(&line, &length, &reader))
+					i++;
+				if (i == 0)
+					break;
+				bench_samples_add(&samples, (f64)(text_file_clock_ns() - batch_start) / i);
+				result->calls += i;
+			}
+			if (ok)
+				text_file_close_lines(&reader);
+		}
+		else if (test->type == BENCH_MAPPED)
+		{
+			text_file_mapped mapped;
+			ok = text_file_openfor_read_mapped(&mapped, (str)filename);
+			byte* data;
+			u64 checksum = 0;
+			while (ok)
+			{
+				u64 batch_start = text_file_clock_ns();
+				i32 i = 0;
+				for (; i < BENCH_BATCH && text_file_read_mapped(&data, test->width, &mapped); i++)
+					checksum += data[0]; // Touch the data
+				if (i == 0)
+					break;
+				bench_samples_add(&samples, (f64)(text_file_clock_ns() - batch_start) / i);
+				result->calls += i;
+			}
+			if (ok)
+				text_file_close_mapped(&mapped);
+			if (checksum == 1)
+				printf(" "); // Keep the compiler from dropping the loop
+		}
+		else
+		{
+			text_file_async async;
+			text_file file = NULL;
+			if (test->type == BENCH_ASYNC)
+				file = text_file_openfor_read_async(&async, (str)filename, 0, 0) ? async.file : NULL;
+			else
+				file = text_file_openfor_read((str)filename);
+			ok = (file != NULL);
+			bench_type type = (test->type == BENCH_ASYNC) ? BENCH_BYTE : test->type;
+			while (ok)
+			{
+				u64 batch_start = text_file_clock_ns();
+				i32 i = 0;
+				while (i < BENCH_BATCH && bench_read_one(type, test->width, file))
+					i++;
+				if (i == 0)
+					break;
+				bench_samples_add(&samples, (f64)(text_file_clock_ns() - batch_start) / i);
+				result->calls += i;
+			}
+			if (test->type == BENCH_ASYNC && ok)
+				text_file_close_async(&async);
+			else if (ok)
+				text_file_close(file);
+		}
+	}
+
+	result->seconds = (f64)(text_file_clock_ns() - start) / 1e9;
+	remove(filename);
+
+	if (result->seconds > 0.0)
+	{
+		result->mb_per_second = (f64)result->bytes / (1024.0 * 1024.0) / result->seconds;
+		result->calls_per_second = (f64)result->calls / result->seconds;
+	}
+	qsort(samples.values, samples.count, sizeof(f64), bench_compare_f64);
+	result->p50_ns = bench_percentile(&samples, 50.0);
+	result->p90_ns = bench_percentile(&samples, 90.0);
+	result->p99_ns = bench_percentile(&samples, 99.0);
+	free(samples.values);
+
+	return ok;
+}
+
+//
+// Implementations: Output and compare
+//
+
+// Write the results as csv or json
+void bench_print(FILE* out, bench_result* results, i64 count, bool json)
+{
+	if (json)
+		fprintf(out, "[\n");
+	else
+		fprintf(out, "name,distribution,size,cache,calls,bytes,seconds,mb_per_s,calls_per_s,p50_ns,p90_ns,p99_ns\n");
+
+	for (i64 i = 0; i < count; i++)
+	{
+		bench_result* r = &results[i];
+		if (json)
+		{
+			fprintf(out, "  { \"name\": \"%s\", \"distribution\": \"%s\", \"size\": %lld, \"cache\": \"%s\", \"calls\": %lld, \"bytes\": %lld, "
+				"\"seconds\": %.6f, \"mb_per_s\": %.3f, \"calls_per_s\": %.1f, \"p50_ns\": %.2f, \"p90_ns\": %.2f, \"p99_ns\": %.2f }%s\n",
+				r->name, r->distribution, r->size, r->cache, r->calls, r->bytes, r->seconds, r->mb_per_second, r->calls_per_second,
+				r->p50_ns, r->p90_ns, r->p99_ns, (i + 1 < count) ? "," : "");
+		}
+		else
+		{
+			fprintf(out, "%s,%s,%lld,%s,%lld,%lld,%.6f,%.3f,%.1f,%.2f,%.2f,%.2f\n",
+				r->name, r->distribution, r->size, r->cache, r->calls, r->bytes, r->seconds, r->mb_per_second, r->calls_per_second,
+				r->p50_ns, r->p90_ns, r->p99_ns);
+		}
+	}
+
+	if (json)
+		fprintf(out, "]\n");
+}
+// Compare the results with a saved csv baseline. Returns the number of regressions.
+i32 bench_compare(const char* filename, bench_result* results, i64 count, f64 threshold)
+{
+	FILE* file = fopen(filename, "r");
+	if (file == NULL)
+	{
+		printf("Error: Failed to open the baseline %s\n", filename);
+		exit(1); // Exit to OS
+	}
+
+	i32 regressions = 0;
+	char line[512];
+	if (fgets(line, sizeof(line), file) == NULL || strncmp(line, "name,", 5) != 0)
+	{
+		printf("Error: The baseline %s has no csv header line\n", filename);
+		fclose(file);
+		exit(1); // Exit to OS
+	}
+	printf("%-20s %-8s %12s %-5s %12s %12s %8s\n", "name", "dist", "size", "cache", "base MB/s", "now MB/s", "change");
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		bench_result base;
+		memset(&base, 0, sizeof(base));
+		if (sscanf(line, "%63[^,],%15[^,],%lld,%7[^,],%lld,%lld,%lf,%lf", base.name, base.distribution, &base.size, base.cache,
+			&base.calls, &base.bytes, &base.seconds, &base.mb_per_second) != 8)
+			continue;
+
+		for (i64 i = 0; i < count; i++)
+		{
+			bench_result* r = &results[i];
+			if (strcmp(r->name, base.name) != 0 || strcmp(r->distribution, base.distribution) != 0 ||
+				r->size != base.size || strcmp(r->cache, base.cache) != 0 || base.mb_per_second <= 0.0)
+				continue;
+
+			f64 change = (r->mb_per_second - base.mb_per_second) / base.mb_per_second * 100.0;
+			bool regression = (change < -threshold);
+			regressions += regression;
+			printf("%-20s %-8s %12lld %-5s %12.2f %12.2f %+7.1f%%%s\n", r->name, r->distribution, r->size, r->cache,
+				base.mb_per_second, r->mb_per_second, change, regression ? "  REGRESSION" : "");
+		}
+	}
+	fclose(file);
+
+	return regressions;
+}
+
+//
+// Main
+//
+int main(int argc, char** argv)
+{
+	i64 sizes[32] = { 4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024, 256 * 1024 * 1024 };
+	i32 size_count = 5;
+	const char* filter = NULL;
+	const char* out_filename = NULL;
+	const char* baseline = NULL;
+	const char* directory = ".";
+	bool cold = false;
+	bool json = false;
+	f64 threshold = 10.0;
+
+	for (i32 i = 1; i < argc; i++)
+	{
+		bool has_value = (i + 1 < argc);
+		if (strcmp(argv[i], "--sizes") == 0 && has_value)
+		{
+			size_count = 0;
+			char* list = argv[++i];
+			for (char* item = strtok(list, ","); item != NULL && size_count < 32; item = strtok(NULL, ","))
+				sizes[size_count++] = bench_parse_size(item);
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && has_value)
+			filter = argv[++i];
+		else if (strcmp(argv[i], "--cold") == 0)
+			cold = true;
+		else if (strcmp(argv[i], "--format") == 0 && has_value)
+			json = (strcmp(argv[++i], "json") == 0);
+		else if (strcmp(argv[i], "--out") == 0 && has_value)
+			out_filename = argv[++i];
+		else if (strcmp(argv[i], "--dir") == 0 && has_value)
+			directory = argv[++i];
+		else if (strcmp(argv[i], "--compare") == 0 && has_value)
+			baseline = argv[++i];
+		else if (strcmp(argv[i], "--threshold") == 0 && has_value)
+			threshold = atof(argv[++i]);
+		else if (strcmp(argv[i], "--baseline") == 0)
+			bench_baseline = true;
+		else
+		{
+			printf("Usage: %s [--sizes 4K,1M,..] [--filter name] [--cold] [--format csv|json] [--out file] [--dir path] [--compare baseline.csv] [--threshold percent] [--baseline]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	i64 case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
+	i64 capacity = case_count * 3 * size_count * 2;
+	bench_result* results = (bench_result*)calloc(capacity, sizeof(bench_result));
+	if (results == NULL)
+	{
+		printf("Error: Failed to allocate memory\n");
+		return 1; // Exit to OS
+	}
+
+	i64 count = 0;
+	for (i64 c = 0; c < case_count; c++)
+	{
+		const bench_case* test = &bench_cases[c];
+		if (filter != NULL && strstr(test->name, filter) == NULL)
+			continue;
+
+		// Only the numbers have different value distributions
+		bool numeric = (test->type <= BENCH_F64_SHORTEST);
+		for (i32 d = numeric ? 0 : 1; d < (numeric ? 3 : 2); d++)
+		{
+			for (i32 s = 0; s < size_count; s++)
+			{
+				for (i32 pass = 0; pass < ((cold && test->read) ? 2 : 1); pass++)
+				{
+					if (bench_run(test, (bench_distribution)d, sizes[s], pass == 1, directory, &results[count]))
+						count++;
+					else
+						fprintf(stderr, "Warning: %s %s %lld %s failed\n", test->name, bench_distribution_names[d], sizes[s], (pass == 1) ? "cold" : "warm");
+				}
+			}
+		}
+	}
+
+	FILE* out = stdout;
+	if (out_filename != NULL)
+	{
+		out = fopen(out_filename, "w");
+		if (out == NULL)
+		{
+			printf("Error: Failed to open for writing file\n");
+			return 1; // Exit to OS
+		}
+	}
+	if (baseline == NULL || out_filename != NULL)
+		bench_print(out, results, count, json);
+	if (out != stdout)
+		fclose(out);
+
+	i32 regressions = 0;
+	if (baseline != NULL)
+	{
+		regressions = bench_compare(baseline, results, count, threshold);
+		printf("%d regression(s)\n", regressions);
+	}
+	free(results);
+
+	return (regressions > 0) ? 1 : 0;
+}